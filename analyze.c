@@ -7,12 +7,17 @@
 /****************************************************/
 
 #include "globals.h"
+#include "util.h"
 #include "symtab.h"
 #include "analyze.h"
 
 /* counter for variable memory locations */
 static int location = 0;
 
+/* number of procedures declared, which bounds the
+   depth of a chain of calls that does not recurse */
+static int nprocs = 0;
+
 static void analysisError(TreeNode * t,char * message)
 { fprintf(listing,"\n>>> ");
   fprintf(listing,"analysis error at line %d: %s ",t->lineno,message);
@@ -47,6 +52,76 @@ static void nullProc(TreeNode * t)
   else return;
 }
 
+/* Function isVarNode is TRUE for a node that names
+ * a variable
+ */
+static int isVarNode( TreeNode * t)
+{ if (t->nodekind == ExpK)
+    return (t->kind.exp == IdK) || (t->kind.exp == IndexK);
+  return (t->nodekind == StmtK) &&
+         ((t->kind.stmt == AssignK) || (t->kind.stmt == ReadK) ||
+          (t->kind.stmt == ForK));
+}
+
+/* Procedure renameVar renames variable from to to
+ * everywhere in t and its siblings
+ */
+static void renameVar( TreeNode * t, char * from, char * to)
+{ int i;
+  for (;t != NULL;t = t->sibling)
+  { if (isVarNode(t) && (strcmp(t->attr.name,from) == 0))
+      t->attr.name = to;
+    for (i=0;i<MAXCHILDREN;i++) renameVar(t->child[i],from,to);
+  }
+}
+
+/* Procedure insertProc enters procedure t and gives
+ * each of its parameters the name proc.param, which
+ * no other variable can have, in the declaration
+ * and in the body. Parameters are global variables
+ * of their own as far as the rest of the compiler
+ * is concerned
+ */
+static void insertProc( TreeNode * t)
+{ TreeNode * p;
+  if ((st_lookup(t->attr.name) != -1) || (st_proc(t->attr.name) != NULL))
+  { analysisError(t,"multiple declaration -->");
+    printToken(ID,t->attr.name);
+    return;
+  }
+  st_insertProc(t->attr.name,t->lineno,t);
+  nprocs++;
+  for (p=t->child[0];p != NULL;p = p->sibling)
+  { char * name = (char *) malloc(strlen(t->attr.name)+strlen(p->attr.name)+2);
+    if (name == NULL) return;
+    sprintf(name,"%s.%s",t->attr.name,p->attr.name);
+    renameVar(t->child[1],p->attr.name,name);
+    p->attr.name = name;
+  }
+}
+
+/* Procedure setInit gives the n memory locations
+ * from loc on of declaration t the initial values
+ * it lists, the ones it does not list keeping 0
+ */
+static void setInit( TreeNode * t, int loc, int n)
+{ TreeNode * p;
+  int k = 0;
+  for (p=t->child[1];p != NULL;p = p->sibling)
+  { if (k == n)
+    { analysisError(t,"too many initial values -->");
+      printToken(ID,t->attr.name);
+      return;
+    }
+    if ((t->kind.decl == CharK) && ((p->attr.val < 0) || (p->attr.val > 255)))
+    { analysisError(p,"char initial value out of range -->");
+      printToken(ID,t->attr.name);
+    }
+    st_setInit(loc+k,p->attr.val);
+    k++;
+  }
+}
+
 /* Procedure insertNode inserts 
  * identifiers stored in t into 
  * the symbol table 
@@ -89,10 +164,25 @@ static void insertNode( TreeNode * t)
 	//todo 
 	/* only declaration could insert node into symtab */
 	case DeclK:
-		if(st_lookup(t->attr.name) == -1)
-				/* not yet in table, so treat as new definition */
-				st_insert(t->attr.name,t->lineno,location++,t->kind.decl);
-		else {
+		if(t->kind.decl == ProcK){
+				insertProc(t);
+		}else if((st_lookup(t->attr.name) == -1) &&
+		         (st_proc(t->attr.name) == NULL)){
+				/* not yet in table, so treat as new definition;
+				   an array takes one location per element */
+				int size = 0;
+				if(t->child[0] != NULL){
+					size = t->child[0]->attr.val;
+					if(size <= 0){
+						analysisError(t,"array size must be positive -->");
+						printToken(ID,t->attr.name);
+						size = 1;
+					}
+				}
+				st_insert(t->attr.name,t->lineno,location,size,t->kind.decl);
+				setInit(t,location,(size > 0) ? size : 1);
+				location += (size > 0) ? size : 1;
+		}else {
 				analysisError(t,"multiple declaration -->");
 				printToken(ID,t->attr.name);
 		}
@@ -119,6 +209,106 @@ static void typeError(TreeNode * t, char * message)
   Error = TRUE;
 }
 
+/* Procedure checkIndex checks that the variable
+ * named in t is indexed (index != NULL) exactly
+ * when it is an array, and that the index is an
+ * integer
+ */
+static void checkIndex(TreeNode * t, TreeNode * index)
+{ if (st_lookup(t->attr.name) == -1) return;
+  if ((index == NULL) && (st_size(t->attr.name) > 0))
+    typeError(t,"array used without an index");
+  else if ((index != NULL) && (st_size(t->attr.name) == 0))
+    typeError(t,"index applied to a non-array");
+  else if ((index != NULL) && (index->type != Integer))
+    typeError(index,"array index is not an integer");
+}
+
+/* Function calledBody returns the body of the
+ * procedure call statement t calls, or NULL if t
+ * is no call or the procedure is not declared
+ */
+static TreeNode * calledBody(TreeNode * t)
+{ TreeNode * p;
+  if ((t->nodekind != StmtK) || (t->kind.stmt != CallK)) return NULL;
+  p = st_proc(t->attr.name);
+  return (p == NULL) ? NULL : p->child[1];
+}
+
+/* Function assigns is TRUE if a statement of t
+ * (or its siblings) assigns or reads into
+ * variable name, following calls at most depth
+ * procedures deep
+ */
+static int assigns(TreeNode * t, char * name, int depth)
+{ int i;
+  for (;t != NULL;t = t->sibling)
+  { if ((t->nodekind == StmtK) &&
+        ((t->kind.stmt == AssignK) || (t->kind.stmt == ReadK) ||
+         (t->kind.stmt == ForK)) &&
+        (strcmp(t->attr.name,name) == 0))
+      return TRUE;
+    if ((depth > 0) && assigns(calledBody(t),name,depth-1))
+      return TRUE;
+    for (i=0;i<MAXCHILDREN;i++)
+      if (assigns(t->child[i],name,depth)) return TRUE;
+  }
+  return FALSE;
+}
+
+/* Function calls is TRUE if t (or its siblings)
+ * calls procedure name, directly or through at
+ * most depth other procedures
+ */
+static int calls(TreeNode * t, char * name, int depth)
+{ int i;
+  for (;t != NULL;t = t->sibling)
+  { if ((t->nodekind == StmtK) && (t->kind.stmt == CallK) &&
+        (strcmp(t->attr.name,name) == 0))
+      return TRUE;
+    if ((depth > 0) && calls(calledBody(t),name,depth-1))
+      return TRUE;
+    for (i=0;i<MAXCHILDREN;i++)
+      if (calls(t->child[i],name,depth)) return TRUE;
+  }
+  return FALSE;
+}
+
+/* Procedure checkCall checks that call t names a
+ * procedure and passes it one argument of the
+ * right type per parameter
+ */
+static void checkCall(TreeNode * t)
+{ TreeNode * p = st_proc(t->attr.name), * a, * q;
+  if (p == NULL)
+  { analysisError(t,"undefined procedure");
+    printToken(ID,t->attr.name);
+    return;
+  }
+  for (a=t->child[0],q=p->child[0];(a != NULL) && (q != NULL);
+       a=a->sibling,q=q->sibling)
+    if (a->type != ((q->kind.decl == CharK) ? Char : Integer))
+      typeError(a,"argument differs in type from the parameter");
+  if ((a != NULL) || (q != NULL))
+    typeError(t,"wrong number of arguments");
+}
+
+/* Procedure checkLabels checks that no two arms
+ * of case statement t share a label
+ */
+static void checkLabels(TreeNode * t)
+{ TreeNode * arm, * l, * arm2, * l2;
+  for (arm=t->child[1];arm != NULL;arm = arm->sibling)
+    for (l=arm->child[0];l != NULL;l = l->sibling)
+      for (arm2=arm;arm2 != NULL;arm2 = arm2->sibling)
+        for (l2=(arm2 == arm) ? l->sibling : arm2->child[0];l2 != NULL;
+             l2 = l2->sibling)
+          if (l2->attr.val == l->attr.val)
+          { typeError(l2,"case label used twice");
+            return;
+          }
+}
+
 /* Procedure checkNode performs
  * type checking at a single tree node
  */
@@ -128,6 +318,18 @@ static void checkNode(TreeNode * t)
   { case ExpK:
       switch (t->kind.exp)
       { case OpK:
+          /* Boolean values are only ever tested, so
+             they are never operands of arithmetic or
+             comparisons */
+          if ((t->attr.op == AND) || (t->attr.op == OR) || (t->attr.op == NOT))
+          { if ((t->child[0]->type != Boolean) ||
+                ((t->child[1] != NULL) && (t->child[1]->type != Boolean)))
+              typeError(t,"and, or or not applied to non-Boolean value");
+            t->type = Boolean;
+            break;
+          }
+          if ((t->child[0]->type == Boolean) || (t->child[1]->type == Boolean))
+            typeError(t,"Op applied to Boolean value");
 //          if ((t->child[0]->type != Integer) ||
 //             (t->child[1]->type != Integer))
 //          typeError(t,"Op applied to non-integer");
@@ -154,6 +356,15 @@ static void checkNode(TreeNode * t)
 				printToken(ID,t->attr.name);
 		  }else
 				t->type = st_returnType(t->attr.name);
+		  checkIndex(t,NULL);
+          break;
+        case IndexK:
+		  if(st_lookup(t->attr.name) == -1){
+				analysisError(t,"undefined identifier");
+				printToken(ID,t->attr.name);
+		  }else
+				t->type = st_returnType(t->attr.name);
+		  checkIndex(t,t->child[0]);
           break;
         default:
           break;
@@ -172,6 +383,7 @@ static void checkNode(TreeNode * t)
 				printToken(ID,t->attr.name);
 		  }else
 				type = st_returnType(t->attr.name);
+		  checkIndex(t,t->child[1]);
 		  if(type != t->child[0]->type){
             typeError(t->child[0],"cannot convert diffrent type");
 			printf("the type is %d, and the child[0]->type is %d",(int)type,(int)(t->child[0]->type));
@@ -181,6 +393,9 @@ static void checkNode(TreeNode * t)
             //typeError(t->child[0],"assignment of non-integer value");
           break;
 		}
+        case ReadK:
+          checkIndex(t,t->child[0]);
+          break;
         case WriteK:
           if ((t->child[0]->type != Integer) && (t->child[0]->type != Char))
             typeError(t->child[0],"write of non-integer or char value");
@@ -189,20 +404,95 @@ static void checkNode(TreeNode * t)
           if (t->child[1]->type != Boolean)
             typeError(t->child[1],"repeat test is not Boolean");
           break;
+        case WhileK:
+          if (t->child[0]->type != Boolean)
+            typeError(t->child[0],"while test is not Boolean");
+          break;
+        case ForK:{
+		  ExpType type;
+          /* the body runs a counted number of times,
+             so it must leave the loop variable alone */
+          if(st_lookup(t->attr.name) == -1){
+				analysisError(t,"undefined identifier");
+				printToken(ID,t->attr.name);
+				break;
+		  }
+		  checkIndex(t,NULL);
+		  type = (st_returnType(t->attr.name) == CharK) ? Char : Integer;
+          if ((t->child[0]->type != type) || (t->child[1]->type != type))
+            typeError(t,"for bounds differ in type from the loop variable");
+          if (assigns(t->child[2],t->attr.name,nprocs))
+            typeError(t,"for loop variable changed in the loop body");
+          break;
+		}
+        case CallK:
+          checkCall(t);
+          break;
+        case CaseK:
+          if ((t->child[0]->type != Integer) && (t->child[0]->type != Char))
+            typeError(t->child[0],"case selector is not an integer or char");
+          checkLabels(t);
+          break;
         default:
           break;
       }
       break;
+    case DeclK:
+      /* parameters have one location each, so a
+         procedure cannot be active twice */
+      if ((t->kind.decl == ProcK) && calls(t->child[1],t->attr.name,nprocs))
+        typeError(t,"recursive call of a procedure");
+      break;
     default:
       break;
 
   }
 }
 
+/* Procedure bindArgs turns the arguments of every
+ * call in the statement sequence at *pp into
+ * assignments to the parameters right in front of
+ * it: the parameters have static locations, so
+ * that is all passing them takes
+ */
+static void bindArgs(TreeNode ** pp)
+{ TreeNode * t, * a, * q, * s, * next;
+  int i;
+  while ((t = *pp) != NULL)
+  { if ((t->nodekind == StmtK) && (t->kind.stmt == CallK))
+    { q = st_proc(t->attr.name)->child[0];
+      for (a=t->child[0];a != NULL;a = next,q = q->sibling)
+      { next = a->sibling;
+        a->sibling = NULL;
+        s = newStmtNode(AssignK);
+        if (s == NULL) return;
+        s->lineno = t->lineno;
+        s->attr.name = q->attr.name;
+        s->child[0] = a;
+        s->sibling = t;
+        *pp = s;
+        pp = &s->sibling;
+      }
+      t->child[0] = NULL;
+    }
+    else
+      for (i=0;i<MAXCHILDREN;i++)
+        if ((t->child[i] != NULL) && (t->child[i]->nodekind == StmtK))
+          bindArgs(&t->child[i]);
+    pp = &t->sibling;
+  }
+}
+
 /* Procedure typeCheck performs type checking 
- * by a postorder syntax tree traversal
+ * by a postorder syntax tree traversal, and then
+ * turns the arguments of calls into assignments
+ * to the parameters
  */
 void typeCheck(TreeNode * syntaxTree)
-{
-	traverse(syntaxTree,nullProc,checkNode);
+{ TreeNode * d;
+  traverse(syntaxTree,nullProc,checkNode);
+  if (Error) return;
+  for (d=syntaxTree->child[0];d != NULL;d = d->sibling)
+    if (d->kind.decl == ProcK) bindArgs(&d->child[1]);
+  bindArgs(&syntaxTree->child[1]);
 }
@@ -14,7 +14,9 @@
 void buildSymtab(TreeNode *);
 
 /* Procedure typeCheck performs type checking 
- * by a postorder syntax tree traversal
+ * by a postorder syntax tree traversal, and then
+ * turns the arguments of calls into assignments
+ * to the parameters
  */
 void typeCheck(TreeNode *);
 
@@ -7,9 +7,13 @@
 /* Kenneth C. Louden                                */
 /****************************************************/
 
+#include <limits.h>
 #include "globals.h"
+#include "util.h"
 #include "symtab.h"
 #include "code.h"
+#include "regalloc.h"
+#include "pass.h"
 #include "cgen.h"
 
 /* tmpOffset is the memory offset for temps
@@ -18,14 +22,374 @@
 */
 static int tmpOffset = 0;
 
+/* scratchRegs is the set (one bit per register) of
+   registers that may hold temporaries in the current
+   statement: ac and every allocatable register that
+   holds no variable there. freeRegs is the part of
+   it not in use right now. ac1 is never in the set;
+   it is only loaded right before the instruction
+   that consumes it
+*/
+static int scratchRegs = 0;
+static int freeRegs = 0;
+
+/* a procedure and a location in its code: where
+   it starts, or a call of it whose jump is to be
+   backpatched */
+typedef struct
+   { TreeNode * proc;
+     int loc;
+   } ProcLoc;
+
+static ProcLoc * entries = NULL, * calls = NULL;
+static int nentries = 0, ncalls = 0, maxlocs = 0;
+
+/* the conditional jumps of a test that are still
+   to be filled in, each on the register it tests */
+typedef struct hole
+   { int loc;
+     char * jump;
+     int r;
+     struct hole * next;
+   } * HoleList;
+
+/* a case statement whose selector is being matched
+   with the labels: the jumps still to be filled in
+   to each arm and to the else part, and the jump
+   tables, each by the location of the instruction
+   taking its address and the labels it covers */
+typedef struct
+   { CaseLabel * labels;
+     HoleList * arms;
+     HoleList deflt;
+     int ntables;
+     int * tableLoc, * tableLo, * tableHi;
+   } CaseGen;
+
 /* prototype for internal recursive code generator */
 static void cGen (TreeNode * tree);
 
+/* prototype for the expression code generator */
+static void genExp( TreeNode * tree, int target);
+
+/* prototype for the test code generator */
+static void genJump( TreeNode * tree, int sense, HoleList * list, int r);
+
+/* Function varReg returns the register that holds
+ * the variable referenced by expression tree, or -1
+ * if tree is not a register variable
+ */
+static int varReg( TreeNode * tree)
+{ if ((tree == NULL) || (tree->nodekind != ExpK) ||
+      (tree->kind.exp != IdK))
+    return -1;
+  return regOf(st_lookup(tree->attr.name));
+}
+
+/* Procedure startTemps sets up the temporary
+ * registers for the statement or loop test t whose
+ * value goes to register target
+ */
+static void startTemps( TreeNode * t, int target)
+{ scratchRegs = (1 << ac) | regFreeAt(t);
+  freeRegs = scratchRegs & ~(1 << target);
+}
+
+/* Function getTemp takes a free temporary register,
+ * returning -1 if all of them are in use
+ */
+static int getTemp(void)
+{ int r;
+  for (r=0;r<pc;r++)
+    if (freeRegs & (1 << r))
+    { freeRegs &= ~(1 << r);
+      return r;
+    }
+  return -1;
+}
+
+/* Procedure putTemp gives back temporary register r */
+static void putTemp( int r)
+{ if ((r >= 0) && (scratchRegs & (1 << r))) freeRegs |= 1 << r;
+}
+
+/* Functions loadOp and storeOp return the
+ * instruction that loads and stores the variable
+ * at memory location loc: chars take a byte each
+ */
+static char * loadOp( int loc)
+{ return st_isByte(loc) ? "LDB" : "LD";
+}
+
+static char * storeOp( int loc)
+{ return st_isByte(loc) ? "STB" : "ST";
+}
+
+/* Function isLeaf is TRUE for an expression that
+ * is loaded by a single instruction
+ */
+static int isLeaf( TreeNode * tree)
+{ return (tree->kind.exp == ConstK) ||
+         ((tree->kind.exp == IdK) && (varReg(tree) < 0));
+}
+
+/* Function regNeed returns the Sethi-Ullman number of
+ * expression tree: the number of registers needed to
+ * evaluate it without storing temporaries in memory
+ */
+static int regNeed( TreeNode * tree)
+{ int l, r;
+  TreeNode * rest;
+  if (tree->kind.exp == IndexK)
+  { l = regNeed(tree->child[0]);
+    return (l > 1) ? l : 1;
+  }
+  if (tree->kind.exp != OpK) return (varReg(tree) >= 0) ? 0 : 1;
+  /* a constant addend takes no register */
+  if (constAddend(tree,&rest,&l))
+  { l = regNeed(rest);
+    return (l > 1) ? l : 1;
+  }
+  l = regNeed(tree->child[0]);
+  r = regNeed(tree->child[1]);
+  if (l == r) return l+1;
+  return (l > r) ? l : r;
+}
+
+/* Procedure genLeaf loads the leaf expression tree
+ * into register target
+ */
+static void genLeaf( TreeNode * tree, int target)
+{ if (tree->kind.exp == ConstK)
+    emitRM("LDC",target,tree->attr.val,0,"load const");
+  else
+  { int loc = st_lookup(tree->attr.name);
+    emitRM(loadOp(loc),target,st_addr(loc),gp,"load id value");
+  }
+}
+
+/* Function genCheck generates the bounds checks of
+ * array access t on the index in register r, which
+ * it may change. A failed check stores to address
+ * -1, which stops the machine with a data memory
+ * fault. It returns what is to be added to r to
+ * get the index back
+ */
+static int genCheck( TreeNode * t, int r)
+{ int n = st_size(t->attr.name);
+  if (t->check == CHECKLOW)
+  { emitRM("JGE",r,1,pc,"check: index >= 0");
+    emitRM("ST",r,-1,gp,"check: index out of bounds");
+    return 0;
+  }
+  if (t->check & CHECKLOW)
+    emitRM("JLT",r,2,pc,"check: index >= 0");
+  /* compare with the size in place */
+  emitRM("LDA",r,-n,r,"check: index - size");
+  emitRM("JLT",r,1,pc,"check: index < size");
+  emitRM("ST",r,-1,gp,"check: index out of bounds");
+  return n;
+}
+
+/* Function genIndex gets the index of array access
+ * t into a register, checked, and returns the
+ * displacement of the element from that register,
+ * which is left in *r. The index is computed in
+ * register target unless it is a constant or a
+ * register variable that needs no checks
+ */
+static int genIndex( TreeNode * t, TreeNode * index, int target, int * r)
+{ int base = st_addr(st_lookup(t->attr.name));
+  if ((t->check == 0) && (index->kind.exp == ConstK))
+  { *r = gp;
+    return base + index->attr.val;
+  }
+  *r = varReg(index);
+  if ((t->check == 0) && (*r >= 0)) return base;
+  *r = target;
+  genExp(index,target);
+  if (t->check == 0) return base;
+  return base + genCheck(t,target);
+}
+
+/* Procedure addLoc records location loc of
+ * procedure proc in list (entries or calls) of n
+ */
+static void addLoc( ProcLoc ** list, int * n, TreeNode * proc, int loc)
+{ if ((nentries == maxlocs) || (ncalls == maxlocs))
+  { maxlocs = maxlocs ? 2*maxlocs : 16;
+    entries = (ProcLoc *) realloc(entries,maxlocs*sizeof(ProcLoc));
+    calls = (ProcLoc *) realloc(calls,maxlocs*sizeof(ProcLoc));
+    if ((entries == NULL) || (calls == NULL))
+    { fprintf(listing,"Out of memory error in code generation\n");
+      Error = TRUE;
+      nentries = ncalls = maxlocs = 0;
+      return;
+    }
+  }
+  (*list)[*n].proc = proc;
+  (*list)[*n].loc = loc;
+  (*n)++;
+}
+
+/* Procedure addHole leaves room for jump on
+ * register r and adds it to list
+ */
+static void addHole( HoleList * list, char * jump, int r)
+{ HoleList h = (HoleList) malloc(sizeof(struct hole));
+  if (h == NULL)
+  { fprintf(listing,"Out of memory error in code generation\n");
+    Error = TRUE;
+    return;
+  }
+  h->loc = emitSkip(1);
+  h->jump = jump;
+  h->r = r;
+  h->next = *list;
+  *list = h;
+}
+
+/* Procedure patchHoles fills in the jumps of list
+ * to go to location to, with comment c
+ */
+static void patchHoles( HoleList list, int to, char * c)
+{ HoleList next;
+  for (;list != NULL;list = next)
+  { next = list->next;
+    emitBackup(list->loc);
+    emitRM_Abs(list->jump,list->r,to,c);
+    emitRestore();
+    free(list);
+  }
+}
+
+/* Procedure genLabelDiff puts the selector in
+ * register r less label val into ac1
+ */
+static void genLabelDiff( int r, int val)
+{ if (val != INT_MIN)
+    emitRM("LDA",ac1,-val,r,"case: selector - label");
+  else
+  { emitRM("LDC",ac1,val,0,"case: load label");
+    emitRO("SUB",ac1,r,ac1,"case: selector - label");
+  }
+}
+
+/* Procedure genDispatch matches the selector in
+ * register r with labels lo..hi of case c, by a
+ * jump table if they are dense, comparing with
+ * them one by one if there are few, and by binary
+ * search on the labels otherwise. The selector is
+ * not needed after a table, which may change r
+ */
+static void genDispatch( CaseGen * c, int r, int lo, int hi)
+{ int k, pivot, split = caseSplit(c->labels,lo,hi,&pivot), low, n;
+  HoleList holes = NULL;
+  if (split == CASETABLE)
+  { low = c->labels[lo].val;
+    n = c->labels[hi].val - low + 1;
+    emitRM("LDA",ac1,-low,r,"case: selector - lowest label");
+    addHole(&c->deflt,"JLT",ac1);
+    emitRM("LDA",ac,-n,ac1,"case: past the table?");
+    addHole(&c->deflt,"JGE",ac);
+    c->tableLoc[c->ntables] = emitSkip(1);
+    emitComment("case: address of jump table belongs here");
+    c->tableLo[c->ntables] = lo;
+    c->tableHi[c->ntables++] = hi;
+    emitRO("ADD",ac,ac,ac1,"case: table entry");
+    emitRM("LDA",pc,0,ac,"case: jmp through table");
+  }
+  else if (split == CASECHAIN)
+  { for (k=lo;k<=hi;k++)
+    { genLabelDiff(r,c->labels[k].val);
+      addHole(&c->arms[c->labels[k].arm],"JEQ",ac1);
+    }
+    addHole(&c->deflt,"LDA",pc);
+  }
+  else
+  { genLabelDiff(r,pivot);
+    addHole(&holes,"JGE",ac1);
+    genDispatch(c,r,lo,split-1);
+    patchHoles(holes,emitSkip(0),"case: jmp to higher labels");
+    genDispatch(c,r,split,hi);
+  }
+}
+
+/* Procedure genCase generates code for case
+ * statement tree: the dispatch on the selector,
+ * then the else part and the arms, all but the
+ * last jumping to the end. The jump tables are
+ * filled in once the arms are placed
+ */
+static void genCase( TreeNode * tree)
+{ CaseGen c;
+  TreeNode * arm;
+  HoleList holes = NULL;
+  int n, narms = 0, k, j, r, low, size, defLoc = -1, * armLoc, * to;
+  c.labels = caseLabels(tree,&n);
+  for (arm=tree->child[1];arm != NULL;arm = arm->sibling) narms++;
+  c.arms = (HoleList *) calloc(narms+1,sizeof(HoleList));
+  armLoc = (int *) malloc((narms+1)*sizeof(int));
+  c.tableLoc = (int *) malloc(3*(n+1)*sizeof(int));
+  if ((c.arms == NULL) || (armLoc == NULL) || (c.tableLoc == NULL))
+  { fprintf(listing,"Out of memory error in code generation\n");
+    Error = TRUE;
+    return;
+  }
+  c.tableLo = c.tableLoc + n + 1;
+  c.tableHi = c.tableLo + n + 1;
+  c.deflt = NULL;
+  c.ntables = 0;
+  r = varReg(tree->child[0]);
+  if (r < 0)
+  { startTemps(tree,ac);
+    genExp(tree->child[0],ac);
+    r = ac;
+  }
+  genDispatch(&c,r,0,n-1);
+  if (tree->child[2] != NULL)
+  { defLoc = emitSkip(0);
+    patchHoles(c.deflt,defLoc,"case: jmp to else");
+    cGen(tree->child[2]);
+    addHole(&holes,"LDA",pc);
+  }
+  for (arm=tree->child[1],k=0;arm != NULL;arm = arm->sibling,k++)
+  { armLoc[k] = emitSkip(0);
+    patchHoles(c.arms[k],armLoc[k],"case: jmp to arm");
+    cGen(arm->child[1]);
+    if (arm->sibling != NULL) addHole(&holes,"LDA",pc);
+  }
+  patchHoles(holes,emitSkip(0),"case: jmp to end");
+  if (defLoc < 0)
+  { defLoc = emitSkip(0);
+    patchHoles(c.deflt,defLoc,"case: jmp to end");
+  }
+  for (k=0;k<c.ntables;k++)
+  { low = c.labels[c.tableLo[k]].val;
+    size = c.labels[c.tableHi[k]].val - low + 1;
+    to = (int *) malloc(size*sizeof(int));
+    if (to == NULL) continue;
+    for (j=0;j<size;j++) to[j] = defLoc;
+    for (j=c.tableLo[k];j<=c.tableHi[k];j++)
+      to[c.labels[j].val - low] = armLoc[c.labels[j].arm];
+    addJumpTable(c.tableLoc[k],to,size);
+    free(to);
+  }
+  free(c.labels);
+  free(c.arms);
+  free(c.tableLoc);
+  free(armLoc);
+}
+
 /* Procedure genStmt generates code at a statement node */
 static void genStmt( TreeNode * tree)
 { TreeNode * p1, * p2, * p3;
   int savedLoc1,savedLoc2,currentLoc;
-  int loc;
+  int loc, r, k, ri;
+  HoleList holes = NULL;
+  /* fetch variables whose register life starts here */
+  for (k=0;(loc = regLoadAt(tree,k)) >= 0;k++)
+    emitRM("LD",regOf(loc),st_addr(loc),gp,"regalloc: load variable");
   switch (tree->kind.stmt) {
 
       case IfK :
@@ -34,17 +398,15 @@ static void genStmt( TreeNode * tree)
          p2 = tree->child[1] ;
          p3 = tree->child[2] ;
          /* generate code for test expression */
-         cGen(p1);
-         savedLoc1 = emitSkip(1) ;
-         emitComment("if: jump to else belongs here");
+         startTemps(tree,ac);
+         genJump(p1,FALSE,&holes,ac);
+         emitComment("if: jumps to else belong here");
          /* recurse on then part */
          cGen(p2);
          savedLoc2 = emitSkip(1) ;
          emitComment("if: jump to end belongs here");
          currentLoc = emitSkip(0) ;
-         emitBackup(savedLoc1) ;
-         emitRM_Abs("JEQ",ac,currentLoc,"if: jmp to else");
-         emitRestore() ;
+         patchHoles(holes,currentLoc,"if: jmp to else");
          /* recurse on else part */
          cGen(p3);
          currentLoc = emitSkip(0) ;
@@ -63,101 +425,364 @@ static void genStmt( TreeNode * tree)
          /* generate code for body */
          cGen(p1);
          /* generate code for test */
-         cGen(p2);
-         emitRM_Abs("JEQ",ac,savedLoc1,"repeat: jmp back to body");
+         startTemps(p2,ac);
+         genJump(p2,FALSE,&holes,ac);
+         patchHoles(holes,savedLoc1,"repeat: jmp back to body");
          if (TraceCode)  emitComment("<- repeat") ;
          break; /* repeat */
 
+      case WhileK:
+         if (TraceCode) emitComment("-> while") ;
+         p1 = tree->child[0] ;
+         p2 = tree->child[1] ;
+         /* the test goes after the body, and the loop
+            is entered by a jump to it */
+         savedLoc1 = emitSkip(1) ;
+         savedLoc2 = emitSkip(0) ;
+         emitComment("while: jump after test comes back here");
+         cGen(p2);
+         currentLoc = emitSkip(0) ;
+         emitBackup(savedLoc1) ;
+         emitRM_Abs("LDA",pc,currentLoc,"while: jmp to test") ;
+         emitRestore() ;
+         startTemps(p1,ac);
+         genJump(p1,TRUE,&holes,ac);
+         patchHoles(holes,savedLoc2,"while: jmp back to body");
+         if (TraceCode)  emitComment("<- while") ;
+         break; /* while */
+
+      case ForK:
+         if (TraceCode) emitComment("-> for") ;
+         loc = st_lookup(tree->attr.name);
+         r = regOf(loc);
+         /* both bounds are evaluated before the
+            variable is set */
+         startTemps(tree,ac);
+         genExp(tree->child[0],ac);
+         emitRM("ST",ac,tmpOffset--,mp,"for: push first value");
+         genExp(tree->child[1],ac);
+         emitRM("LD",ac1,++tmpOffset,mp,"for: load first value");
+         if (r >= 0) emitRM("LDA",r,0,ac1,"for: set variable");
+         else emitRM(storeOp(loc),ac1,st_addr(loc),gp,"for: set variable");
+         /* the count of iterations still to go, less
+            one, stays on the stack; the body runs
+            while it is not negative */
+         emitRO("SUB",ac,ac,ac1,"for: last - first");
+         emitRM("ST",ac,tmpOffset--,mp,"for: push count");
+         savedLoc1 = emitSkip(1) ;
+         savedLoc2 = emitSkip(0) ;
+         emitComment("for: jump after test comes back here");
+         cGen(tree->child[2]);
+         if (r >= 0) emitRM("LDA",r,1,r,"for: step variable");
+         else
+         { emitRM(loadOp(loc),ac,st_addr(loc),gp,"for: load variable");
+           emitRM("LDA",ac,1,ac,"for: step variable");
+           emitRM(storeOp(loc),ac,st_addr(loc),gp,"for: store variable");
+         }
+         emitRM("LD",ac,tmpOffset+1,mp,"for: load count");
+         emitRM("LDA",ac,-1,ac,"for: count down");
+         emitRM("ST",ac,tmpOffset+1,mp,"for: store count");
+         currentLoc = emitSkip(0) ;
+         emitBackup(savedLoc1) ;
+         emitRM_Abs("LDA",pc,currentLoc,"for: jmp to test") ;
+         emitRestore() ;
+         emitRM_Abs("JGE",ac,savedLoc2,"for: jmp back to body");
+         tmpOffset++;
+         if (TraceCode)  emitComment("<- for") ;
+         break; /* for */
+
       case AssignK:
          if (TraceCode) emitComment("-> assign") ;
-         /* generate code for rhs */
-         cGen(tree->child[0]);
-         /* now store value */
+         if (tree->child[1] != NULL)
+         { /* element store: the index first, kept in a
+              temporary (or pushed) while the value is
+              computed into ac */
+           startTemps(tree,ac);
+           r = getTemp();
+           loc = genIndex(tree,tree->child[1],(r >= 0) ? r : ac,&ri);
+           if (ri == ac)
+             emitRM("ST",ac,tmpOffset--,mp,"assign: push index");
+           genExp(tree->child[0],ac);
+           if (ri == ac)
+           { emitRM("LD",ac1,++tmpOffset,mp,"assign: load index");
+             ri = ac1;
+           }
+           emitRM(storeOp(st_lookup(tree->attr.name)),ac,loc,ri,
+                  "assign: store element");
+           putTemp(r);
+           if (TraceCode)  emitComment("<- assign") ;
+           break;
+         }
          loc = st_lookup(tree->attr.name);
-         emitRM("ST",ac,loc,gp,"assign: store value");
+         r = regOf(loc);
+         if (r >= 0)
+         { /* compute rhs straight into the register */
+           startTemps(tree,r);
+           if (varReg(tree->child[0]) != r)
+             genExp(tree->child[0],r);
+         }
+         else
+         { /* generate code for rhs */
+           startTemps(tree,ac);
+           genExp(tree->child[0],ac);
+           /* now store value */
+           emitRM(storeOp(loc),ac,st_addr(loc),gp,"assign: store value");
+         }
          if (TraceCode)  emitComment("<- assign") ;
          break; /* assign_k */
 
       case ReadK:
-         emitRO("IN",ac,0,0,"read integer value");
+         if (tree->child[0] != NULL)
+         { /* the index is checked before reading */
+           startTemps(tree,ac);
+           loc = genIndex(tree,tree->child[0],ac,&ri);
+           emitRO("IN",ac1,0,0,"read integer value");
+           emitRM(storeOp(st_lookup(tree->attr.name)),ac1,loc,ri,
+                  "read: store element");
+           break;
+         }
          loc = st_lookup(tree->attr.name);
-         emitRM("ST",ac,loc,gp,"read: store value");
+         r = regOf(loc);
+         if (r >= 0)
+           emitRO("IN",r,0,0,"read integer value");
+         else
+         { emitRO("IN",ac,0,0,"read integer value");
+           emitRM(storeOp(loc),ac,st_addr(loc),gp,"read: store value");
+         }
          break;
       case WriteK:
-         /* generate code for expression to write */
-         cGen(tree->child[0]);
+         r = varReg(tree->child[0]);
+         if (r < 0)
+         { /* generate code for expression to write */
+           startTemps(tree,ac);
+           genExp(tree->child[0],ac);
+           r = ac;
+         }
          /* now output it */
-         emitRO("OUT",ac,0,0,"write ac");
+         emitRO("OUT",r,0,0,"write ac");
+         break;
+      case CallK:
+         if (TraceCode) emitComment("-> call") ;
+         /* the frame of the procedure goes below the
+            temporaries pushed so far; the return
+            address is passed in ac */
+         if (tmpOffset != 0)
+           emitRM("LDA",mp,tmpOffset,mp,"call: skip temporaries");
+         emitRM("LDA",ac,1,pc,"call: return address");
+         addLoc(&calls,&ncalls,st_proc(tree->attr.name),emitSkip(1));
+         emitComment("call: jump to procedure belongs here");
+         if (tmpOffset != 0)
+           emitRM("LDA",mp,-tmpOffset,mp,"call: back to temporaries");
+         if (TraceCode)  emitComment("<- call") ;
+         break;
+      case CaseK:
+         if (TraceCode) emitComment("-> case") ;
+         genCase(tree);
+         if (TraceCode)  emitComment("<- case") ;
          break;
       default:
          break;
     }
 } /* genStmt */
 
-/* Procedure genExp generates code at an expression node */
-static void genExp( TreeNode * tree)
-{ int loc;
-  TreeNode * p1, * p2;
+/* Procedure genOp generates code at an operator node
+ * leaving its value in register target; for a
+ * comparison the value left is the difference of the
+ * operands, whose sign or zeroness gives the result
+ */
+static void genOp( TreeNode * tree, int target)
+{ int loc, s, t, r1, r2, avail, spilled;
+  TreeNode * p1, * p2, * first, * second;
+  if (TraceCode) emitComment("-> Op") ;
+  p1 = tree->child[0];
+  p2 = tree->child[1];
+  /* target may hold a temporary only if it is
+     not a variable read by the expression */
+  avail = (scratchRegs & (1 << target)) ? target : -1;
+  if (constAddend(tree,&first,&loc))
+  { /* add the constant with LDA */
+    r1 = varReg(first);
+    if (r1 < 0)
+    { r1 = (avail >= 0) ? avail : getTemp();
+      genExp(first,r1);
+    }
+    emitRM("LDA",target,loc,r1,"op: add constant");
+    if (r1 != target) putTemp(r1);
+    if (TraceCode)  emitComment("<- Op") ;
+    return;
+  }
+  /* evaluate the operand needing more registers
+     first, so the other one can use the rest */
+  if (regNeed(p2) > regNeed(p1))
+  { first = p2;
+    second = p1;
+  }
+  else
+  { first = p1;
+    second = p2;
+  }
+  spilled = FALSE;
+  /* register variables are used in place */
+  r1 = varReg(first);
+  if (r1 < 0)
+  { if (avail >= 0)
+    { r1 = avail;
+      avail = -1;
+    }
+    else r1 = getTemp();
+    genExp(first,r1);
+  }
+  r2 = varReg(second);
+  if ((r2 < 0) && isLeaf(second))
+    r2 = ac1;
+  else if (r2 < 0)
+  { if (avail >= 0)
+    { r2 = avail;
+      avail = -1;
+    }
+    else r2 = getTemp();
+    if (r2 < 0)
+    { /* out of registers: push first operand */
+      emitRM("ST",r1,tmpOffset--,mp,"op: push operand");
+      spilled = TRUE;
+      r2 = r1;
+    }
+    genExp(second,r2);
+  }
+  if (r2 == ac1) genLeaf(second,ac1);
+  if (spilled)
+  { emitRM("LD",ac1,++tmpOffset,mp,"op: load operand");
+    r1 = ac1;
+  }
+  if (first == p1)
+  { s = r1;
+    t = r2;
+  }
+  else
+  { s = r2;
+    t = r1;
+  }
+  switch (tree->attr.op) {
+     case PLUS :
+        emitRO("ADD",target,s,t,"op +");
+        break;
+     case MINUS :
+        emitRO("SUB",target,s,t,"op -");
+        break;
+     case TIMES :
+        emitRO("MUL",target,s,t,"op *");
+        break;
+     case OVER :
+        emitRO("DIV",target,s,t,"op /");
+        break;
+     case LT :
+        emitRO("SUB",target,s,t,"op <") ;
+        break;
+     case EQ :
+        emitRO("SUB",target,s,t,"op ==") ;
+        break;
+     default:
+        emitComment("BUG: Unknown operator");
+        break;
+  } /* case op */
+  /* the operand registers are free again */
+  if (r1 != target) putTemp(r1);
+  if (r2 != target) putTemp(r2);
+  if (TraceCode)  emitComment("<- Op") ;
+} /* genOp */
+
+/* Procedure genJump generates code for test tree
+ * that jumps when its value is sense and falls
+ * through otherwise, adding the jumps (on register
+ * r) to list. A comparison jumps on the sign of the
+ * difference directly, and the second operand of
+ * and or or is skipped as soon as the first one
+ * decides, so no truth value is ever built
+ */
+static void genJump( TreeNode * tree, int sense, HoleList * list, int r)
+{ HoleList past = NULL;
+  if (tree->kind.exp == ConstK)
+  { if ((tree->attr.val != 0) == sense) addHole(list,"LDA",pc);
+    return;
+  }
+  if (tree->kind.exp == OpK)
+    switch (tree->attr.op)
+    { case NOT :
+        genJump(tree->child[0],!sense,list,r);
+        return;
+      case AND :
+      case OR :
+        /* the first operand jumps to where the
+           whole test does, or past the second */
+        if (sense == (tree->attr.op == OR))
+          genJump(tree->child[0],sense,list,r);
+        else
+          genJump(tree->child[0],!sense,&past,r);
+        genJump(tree->child[1],sense,list,r);
+        patchHoles(past,emitSkip(0),"jmp past second operand");
+        return;
+      case LT :
+        genOp(tree,r);
+        addHole(list,sense ? "JLT" : "JGE",r);
+        return;
+      case EQ :
+        genOp(tree,r);
+        addHole(list,sense ? "JEQ" : "JNE",r);
+        return;
+      default :
+        break;
+    }
+  genExp(tree,r);
+  addHole(list,sense ? "JNE" : "JEQ",r);
+}
+
+/* Procedure genExp generates code at an expression node
+ * leaving the value of the expression in register target
+ */
+static void genExp( TreeNode * tree, int target)
+{ int loc, r;
   switch (tree->kind.exp) {
 
     case ConstK :
       if (TraceCode) emitComment("-> Const") ;
       /* gen code to load integer constant using LDC */
-      emitRM("LDC",ac,tree->attr.val,0,"load const");
+      emitRM("LDC",target,tree->attr.val,0,"load const");
       if (TraceCode)  emitComment("<- Const") ;
       break; /* ConstK */
     
     case IdK :
       if (TraceCode) emitComment("-> Id") ;
       loc = st_lookup(tree->attr.name);
-      emitRM("LD",ac,loc,gp,"load id value");
+      if (regOf(loc) >= 0)
+        emitRM("LDA",target,0,regOf(loc),"copy register variable");
+      else
+        emitRM(loadOp(loc),target,st_addr(loc),gp,"load id value");
       if (TraceCode)  emitComment("<- Id") ;
       break; /* IdK */
 
+    case IndexK :
+      if (TraceCode) emitComment("-> Index") ;
+      loc = genIndex(tree,tree->child[0],target,&r);
+      emitRM(loadOp(st_lookup(tree->attr.name)),target,loc,r,
+             "load array element");
+      if (TraceCode)  emitComment("<- Index") ;
+      break; /* IndexK */
+
     case OpK :
-         if (TraceCode) emitComment("-> Op") ;
-         p1 = tree->child[0];
-         p2 = tree->child[1];
-         /* gen code for ac = left arg */
-         cGen(p1);
-         /* gen code to push left operand */
-         emitRM("ST",ac,tmpOffset--,mp,"op: push left");
-         /* gen code for ac = right operand */
-         cGen(p2);
-         /* now load left operand */
-         emitRM("LD",ac1,++tmpOffset,mp,"op: load left");
-         switch (tree->attr.op) {
-            case PLUS :
-               emitRO("ADD",ac,ac1,ac,"op +");
-               break;
-            case MINUS :
-               emitRO("SUB",ac,ac1,ac,"op -");
-               break;
-            case TIMES :
-               emitRO("MUL",ac,ac1,ac,"op *");
-               break;
-            case OVER :
-               emitRO("DIV",ac,ac1,ac,"op /");
-               break;
-            case LT :
-               emitRO("SUB",ac,ac1,ac,"op <") ;
-               emitRM("JLT",ac,2,pc,"br if true") ;
-               emitRM("LDC",ac,0,ac,"false case") ;
-               emitRM("LDA",pc,1,pc,"unconditional jmp") ;
-               emitRM("LDC",ac,1,ac,"true case") ;
-               break;
-            case EQ :
-               emitRO("SUB",ac,ac1,ac,"op ==") ;
-               emitRM("JEQ",ac,2,pc,"br if true");
-               emitRM("LDC",ac,0,ac,"false case") ;
-               emitRM("LDA",pc,1,pc,"unconditional jmp") ;
-               emitRM("LDC",ac,1,ac,"true case") ;
-               break;
-            default:
-               emitComment("BUG: Unknown operator");
-               break;
-         } /* case op */
-         if (TraceCode)  emitComment("<- Op") ;
+         genOp(tree,target);
+         /* turn the difference into 0 or 1 */
+         if (tree->attr.op == LT)
+         { emitRM("JLT",target,2,pc,"br if true") ;
+           emitRM("LDC",target,0,0,"false case") ;
+           emitRM("LDA",pc,1,pc,"unconditional jmp") ;
+           emitRM("LDC",target,1,0,"true case") ;
+         }
+         else if (tree->attr.op == EQ)
+         { emitRM("JEQ",target,2,pc,"br if true");
+           emitRM("LDC",target,0,0,"false case") ;
+           emitRM("LDA",pc,1,pc,"unconditional jmp") ;
+           emitRM("LDC",target,1,0,"true case") ;
+         }
          break; /* OpK */
 
     default:
@@ -175,7 +800,7 @@ static void cGen( TreeNode * tree)
         genStmt(tree);
         break;
       case ExpK:
-        genExp(tree);
+        genExp(tree,ac);
         break;
       default:
         break;
@@ -184,29 +809,98 @@ static void cGen( TreeNode * tree)
   }
 }
 
+/* Procedure genProc generates the code of
+ * procedure d. Its variables live in memory, and
+ * its statements take no register from FIRSTREG to
+ * LASTREG, so the caller's registers survive the
+ * call; the frame holds the return address
+ */
+static void genProc( TreeNode * d)
+{ emitFunction(d->attr.name);
+  if (TraceCode) emitComment("-> procedure") ;
+  emitComment(d->attr.name);
+  addLoc(&entries,&nentries,d,emitSkip(0));
+  emitRM("ST",ac,0,mp,"procedure: save return address");
+  emitRM("LDA",mp,-1,mp,"procedure: push frame");
+  tmpOffset = 0;
+  cGen(d->child[1]);
+  emitRM("LDA",mp,1,mp,"procedure: pop frame");
+  emitRM("LD",pc,0,mp,"procedure: return");
+  if (TraceCode)  emitComment("<- procedure") ;
+}
+
+/* Procedure patchCalls backpatches the jumps of
+ * the calls to the entries of the procedures
+ */
+static void patchCalls(void)
+{ int i, k;
+  for (i=0;i<ncalls;i++)
+  { for (k=0;(k < nentries) && (entries[k].proc != calls[i].proc);k++)
+      ;
+    if (k == nentries) continue;
+    emitBackup(calls[i].loc);
+    emitRM_Abs("LDA",pc,entries[k].loc,"call: jmp to procedure");
+    emitRestore();
+  }
+}
+
 /**********************************************/
 /* the primary function of the code generator */
 /**********************************************/
 /* Procedure codeGen generates code to a code
- * file by traversal of the syntax tree. The
+ * file by traversal of the syntax tree, the
+ * main program followed by the procedures and
+ * the jump tables of the case statements. The
  * second parameter (codefile) is the file name
  * of the code file, and is used to print the
  * file name as a comment in the code file
  */
 void codeGen(TreeNode * syntaxTree, char * codefile)
-{  char * s = malloc(strlen(codefile)+7);
+{  TreeNode * d;
+   int a, w;
+   char * s = malloc(strlen(codefile)+7);
    strcpy(s,"File: ");
    strcat(s,codefile);
+   emitFunction("program");
    emitComment("TINY Compilation to TM Code");
    emitComment(s);
    /* generate standard prelude */
    emitComment("Standard prelude:");
    emitRM("LD",mp,0,ac,"load maxaddress from location 0");
-   emitRM("ST",ac,0,ac,"clear location 0");
+   /* location 0 holds the maxaddress until now, so
+      its initial value is stored here; the data
+      section gives the others */
+   if ((w = st_initWord(0)) != 0)
+   { emitRM("LDC",ac1,w,0,"load initial value of location 0");
+     emitRM("ST",ac1,0,ac,"initialize location 0");
+   }
+   else emitRM("ST",ac,0,ac,"clear location 0");
+   for (a=1;a<st_datasize();a++)
+     if ((w = st_initWord(a)) != 0) emitData(a,w,"initial value");
    emitComment("End of standard prelude.");
+   nentries = ncalls = 0;
+   /* keep the busiest variables in registers */
+   allocRegs(syntaxTree->child[1]);
+   if (TraceCode)
+   { int loc;
+     for (loc=0;loc<st_maxloc();loc++)
+       if (regOf(loc) >= 0)
+       { char buf[80];
+         sprintf(buf,"regalloc: %.40s in register %d",
+                 regVarName(loc),regOf(loc));
+         emitComment(buf);
+       }
+   }
    /* generate code for TINY program */
-   cGen(syntaxTree);
+   cGen(syntaxTree->child[1]);
    /* finish */
    emitComment("End of execution.");
    emitRO("HALT",0,0,0,"");
+   for (d=syntaxTree->child[0];d != NULL;d = d->sibling)
+     if (d->kind.decl == ProcK) genProc(d);
+   emitJumpTables();
+   patchCalls();
+   /* clean up the buffered code and write it out */
+   runCodePasses();
+   emitFlush();
 }
@@ -9,7 +9,8 @@
 #define _CGEN_H_
 
 /* Procedure codeGen generates code to a code
- * file by traversal of the syntax tree. The
+ * file by traversal of the syntax tree, the
+ * main program followed by the procedures. The
  * second parameter (codefile) is the file name
  * of the code file, and is used to print the
  * file name as a comment in the code file
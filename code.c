@@ -17,11 +17,116 @@ static int emitLoc = 0 ;
    emitBackup, and emitRestore */
 static int highEmitLoc = 0;
 
-/* Procedure emitComment prints a comment line 
+/* the buffered instructions; iCodeSize always
+   equals highEmitLoc */
+TMInstr iCode[MAXCODE];
+int iCodeSize = 0;
+
+/* comments are kept with the location of the
+   instruction they are printed in front of */
+typedef struct CommentRec
+   { int loc;
+     char * text;
+     struct CommentRec * next;
+   } * CommentList;
+
+static CommentList comments = NULL;
+static CommentList lastComment = NULL;
+
+/* where the code of each function starts */
+typedef struct FuncRec
+   { int loc;
+     char * name;
+     struct FuncRec * next;
+   } * FuncList;
+
+static FuncList funcs = NULL;
+static FuncList lastFunc = NULL;
+
+/* the jump tables waiting to be emitted */
+typedef struct TableRec
+   { int loc;
+     int n;
+     int * to;
+     struct TableRec * next;
+   } * TableList;
+
+static TableList tables = NULL;
+static TableList lastTable = NULL;
+
+/* the initial values of data memory, printed in
+   a data section after the code */
+typedef struct DataRec
+   { int addr;
+     int val;
+     char * comment;
+     struct DataRec * next;
+   } * DataList;
+
+static DataList data = NULL;
+static DataList lastData = NULL;
+
+static char * saveString( char * s)
+{ char * t = malloc(strlen(s)+1);
+  if (t != NULL) strcpy(t,s);
+  return t;
+}
+
+/* Procedure emitComment prints a comment line
  * with comment c in the code file
  */
 void emitComment( char * c )
-{ if (TraceCode) fprintf(code,"* %s\n",c);}
+{ CommentList l;
+  if (! TraceCode) return;
+  l = (CommentList) malloc(sizeof(struct CommentRec));
+  if (l == NULL) return;
+  l->loc = emitLoc;
+  l->text = saveString(c);
+  l->next = NULL;
+  if (lastComment == NULL) comments = l;
+  else lastComment->next = l;
+  lastComment = l;
+}
+
+/* isJumpOp is TRUE for the conditional jumps */
+static int isJumpOp( char * op)
+{ return (op[0] == 'J');
+}
+
+/* Procedure saveInstr buffers an instruction at
+ * the current emission location
+ */
+static void saveInstr( char * op, int isRM, int r, int d, int s, int t,
+                       char * c)
+{ TMInstr * i;
+  if (emitLoc >= MAXCODE)
+  { if (emitLoc == MAXCODE)
+      fprintf(listing,"Code too large (more than %d instructions)\n",
+              MAXCODE);
+    Error = TRUE;
+    emitLoc++;
+    return;
+  }
+  i = &iCode[emitLoc];
+  i->op = op;
+  i->isRM = isRM;
+  i->r = r;
+  i->d = d;
+  i->s = s;
+  i->t = t;
+  i->target = -1;
+  /* remember where pc-relative jumps go, and the
+     return addresses of calls */
+  if (isRM && (s == pc) &&
+      (isJumpOp(op) || (r == pc) || (strcmp(op,"LDA") == 0)))
+    i->target = emitLoc + 1 + d;
+  i->comment = TraceCode ? saveString(c) : NULL;
+  i->deleted = FALSE;
+  emitLoc++;
+  if (highEmitLoc < emitLoc) highEmitLoc = emitLoc ;
+  if (highEmitLoc > MAXCODE) iCodeSize = MAXCODE;
+  else iCodeSize = highEmitLoc;
+}
 
 /* Procedure emitRO emits a register-only
  * TM instruction
@@ -32,10 +137,7 @@ void emitComment( char * c )
  * c = a comment to be printed if TraceCode is TRUE
  */
 void emitRO( char *op, int r, int s, int t, char *c)
-{ fprintf(code,"%3d:  %5s  %d,%d,%d ",emitLoc++,op,r,s,t);
-  if (TraceCode) fprintf(code,"\t%s",c) ;
-  fprintf(code,"\n") ;
-  if (highEmitLoc < emitLoc) highEmitLoc = emitLoc ;
+{ saveInstr(op,FALSE,r,0,s,t,c);
 } /* emitRO */
 
 /* Procedure emitRM emits a register-to-memory
@@ -47,10 +149,7 @@ void emitRO( char *op, int r, int s, int t, char *c)
  * c = a comment to be printed if TraceCode is TRUE
  */
 void emitRM( char * op, int r, int d, int s, char *c)
-{ fprintf(code,"%3d:  %5s  %d,%d(%d) ",emitLoc++,op,r,d,s);
-  if (TraceCode) fprintf(code,"\t%s",c) ;
-  fprintf(code,"\n") ;
-  if (highEmitLoc < emitLoc)  highEmitLoc = emitLoc ;
+{ saveInstr(op,TRUE,r,d,s,0,c);
 } /* emitRM */
 
 /* Function emitSkip skips "howMany" code
@@ -64,7 +163,7 @@ int emitSkip( int howMany)
    return i;
 } /* emitSkip */
 
-/* Procedure emitBackup backs up to 
+/* Procedure emitBackup backs up to
  * loc = a previously skipped location
  */
 void emitBackup( int loc)
@@ -72,14 +171,14 @@ void emitBackup( int loc)
   emitLoc = loc ;
 } /* emitBackup */
 
-/* Procedure emitRestore restores the current 
+/* Procedure emitRestore restores the current
  * code position to the highest previously
  * unemitted position
  */
 void emitRestore(void)
 { emitLoc = highEmitLoc;}
 
-/* Procedure emitRM_Abs converts an absolute reference 
+/* Procedure emitRM_Abs converts an absolute reference
  * to a pc-relative reference when emitting a
  * register-to-memory TM instruction
  * op = the opcode
@@ -88,10 +187,231 @@ void emitRestore(void)
  * c = a comment to be printed if TraceCode is TRUE
  */
 void emitRM_Abs( char *op, int r, int a, char * c)
-{ fprintf(code,"%3d:  %5s  %d,%d(%d) ",
-               emitLoc,op,r,a-(emitLoc+1),pc);
-  ++emitLoc ;
-  if (TraceCode) fprintf(code,"\t%s",c) ;
-  fprintf(code,"\n") ;
-  if (highEmitLoc < emitLoc) highEmitLoc = emitLoc ;
+{ saveInstr(op,TRUE,r,a-(emitLoc+1),pc,0,c);
 } /* emitRM_Abs */
+
+/* Procedure emitFunction marks the current location
+ * as the start of the code of function name
+ */
+void emitFunction( char * name)
+{ FuncList l = (FuncList) malloc(sizeof(struct FuncRec));
+  if (l == NULL) return;
+  l->loc = emitLoc;
+  l->name = saveString(name);
+  l->next = NULL;
+  if (lastFunc == NULL) funcs = l;
+  else lastFunc->next = l;
+  lastFunc = l;
+} /* emitFunction */
+
+/* Procedure addJumpTable records a table of n
+ * jumps to the absolute locations to[], to be
+ * emitted by emitJumpTables; the instruction
+ * skipped at loc is then made to load the address
+ * of the table into ac
+ */
+void addJumpTable( int loc, int * to, int n)
+{ TableList l = (TableList) malloc(sizeof(struct TableRec));
+  if (l != NULL) l->to = (int *) malloc(n * sizeof(int));
+  if ((l == NULL) || (l->to == NULL))
+  { fprintf(listing,"Out of memory error in code generation\n");
+    Error = TRUE;
+    free(l);
+    return;
+  }
+  l->loc = loc;
+  l->n = n;
+  memcpy(l->to,to,n * sizeof(int));
+  l->next = NULL;
+  if (lastTable == NULL) tables = l;
+  else lastTable->next = l;
+  lastTable = l;
+} /* addJumpTable */
+
+/* Procedure emitData records that word addr of
+ * data memory starts out holding val instead of 0
+ */
+void emitData( int addr, int val, char * c)
+{ DataList l = (DataList) malloc(sizeof(struct DataRec));
+  if (l == NULL)
+  { fprintf(listing,"Out of memory error writing code\n");
+    return;
+  }
+  l->addr = addr;
+  l->val = val;
+  l->comment = TraceCode ? saveString(c) : NULL;
+  l->next = NULL;
+  if (lastData == NULL) data = l;
+  else lastData->next = l;
+  lastData = l;
+}
+
+/* Procedure emitJumpTables emits the jump tables
+ * recorded so far. They go after all other code,
+ * where control never falls into them
+ */
+void emitJumpTables(void)
+{ TableList l;
+  int k;
+  if (tables != NULL) emitFunction("jump tables");
+  while ((l = tables) != NULL)
+  { emitBackup(l->loc);
+    emitRM_Abs("LDA",ac,highEmitLoc,"case: address of jump table");
+    emitRestore();
+    for (k=0;k<l->n;k++)
+      emitRM_Abs("LDA",pc,l->to[k],"case: jump table entry");
+    tables = l->next;
+    free(l->to);
+    free(l);
+  }
+  lastTable = NULL;
+} /* emitJumpTables */
+
+/* Procedure listCodeSize prints the number of
+ * instructions the code of each function takes
+ */
+void listCodeSize(void)
+{ FuncList l;
+  int total = emitFinalLoc(iCodeSize);
+  fprintf(listing,"\nCode size by function:\n");
+  for (l=funcs;l != NULL;l = l->next)
+    fprintf(listing,"  %-20s %5d instructions\n",l->name,
+            emitFinalLoc((l->next == NULL) ? iCodeSize : l->next->loc) -
+            emitFinalLoc(l->loc));
+  fprintf(listing,"  %-20s %5d instructions\n","total",total);
+} /* listCodeSize */
+
+/* Function emitFinalLoc returns the location the
+ * buffered instruction at loc will have in the code
+ * file once the deleted instructions are dropped
+ */
+int emitFinalLoc( int loc)
+{ int k, n = 0;
+  for (k=0;(k<loc) && (k<iCodeSize);k++)
+    if (! iCode[k].deleted) n++;
+  return n;
+} /* emitFinalLoc */
+
+/* Function emitChecksum returns the checksum of
+ * the buffered code as the code file will give it,
+ * computed as the TM simulator does for the profile
+ */
+unsigned emitChecksum(void)
+{ unsigned sum = 0;
+  int loc, n = 0, arg[3], k;
+  char * c;
+  for (loc=0;loc<iCodeSize;loc++)
+  { TMInstr * i = &iCode[loc];
+    if (i->deleted) continue;
+    arg[0] = i->r;
+    if (i->op == NULL)
+    { /* never filled in: the simulator loads HALT */
+      c = "HALT";
+      arg[0] = arg[1] = arg[2] = 0;
+    }
+    else if (i->isRM)
+    { c = i->op;
+      arg[1] = (i->target >= 0) ? emitFinalLoc(i->target) - (n + 1) : i->d;
+      arg[2] = i->s;
+    }
+    else
+    { c = i->op;
+      arg[1] = i->s;
+      arg[2] = i->t;
+    }
+    for (;*c != '\0';c++) sum = sum * 31 + (unsigned char) *c;
+    for (k=0;k<3;k++) sum = sum * 31 + (unsigned) arg[k];
+    n++;
+  }
+  return sum;
+} /* emitChecksum */
+
+/* Procedure emitReset throws the buffered code,
+ * comments and data away, so code can be generated
+ * afresh
+ */
+void emitReset(void)
+{ int loc;
+  CommentList l;
+  FuncList f;
+  DataList d;
+  for (loc=0;loc<iCodeSize;loc++)
+  { free(iCode[loc].comment);
+    iCode[loc].comment = NULL;
+    iCode[loc].op = NULL;
+  }
+  while ((l = comments) != NULL)
+  { comments = l->next;
+    free(l->text);
+    free(l);
+  }
+  lastComment = NULL;
+  while ((f = funcs) != NULL)
+  { funcs = f->next;
+    free(f->name);
+    free(f);
+  }
+  lastFunc = NULL;
+  while ((d = data) != NULL)
+  { data = d->next;
+    free(d->comment);
+    free(d);
+  }
+  lastData = NULL;
+  emitLoc = highEmitLoc = iCodeSize = 0;
+} /* emitReset */
+
+/* Procedure emitFlush writes the buffered code to
+ * the code file, dropping deleted instructions and
+ * recomputing the pc-relative jump displacements,
+ * and then the data section
+ */
+void emitFlush(void)
+{ int * newLoc;
+  int loc, n = 0;
+  CommentList l = comments;
+  DataList d;
+  newLoc = (int *) malloc((iCodeSize+1)*sizeof(int));
+  if (newLoc == NULL)
+  { fprintf(listing,"Out of memory error writing code\n");
+    return;
+  }
+  /* a deleted instruction's location now belongs
+     to the next instruction that is kept */
+  for (loc=0;loc<iCodeSize;loc++)
+  { newLoc[loc] = n;
+    if (! iCode[loc].deleted) n++;
+  }
+  newLoc[iCodeSize] = n;
+  for (loc=0;loc<=iCodeSize;loc++)
+  { TMInstr * i = &iCode[loc];
+    while ((l != NULL) && (l->loc <= loc))
+    { fprintf(code,"* %s\n",l->text);
+      l = l->next;
+    }
+    if ((loc == iCodeSize) || i->deleted || (i->op == NULL)) continue;
+    if (i->target >= 0)
+    { int a = (i->target > iCodeSize) ? n : newLoc[i->target];
+      i->d = a - (newLoc[loc] + 1);
+    }
+    if (i->isRM)
+      fprintf(code,"%3d:  %5s  %d,%d(%d) ",newLoc[loc],i->op,i->r,i->d,i->s);
+    else
+      fprintf(code,"%3d:  %5s  %d,%d,%d ",newLoc[loc],i->op,i->r,i->s,i->t);
+    if (TraceCode && (i->comment != NULL)) fprintf(code,"\t%s",i->comment);
+    fprintf(code,"\n");
+  }
+  while (l != NULL)
+  { fprintf(code,"* %s\n",l->text);
+    l = l->next;
+  }
+  /* the data section: the simulator stores these
+     in data memory as it loads the code */
+  if (TraceCode && (data != NULL)) fprintf(code,"* Data section:\n");
+  for (d=data;d != NULL;d = d->next)
+  { fprintf(code,"%3d:  %5s  %d ",d->addr,"DATA",d->val);
+    if (d->comment != NULL) fprintf(code,"\t%s",d->comment);
+    fprintf(code,"\n");
+  }
+  free(newLoc);
+} /* emitFlush */
@@ -29,6 +29,40 @@
 /* 2nd accumulator */
 #define  ac1 1
 
+/* registers FIRSTREG..LASTREG are not used by
+ * the basic code generation scheme and are
+ * handed out by the register allocator
+ */
+#define FIRSTREG 2
+#define LASTREG 4
+
+/* MAXCODE is the number of TM instructions that
+ * can be buffered before they are written out
+ */
+#define MAXCODE 4096
+
+/* TMInstr is a buffered TM instruction. RO
+ * instructions use r,s,t and RM instructions use
+ * r,d(s). A jump relative to pc keeps its absolute
+ * target, so the displacement can be recomputed
+ * once instructions have been removed
+ */
+typedef struct
+   { char * op;
+     int isRM;
+     int r, d, s, t;
+     int target; /* absolute jump target, or -1 */
+     char * comment;
+     int deleted;
+   } TMInstr;
+
+/* iCode holds the buffered instructions, indexed
+ * by location; iCodeSize is one past the highest
+ * location emitted
+ */
+extern TMInstr iCode[MAXCODE];
+extern int iCodeSize;
+
 /* code emitting utilities */
 
 /* Procedure emitComment prints a comment line 
@@ -83,4 +117,60 @@ void emitRestore(void);
  */
 void emitRM_Abs( char *op, int r, int a, char * c);
 
+/* Procedure emitFunction marks the current location
+ * as the start of the code of function name
+ */
+void emitFunction( char * name);
+
+/* Procedure addJumpTable records a table of n
+ * jumps to the absolute locations to[], to be
+ * emitted by emitJumpTables; the instruction
+ * skipped at loc is then made to load the address
+ * of the table into ac
+ */
+void addJumpTable( int loc, int * to, int n);
+
+/* Procedure emitData records that word addr of
+ * data memory starts out holding val instead of 0,
+ * which the code file gives in its data section
+ * after the code
+ */
+void emitData( int addr, int val, char * c);
+
+/* Procedure emitJumpTables emits the jump tables
+ * recorded so far. They go after all other code,
+ * where control never falls into them
+ */
+void emitJumpTables(void);
+
+/* Procedure listCodeSize prints the number of
+ * instructions the code of each function takes
+ */
+void listCodeSize(void);
+
+/* Function emitFinalLoc returns the location the
+ * buffered instruction at loc will have in the code
+ * file once the deleted instructions are dropped
+ */
+int emitFinalLoc( int loc);
+
+/* Function emitChecksum returns the checksum of
+ * the buffered code as the code file will give it,
+ * computed as the TM simulator does for the profile
+ */
+unsigned emitChecksum(void);
+
+/* Procedure emitReset throws the buffered code,
+ * comments and data away, so code can be generated
+ * afresh
+ */
+void emitReset(void);
+
+/* Procedure emitFlush writes the buffered code to
+ * the code file, dropping deleted instructions and
+ * recomputing the pc-relative jump displacements,
+ * and then the data section
+ */
+void emitFlush(void);
+
 #endif
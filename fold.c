@@ -0,0 +1,469 @@
+/****************************************************/
+/* File: fold.c                                     */
+/* Constant folding and propagation for the         */
+/* TINY compiler (works on the syntax tree between  */
+/* type checking and code generation)               */
+/****************************************************/
+
+#include <limits.h>
+#include "globals.h"
+#include "util.h"
+#include "symtab.h"
+#include "fold.h"
+
+/* MAXROUNDS bounds the number of times the whole
+   program is re-folded while something changes */
+#define MAXROUNDS 10
+
+/* the abstract value of a variable: either a
+   known constant or unknown */
+typedef struct
+   { int known;
+     int val;
+   } ConstVal;
+
+/* number of variables, i.e. entries in an
+   environment (indexed by memory location) */
+static int nvars = 0;
+
+/* number of tree rewrites done in this round */
+static int changes = 0;
+
+static ConstVal * newEnv(void)
+{ ConstVal * e = (ConstVal *) calloc(nvars+1,sizeof(ConstVal));
+  if (e==NULL)
+    fprintf(listing,"Out of memory error in constant folding\n");
+  return e;
+}
+
+static ConstVal * copyEnv(ConstVal * env)
+{ ConstVal * e = newEnv();
+  memcpy(e,env,nvars*sizeof(ConstVal));
+  return e;
+}
+
+/* meetEnv keeps in e1 only the facts that
+   hold in both e1 and e2 */
+static void meetEnv(ConstVal * e1, ConstVal * e2)
+{ int i;
+  for (i=0;i<nvars;i++)
+    if (!e2[i].known || (e1[i].val != e2[i].val))
+      e1[i].known = FALSE;
+}
+
+/* setKnown records that location loc holds val,
+   of which a char keeps only the low byte */
+static void setKnown(ConstVal * env, int loc, int val)
+{ env[loc].known = TRUE;
+  env[loc].val = st_isByte(loc) ? (val & 0xff) : val;
+}
+
+/* killAssigned forgets the value of every variable
+   that is assigned, read or counted by a for loop
+   somewhere in tree t or a procedure it calls */
+static void killAssigned(TreeNode * t, ConstVal * env)
+{ while (t != NULL)
+  { int i;
+    if ((t->nodekind==StmtK) &&
+        ((t->kind.stmt==AssignK) || (t->kind.stmt==ReadK) ||
+         (t->kind.stmt==ForK)))
+    { int loc = st_lookup(t->attr.name);
+      if (loc >= 0) env[loc].known = FALSE;
+    }
+    if ((t->nodekind==StmtK) && (t->kind.stmt==CallK))
+      killAssigned(st_proc(t->attr.name)->child[1],env);
+    for (i=0;i<MAXCHILDREN;i++)
+      killAssigned(t->child[i],env);
+    t = t->sibling;
+  }
+}
+
+/* Function evalOp applies operator op to two
+ * constants the way the TM machine would (not
+ * takes the first one only). It returns FALSE if
+ * the result cannot be known at compile time
+ * (division by zero traps)
+ */
+int evalOp(TokenType op, int a, int b, int * result)
+{ /* TM arithmetic wraps around on overflow */
+  unsigned ua = (unsigned) a, ub = (unsigned) b;
+  switch (op)
+  { case PLUS : *result = (int) (ua + ub); break;
+    case MINUS : *result = (int) (ua - ub); break;
+    case TIMES : *result = (int) (ua * ub); break;
+    case OVER :
+      if ((b == 0) || ((b == -1) && (a == INT_MIN)))
+        return FALSE;
+      *result = a / b;
+      break;
+    /* comparisons are done by SUB and a jump on the sign */
+    case LT : *result = ((int) (ua - ub) < 0); break;
+    case EQ : *result = (a == b); break;
+    /* Boolean values are 0 or 1 */
+    case AND : *result = a && b; break;
+    case OR : *result = a || b; break;
+    case NOT : *result = !a; break;
+    default : return FALSE;
+  }
+  return TRUE;
+}
+
+/* makeConst turns expression node t into a
+   constant node with value val (keeping its type) */
+static void makeConst(TreeNode * t, int val)
+{ int i;
+  t->kind.exp = ConstK;
+  t->attr.val = val;
+  for (i=0;i<MAXCHILDREN;i++) t->child[i] = NULL;
+  changes++;
+}
+
+static int isConst(TreeNode * t, int val)
+{ return (t != NULL) && (t->nodekind == ExpK) &&
+         (t->kind.exp == ConstK) && (t->attr.val == val);
+}
+
+/* Function mayTrap is TRUE if evaluating
+ * expression t might divide by zero or index
+ * outside an array, so t must not be dropped
+ * or moved
+ */
+int mayTrap(TreeNode * t)
+{ if ((t != NULL) && (t->kind.exp == IndexK))
+    return (t->check != 0) || mayTrap(t->child[0]);
+  if ((t == NULL) || (t->kind.exp != OpK)) return FALSE;
+  if ((t->attr.op == OVER) &&
+      ((t->child[1] == NULL) || (t->child[1]->kind.exp != ConstK) ||
+       (t->child[1]->attr.val == 0)))
+    return TRUE;
+  return mayTrap(t->child[0]) || mayTrap(t->child[1]);
+}
+
+static TreeNode * foldExp(TreeNode * t, ConstVal * env);
+
+/* Procedure foldIndex folds the index *index of
+ * the array access t and drops the bounds checks
+ * of t if the index is a constant in range
+ */
+static void foldIndex(TreeNode * t, TreeNode ** index, ConstVal * env)
+{ TreeNode * p = *index = foldExp(*index,env);
+  if ((p != NULL) && (p->kind.exp == ConstK) && (t->check != 0) &&
+      (p->attr.val >= 0) && (p->attr.val < st_size(t->attr.name)))
+  { t->check = 0;
+    changes++;
+  }
+}
+
+/* Function foldExp folds expression t under the
+ * variable values in env and returns the folded
+ * tree (which may be one of t's children)
+ */
+static TreeNode * foldExp(TreeNode * t, ConstVal * env)
+{ TreeNode * p1, * p2;
+  int loc, val;
+  if (t == NULL) return NULL;
+  switch (t->kind.exp)
+  { case IdK :
+      loc = st_lookup(t->attr.name);
+      if ((loc >= 0) && env[loc].known)
+        makeConst(t,env[loc].val);
+      break;
+    case IndexK :
+      foldIndex(t,&t->child[0],env);
+      break;
+    case OpK :
+      p1 = t->child[0] = foldExp(t->child[0],env);
+      p2 = t->child[1] = foldExp(t->child[1],env);
+      if ((t->attr.op == NOT) && (p1 != NULL))
+      { if (p1->kind.exp == ConstK) makeConst(t,!p1->attr.val);
+        else if ((p1->kind.exp == OpK) && (p1->attr.op == NOT))
+        { changes++;
+          return p1->child[0];
+        }
+        break;
+      }
+      if ((p1 == NULL) || (p2 == NULL)) break;
+      if ((p1->kind.exp == ConstK) && (p2->kind.exp == ConstK))
+      { if (evalOp(t->attr.op,p1->attr.val,p2->attr.val,&val))
+          makeConst(t,val);
+        break;
+      }
+      /* algebraic identities; expressions have no
+         side effects, so operands may be dropped */
+      switch (t->attr.op)
+      { case PLUS :
+          if (isConst(p1,0)) { changes++; return p2; }
+          if (isConst(p2,0)) { changes++; return p1; }
+          break;
+        case MINUS :
+          if (isConst(p2,0)) { changes++; return p1; }
+          if ((p1->kind.exp == IdK) && (p2->kind.exp == IdK) &&
+              (strcmp(p1->attr.name,p2->attr.name) == 0))
+            makeConst(t,0);
+          break;
+        case TIMES :
+          if (isConst(p1,1)) { changes++; return p2; }
+          if (isConst(p2,1)) { changes++; return p1; }
+          if ((isConst(p1,0) && !mayTrap(p2)) ||
+              (isConst(p2,0) && !mayTrap(p1)))
+            makeConst(t,0);
+          break;
+        case OVER :
+          if (isConst(p2,1)) { changes++; return p1; }
+          break;
+        case EQ :
+          if ((p1->kind.exp == IdK) && (p2->kind.exp == IdK) &&
+              (strcmp(p1->attr.name,p2->attr.name) == 0))
+            makeConst(t,1);
+          break;
+        /* the second operand of and and or is only
+           evaluated if the first does not decide */
+        case AND :
+          if (isConst(p1,1)) { changes++; return p2; }
+          if (isConst(p2,1)) { changes++; return p1; }
+          if (isConst(p1,0) || (isConst(p2,0) && !mayTrap(p1)))
+            makeConst(t,0);
+          break;
+        case OR :
+          if (isConst(p1,0)) { changes++; return p2; }
+          if (isConst(p2,0)) { changes++; return p1; }
+          if (isConst(p1,1) || (isConst(p2,1) && !mayTrap(p1)))
+            makeConst(t,1);
+          break;
+        default :
+          break;
+      }
+      break;
+    default :
+      break;
+  }
+  return t;
+}
+
+/* Procedure foldStmts folds the statement sequence
+ * starting at *list. env holds the variable values
+ * on entry and is updated to those on exit. Dead
+ * if and case arms and repeat loops that run
+ * exactly once are replaced by their bodies in the
+ * sequence, and while and for loops that never run
+ * are dropped
+ */
+static void foldStmts(TreeNode ** list, ConstVal * env)
+{ TreeNode ** pp = list;
+  while (*pp != NULL)
+  { TreeNode * t = *pp;
+    ConstVal * e1, * e2;
+    TreeNode * body;
+    int loc;
+    if (t->nodekind != StmtK)
+    { pp = &t->sibling;
+      continue;
+    }
+    switch (t->kind.stmt)
+    { case AssignK :
+        if (t->child[1] != NULL)
+        { /* element store: the index is evaluated
+             first, and array elements are not tracked */
+          foldIndex(t,&t->child[1],env);
+          t->child[0] = foldExp(t->child[0],env);
+          break;
+        }
+        t->child[0] = foldExp(t->child[0],env);
+        loc = st_lookup(t->attr.name);
+        if (loc < 0) break;
+        if (t->child[0]->kind.exp == ConstK)
+          setKnown(env,loc,t->child[0]->attr.val);
+        else env[loc].known = FALSE;
+        break;
+      case ReadK :
+        if (t->child[0] != NULL)
+        { foldIndex(t,&t->child[0],env);
+          break;
+        }
+        loc = st_lookup(t->attr.name);
+        if (loc >= 0) env[loc].known = FALSE;
+        break;
+      case WriteK :
+        t->child[0] = foldExp(t->child[0],env);
+        break;
+      case IfK :
+        t->child[0] = foldExp(t->child[0],env);
+        if (t->child[0]->kind.exp == ConstK)
+        { /* only one arm can ever run: splice it in
+             place of the if and fold it from here */
+          body = t->child[0]->attr.val ? t->child[1] : t->child[2];
+          if (body == NULL) *pp = t->sibling;
+          else
+          { *pp = body;
+            while (body->sibling != NULL) body = body->sibling;
+            body->sibling = t->sibling;
+          }
+          changes++;
+          continue;
+        }
+        if ((t->child[1] == NULL) && (t->child[2] == NULL) &&
+            !mayTrap(t->child[0]))
+        { /* the test has no side effects */
+          *pp = t->sibling;
+          changes++;
+          continue;
+        }
+        e1 = copyEnv(env);
+        e2 = copyEnv(env);
+        foldStmts(&t->child[1],e1);
+        foldStmts(&t->child[2],e2);
+        meetEnv(e1,e2);
+        memcpy(env,e1,nvars*sizeof(ConstVal));
+        free(e1);
+        free(e2);
+        break;
+      case CaseK :
+        t->child[0] = foldExp(t->child[0],env);
+        if (t->child[0]->kind.exp == ConstK)
+        { /* only one arm can ever run */
+          body = caseArm(t,t->child[0]->attr.val);
+          if (body == NULL) *pp = t->sibling;
+          else
+          { *pp = body;
+            while (body->sibling != NULL) body = body->sibling;
+            body->sibling = t->sibling;
+          }
+          changes++;
+          continue;
+        }
+        e1 = copyEnv(env);
+        foldStmts(&t->child[2],e1);
+        for (body=t->child[1];body != NULL;body = body->sibling)
+        { e2 = copyEnv(env);
+          /* a variable selected on by a single label
+             has that value in its arm */
+          loc = (t->child[0]->kind.exp == IdK) ?
+                st_lookup(t->child[0]->attr.name) : -1;
+          if ((loc >= 0) && (body->child[0]->sibling == NULL))
+            setKnown(e2,loc,body->child[0]->attr.val);
+          foldStmts(&body->child[1],e2);
+          meetEnv(e1,e2);
+          free(e2);
+        }
+        memcpy(env,e1,nvars*sizeof(ConstVal));
+        free(e1);
+        break;
+      case RepeatK :
+        /* anything assigned in the loop is unknown
+           at the top of the second iteration */
+        e1 = copyEnv(env);
+        killAssigned(t->child[0],env);
+        foldStmts(&t->child[0],env);
+        t->child[1] = foldExp(t->child[1],env);
+        if ((t->child[1]->kind.exp == ConstK) && t->child[1]->attr.val)
+        { /* the test always succeeds, so the body runs
+             exactly once: splice it in place of the loop
+             and fold it again with the entry values */
+          body = t->child[0];
+          if (body == NULL) *pp = t->sibling;
+          else
+          { *pp = body;
+            while (body->sibling != NULL) body = body->sibling;
+            body->sibling = t->sibling;
+          }
+          memcpy(env,e1,nvars*sizeof(ConstVal));
+          free(e1);
+          changes++;
+          continue;
+        }
+        free(e1);
+        break;
+      case WhileK :
+        /* the test is also done at the top of every
+           later iteration */
+        killAssigned(t->child[1],env);
+        t->child[0] = foldExp(t->child[0],env);
+        if ((t->child[0]->kind.exp == ConstK) && !t->child[0]->attr.val)
+        { /* the body never runs */
+          *pp = t->sibling;
+          changes++;
+          continue;
+        }
+        e1 = copyEnv(env);
+        foldStmts(&t->child[1],e1);
+        free(e1);
+        break;
+      case ForK :
+        t->child[0] = foldExp(t->child[0],env);
+        t->child[1] = foldExp(t->child[1],env);
+        loc = st_lookup(t->attr.name);
+        if ((t->child[0]->kind.exp == ConstK) &&
+            (t->child[1]->kind.exp == ConstK))
+        { int first = t->child[0]->attr.val, last = t->child[1]->attr.val;
+          int count;
+          evalOp(MINUS,last,first,&count);
+          if (count < 0)
+          { /* the body never runs: all that is left is
+               setting the variable to its first value */
+            t->kind.stmt = AssignK;
+            t->child[1] = t->child[2] = NULL;
+            if (loc >= 0) setKnown(env,loc,first);
+            changes++;
+            pp = &t->sibling;
+            continue;
+          }
+          killAssigned(t->child[2],env);
+          e1 = copyEnv(env);
+          if (loc >= 0) e1[loc].known = FALSE;
+          foldStmts(&t->child[2],e1);
+          free(e1);
+          /* the loop leaves the variable one past its
+             last value */
+          if (loc >= 0)
+          { evalOp(PLUS,last,1,&count);
+            setKnown(env,loc,count);
+          }
+          break;
+        }
+        killAssigned(t->child[2],env);
+        if (loc >= 0) env[loc].known = FALSE;
+        e1 = copyEnv(env);
+        foldStmts(&t->child[2],e1);
+        free(e1);
+        break;
+      case CallK :
+        killAssigned(st_proc(t->attr.name)->child[1],env);
+        break;
+      default :
+        break;
+    }
+    pp = &t->sibling;
+  }
+}
+
+/* Function constFold performs constant folding,
+ * constant propagation and unreachable branch
+ * elimination on the statements of syntaxTree.
+ * It returns the number of rewrites
+ */
+int constFold(TreeNode * syntaxTree)
+{ int rounds = 0, total = 0;
+  ConstVal * env;
+  if ((syntaxTree == NULL) || (syntaxTree->nodekind != ProgK)) return 0;
+  nvars = st_maxloc();
+  do
+  { /* every variable starts out with its initial
+       value, 0 unless declared otherwise */
+    int i;
+    env = newEnv();
+    if (env == NULL) return total;
+    for (i=0;i<nvars;i++)
+    { env[i].known = TRUE;
+      env[i].val = st_init(i);
+    }
+    changes = 0;
+    foldStmts(&syntaxTree->child[1],env);
+    free(env);
+    total += changes;
+    rounds++;
+  } while ((changes > 0) && (rounds < MAXROUNDS));
+  if (TraceOptimize)
+    fprintf(listing,"Constant folding: %d rewrites in %d rounds\n",
+            total,rounds);
+  return total;
+}
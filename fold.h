@@ -0,0 +1,30 @@
+/****************************************************/
+/* File: fold.h                                     */
+/* Constant folding interface for the TINY compiler */
+/****************************************************/
+
+#ifndef _FOLD_H_
+#define _FOLD_H_
+
+/* Function evalOp applies operator op to two
+ * constants the way the TM machine would. It
+ * returns FALSE if the result cannot be known
+ * at compile time (division by zero traps)
+ */
+int evalOp(TokenType op, int a, int b, int * result);
+
+/* Function mayTrap is TRUE if evaluating
+ * expression t might divide by zero or index
+ * outside an array, so t must not be dropped
+ * or moved
+ */
+int mayTrap(TreeNode * t);
+
+/* Function constFold performs constant folding,
+ * constant propagation and unreachable branch
+ * elimination on the statements of syntaxTree.
+ * It returns the number of rewrites
+ */
+int constFold(TreeNode * syntaxTree);
+
+#endif
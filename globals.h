@@ -23,19 +23,20 @@
 #endif
 
 /* MAXRESERVED = the number of reserved words */
-#define MAXRESERVED 10 
+#define MAXRESERVED 20 
 
 typedef enum 
     /* book-keeping tokens */
    {ENDFILE,ERROR,
     /* reserved words */
-    IF,THEN,ELSE,END,REPEAT,UNTIL,READ,WRITE,
+    IF,THEN,ELSE,END,REPEAT,UNTIL,READ,WRITE,WHILE,DO,FOR,TO,PROCEDURE,
+    AND,OR,NOT,CASE,OF,
     /* multicharacter tokens */
     ID,NUM,
     /* special symbols */
-    ASSIGN,EQ,LT,PLUS,MINUS,TIMES,OVER,LPAREN,RPAREN,SEMI,
+    ASSIGN,EQ,LT,PLUS,MINUS,TIMES,OVER,LPAREN,RPAREN,SEMI,COMMA,COLON,BAR,
 	/*tiny+ new symbols */
-	INT,CHAR
+	INT,CHAR,LBRACKET,RBRACKET
    } TokenType;
 
 extern FILE* source; /* source code text file */
@@ -49,15 +50,43 @@ extern int lineno; /* source line number for listing */
 /**************************************************/
 
 typedef enum {ProgK,DeclK,StmtK,ExpK} NodeKind;
-typedef enum {IntK,CharK} DeclKind;
-typedef enum {IfK,RepeatK,AssignK,ReadK,WriteK} StmtKind;
-typedef enum {OpK,ConstK,IdK} ExpKind;
+/* an int or char declaration (IntK, CharK) keeps the
+ * size of an array in child[0] and its initial values
+ * (constants) in child[1];
+ * a procedure declaration (ProcK) keeps its parameter
+ * declarations in child[0] and its body in child[1];
+ * a call (CallK) names the procedure, and until the
+ * type checker turns them into assignments to the
+ * parameters, keeps the arguments in child[0];
+ * the operator not has its operand in child[0]
+ * alone; a case statement (CaseK) keeps its
+ * selector in child[0], its arms in child[1] and
+ * its else part in child[2], and each arm (ArmK)
+ * its labels (constants) in child[0] and its
+ * statements in child[1]
+ */
+typedef enum {IntK,CharK,ProcK} DeclKind;
+typedef enum {IfK,RepeatK,WhileK,ForK,AssignK,ReadK,WriteK,CallK,CaseK,ArmK}
+        StmtKind;
+typedef enum {OpK,ConstK,IdK,IndexK} ExpKind;
 
 /* ExpType is used for type checking */
 typedef enum {Integer,Char,Void,Boolean} ExpType;
 
 #define MAXCHILDREN 3
 
+/* bits of TreeNode.check: the bounds checks an
+ * array index still needs (index >= 0 and
+ * index < size of the array)
+ */
+#define CHECKLOW 1
+#define CHECKHIGH 2
+
+/* chars are packed BYTESPERWORD to a word of the
+ * TM data memory
+ */
+#define BYTESPERWORD 4
+
 typedef struct treeNode
    { struct treeNode * child[MAXCHILDREN];
      struct treeNode * sibling;
@@ -68,6 +97,7 @@ typedef struct treeNode
              int val;
              char * name; } attr;
      ExpType type; /* for type checking of exps */
+     int check; /* CHECKLOW|CHECKHIGH for array indexing */
    } TreeNode;
 
 /**************************************************/
@@ -102,6 +132,49 @@ extern int TraceAnalyze;
  */
 extern int TraceCode;
 
+/* TraceOptimize = TRUE causes the optimizer to
+ * report what it changed and to print the
+ * optimized syntax tree to the listing file
+ */
+extern int TraceOptimize;
+
+/* TraceIR = TRUE causes the intermediate code to
+ * be printed to the listing file after each pass
+ */
+extern int TraceIR;
+
+/* OptLevel is the optimization level (0 to 2) and
+ * OptSize = TRUE leaves out the passes that make
+ * the code bigger (-O0, -O1, -O2 and -Os)
+ */
+extern int OptLevel;
+extern int OptSize;
+
+/* PassStats = TRUE causes the time each pass took
+ * and the changes it made to be listed
+ * (-fpass-stats)
+ */
+extern int PassStats;
+
+/* EvalFuel is the number of statements and
+ * expressions the partial evaluator may run
+ * before it gives up (-feval-fuel=n)
+ */
+extern int EvalFuel;
+
+/* ProfileUse = TRUE lays out the code by the
+ * instruction execution counts the TM simulator
+ * wrote to the profile file (-fprofile-use)
+ */
+extern int ProfileUse;
+
+/* UnrollFactor is the number of copies of its body
+ * a repeat or for loop gets when it runs too often
+ * to be unrolled completely (1 leaves such loops
+ * alone; -funroll-factor=n)
+ */
+extern int UnrollFactor;
+
 /* Error = TRUE prevents further passes if an error occurs */
 extern int Error; 
 #endif
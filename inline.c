@@ -0,0 +1,161 @@
+/****************************************************/
+/* File: inline.c                                   */
+/* Procedure inliner for the TINY compiler: copies  */
+/* the bodies of small or singly called procedures  */
+/* into their callers                               */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "symtab.h"
+#include "loop.h"
+#include "inline.h"
+
+/* bodies of at most INLINESIZE estimated TM
+   instructions are inlined at every call unless
+   optimizing for size */
+#define INLINESIZE 16
+
+/* the instructions a procedure takes besides its
+   body and the ones a call takes */
+#define PROCCOST 6
+#define CALLCOST 2
+
+/* the procedures of the program and the number
+   of calls of each */
+static TreeNode ** procs = NULL;
+static int * ncalls = NULL;
+static int nprocs = 0;
+
+/* number of calls inlined */
+static int inlined = 0;
+
+/* Function callsOf returns where the number of
+ * calls of procedure d is counted
+ */
+static int * callsOf( TreeNode * d)
+{ int k;
+  for (k=0;procs[k] != d;k++) ;
+  return &ncalls[k];
+}
+
+/* Procedure countCalls adds the calls in t and its
+ * siblings to the count of each procedure, the
+ * calls in procedures not counted before included
+ */
+static void countCalls( TreeNode * t)
+{ int i;
+  TreeNode * d;
+  for (;t != NULL;t = t->sibling)
+  { if ((t->nodekind == StmtK) && (t->kind.stmt == CallK))
+    { d = st_proc(t->attr.name);
+      if ((*callsOf(d))++ == 0) countCalls(d->child[1]);
+    }
+    for (i=0;i<MAXCHILDREN;i++)
+      if ((t->child[i] != NULL) && (t->child[i]->nodekind == StmtK))
+        countCalls(t->child[i]);
+  }
+}
+
+/* Function worthInlining is TRUE if the calls of
+ * procedure d should be replaced by its body
+ */
+static int worthInlining( TreeNode * d)
+{ int size = codeSize(d->child[1]), calls = *callsOf(d);
+  if (calls == 1) return TRUE;
+  /* copies must not take more than the calls and
+     the procedure they replace */
+  if (OptSize)
+    return size * calls <= CALLCOST * calls + size + PROCCOST;
+  return size <= INLINESIZE;
+}
+
+/* Procedure inlineStmts replaces the calls worth
+ * inlining in sequence *pp by the bodies of the
+ * procedures, inlining within those as well
+ */
+static void inlineStmts( TreeNode ** pp)
+{ TreeNode * t, * d, * body;
+  int i;
+  while ((t = *pp) != NULL)
+  { if ((t->nodekind == StmtK) && (t->kind.stmt == CallK))
+    { d = st_proc(t->attr.name);
+      if (worthInlining(d) && ((body = copyTree(d->child[1])) != NULL))
+      { TreeNode * last = body;
+        if (TraceOptimize)
+          fprintf(listing,"Inlining call of %s at line %d\n",
+                  t->attr.name,t->lineno);
+        while (last->sibling != NULL) last = last->sibling;
+        last->sibling = t->sibling;
+        *pp = body;
+        inlined++;
+        /* look at the copied statements next */
+        continue;
+      }
+    }
+    for (i=0;i<MAXCHILDREN;i++)
+      if ((t->child[i] != NULL) && (t->child[i]->nodekind == StmtK))
+        inlineStmts(&t->child[i]);
+    pp = &t->sibling;
+  }
+}
+
+/* Procedure recount counts the calls of each
+ * procedure left in the program
+ */
+static void recount( TreeNode * syntaxTree)
+{ int k;
+  for (k=0;k<nprocs;k++) ncalls[k] = 0;
+  countCalls(syntaxTree->child[1]);
+}
+
+/* Function inlineCalls replaces calls of
+ * procedures called once, or whose bodies are
+ * hardly bigger than the call, by copies of the
+ * bodies, and drops the procedures no longer
+ * called. It returns the number of calls inlined
+ */
+int inlineCalls( TreeNode * syntaxTree)
+{ TreeNode ** pp, * d;
+  int before, dropped = 0;
+  if ((syntaxTree == NULL) || (syntaxTree->nodekind != ProgK)) return 0;
+  nprocs = 0;
+  for (d=syntaxTree->child[0];d != NULL;d = d->sibling)
+    if (d->kind.decl == ProcK) nprocs++;
+  if (nprocs == 0) return 0;
+  procs = (TreeNode **) malloc(nprocs * sizeof(TreeNode *));
+  ncalls = (int *) malloc(nprocs * sizeof(int));
+  if ((procs == NULL) || (ncalls == NULL))
+  { fprintf(listing,"Out of memory error\n");
+    free(procs);
+    free(ncalls);
+    return 0;
+  }
+  nprocs = 0;
+  for (d=syntaxTree->child[0];d != NULL;d = d->sibling)
+    if (d->kind.decl == ProcK) procs[nprocs++] = d;
+  inlined = 0;
+  do
+  { before = inlined;
+    recount(syntaxTree);
+    inlineStmts(&syntaxTree->child[1]);
+    recount(syntaxTree);
+    for (d=syntaxTree->child[0];d != NULL;d = d->sibling)
+      if ((d->kind.decl == ProcK) && (*callsOf(d) > 0))
+        inlineStmts(&d->child[1]);
+  } while (inlined > before);
+  recount(syntaxTree);
+  pp = &syntaxTree->child[0];
+  while ((d = *pp) != NULL)
+    if ((d->kind.decl == ProcK) && (*callsOf(d) == 0))
+    { *pp = d->sibling;
+      dropped++;
+    }
+    else pp = &d->sibling;
+  free(procs);
+  free(ncalls);
+  if (TraceOptimize)
+    fprintf(listing,"Procedure inlining: %d calls inlined, %d procedures dropped\n",
+            inlined,dropped);
+  return inlined;
+}
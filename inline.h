@@ -0,0 +1,18 @@
+/****************************************************/
+/* File: inline.h                                   */
+/* Procedure inliner interface for the TINY         */
+/* compiler                                         */
+/****************************************************/
+
+#ifndef _INLINE_H_
+#define _INLINE_H_
+
+/* Function inlineCalls replaces calls of
+ * procedures called once, or whose bodies are
+ * hardly bigger than the call, by copies of the
+ * bodies, and drops the procedures no longer
+ * called. It returns the number of calls inlined
+ */
+int inlineCalls(TreeNode * syntaxTree);
+
+#endif
@@ -0,0 +1,633 @@
+/****************************************************/
+/* File: ir.c                                       */
+/* Intermediate representation for the TINY         */
+/* compiler: construction utilities, analyses,      */
+/* verifier and dumper                              */
+/****************************************************/
+
+#include "globals.h"
+#include "ir.h"
+
+/* maximum number of problems irVerify reports */
+#define MAXERRORS 10
+
+static void * grow( void * p, int * max, int size)
+{ *max = (*max == 0) ? 8 : 2 * (*max);
+  p = realloc(p,(*max) * size);
+  if (p == NULL)
+  { fprintf(listing,"Out of memory error in intermediate code\n");
+    exit(1);
+  }
+  return p;
+}
+
+/* Function irNewFunc returns an empty function */
+IrFunc * irNewFunc(void)
+{ IrFunc * f = (IrFunc *) calloc(1,sizeof(IrFunc));
+  if (f == NULL)
+  { fprintf(listing,"Out of memory error in intermediate code\n");
+    exit(1);
+  }
+  f->ssa = TRUE;
+  return f;
+}
+
+/* Function irNewBlock adds a block at loop
+ * nesting depth depth to f
+ */
+IrBlock * irNewBlock( IrFunc * f, int depth)
+{ IrBlock * b = (IrBlock *) calloc(1,sizeof(IrBlock));
+  if (b == NULL)
+  { fprintf(listing,"Out of memory error in intermediate code\n");
+    exit(1);
+  }
+  if (f->nblocks == f->maxblocks)
+    f->blocks = (IrBlock **) grow(f->blocks,&f->maxblocks,sizeof(IrBlock *));
+  b->succ = (IrBlock **) grow(NULL,&b->maxsuccs,sizeof(IrBlock *));
+  b->succ[0] = b->succ[1] = NULL;
+  b->id = f->nextid++;
+  b->depth = depth;
+  b->term = IrHalt;
+  b->cond = -1;
+  b->likely = 1;
+  b->order = f->nblocks;
+  f->blocks[f->nblocks++] = b;
+  return b;
+}
+
+/* Function irNewValue returns a fresh value for
+ * source variable name (which may be NULL)
+ */
+int irNewValue( IrFunc * f, char * name)
+{ if (f->nvalues == f->maxvalues)
+  { int max = f->maxvalues;
+    f->def = (IrInstr **) grow(f->def,&max,sizeof(IrInstr *));
+    f->name = (char **) grow(f->name,&f->maxvalues,sizeof(char *));
+  }
+  f->def[f->nvalues] = NULL;
+  f->name[f->nvalues] = name;
+  return f->nvalues++;
+}
+
+/* Function irNewInstr returns an unlinked
+ * instruction with room for nargs arguments that
+ * defines value dst (-1 for none)
+ */
+IrInstr * irNewInstr( IrFunc * f, IrOp op, int dst, int nargs, int lineno)
+{ IrInstr * i = (IrInstr *) calloc(1,sizeof(IrInstr));
+  if ((i == NULL) ||
+      ((nargs > 0) && ((i->args = (int *) calloc(nargs,sizeof(int))) == NULL)))
+  { fprintf(listing,"Out of memory error in intermediate code\n");
+    exit(1);
+  }
+  i->op = op;
+  i->dst = dst;
+  i->nargs = nargs;
+  i->lineno = lineno;
+  if (dst >= 0) f->def[dst] = i;
+  return i;
+}
+
+/* Procedures irAppend, irPrepend and irInsertBefore
+ * link instruction i into a block; irRemove unlinks it
+ */
+void irAppend( IrBlock * b, IrInstr * i)
+{ i->block = b;
+  i->next = NULL;
+  i->prev = b->last;
+  if (b->last == NULL) b->first = i;
+  else b->last->next = i;
+  b->last = i;
+}
+
+void irPrepend( IrBlock * b, IrInstr * i)
+{ i->block = b;
+  i->prev = NULL;
+  i->next = b->first;
+  if (b->first == NULL) b->last = i;
+  else b->first->prev = i;
+  b->first = i;
+}
+
+void irInsertBefore( IrInstr * at, IrInstr * i)
+{ IrBlock * b = at->block;
+  i->block = b;
+  i->next = at;
+  i->prev = at->prev;
+  if (at->prev == NULL) b->first = i;
+  else at->prev->next = i;
+  at->prev = i;
+}
+
+void irRemove( IrFunc * f, IrInstr * i)
+{ IrBlock * b = i->block;
+  if (i->prev == NULL) b->first = i->next;
+  else i->prev->next = i->next;
+  if (i->next == NULL) b->last = i->prev;
+  else i->next->prev = i->prev;
+  i->block = NULL;
+  i->prev = i->next = NULL;
+  if ((i->dst >= 0) && (f->def[i->dst] == i)) f->def[i->dst] = NULL;
+}
+
+static void addPred( IrBlock * b, IrBlock * p)
+{ if (b->npreds == b->maxpreds)
+    b->preds = (IrBlock **) grow(b->preds,&b->maxpreds,sizeof(IrBlock *));
+  b->preds[b->npreds++] = p;
+}
+
+static int predIndex( IrBlock * b, IrBlock * p)
+{ int k;
+  for (k=0;k<b->npreds;k++)
+    if (b->preds[k] == p) return k;
+  return -1;
+}
+
+static void addSucc( IrBlock * b, IrBlock * to)
+{ if (b->nsuccs == b->maxsuccs)
+    b->succ = (IrBlock **) grow(b->succ,&b->maxsuccs,sizeof(IrBlock *));
+  b->succ[b->nsuccs++] = to;
+  addPred(to,b);
+}
+
+/* Procedures irSetJump, irSetBranch, irSetSwitch
+ * and irSetHalt set how block b ends, adding b to
+ * the predecessors of its new successors. The
+ * switch goes to to[cond-low] for cond in low to
+ * low+n-1 and to deflt otherwise
+ */
+void irSetJump( IrBlock * b, IrBlock * to)
+{ b->term = IrJump;
+  b->cond = -1;
+  b->nsuccs = 0;
+  addSucc(b,to);
+  b->succ[1] = NULL;
+}
+
+void irSetBranch( IrBlock * b, int cond, IrBlock * ifTrue, IrBlock * ifFalse)
+{ b->term = IrBranch;
+  b->cond = cond;
+  b->nsuccs = 0;
+  addSucc(b,ifTrue);
+  addSucc(b,ifFalse);
+}
+
+void irSetSwitch( IrBlock * b, int cond, IrBlock * deflt, int low, int n,
+                  IrBlock ** to)
+{ int k, s;
+  b->term = IrSwitch;
+  b->cond = cond;
+  b->low = low;
+  b->ntable = n;
+  b->table = (int *) realloc(b->table,(n > 0 ? n : 1) * sizeof(int));
+  if (b->table == NULL)
+  { fprintf(listing,"Out of memory error in intermediate code\n");
+    exit(1);
+  }
+  b->nsuccs = 0;
+  addSucc(b,deflt);
+  /* a block reached by several entries is one
+     successor */
+  for (k=0;k<n;k++)
+  { for (s=0;(s < b->nsuccs) && (b->succ[s] != to[k]);s++)
+      ;
+    if (s == b->nsuccs) addSucc(b,to[k]);
+    b->table[k] = s;
+  }
+}
+
+void irSetHalt( IrBlock * b)
+{ b->term = IrHalt;
+  b->cond = -1;
+  b->nsuccs = 0;
+  b->succ[0] = b->succ[1] = NULL;
+}
+
+/* Procedure irReplacePred makes block to (on the
+ * edge from old) come from new instead, keeping the
+ * order of the phi arguments; irRemovePred drops
+ * the edge from p and the phi arguments for it
+ */
+void irReplacePred( IrBlock * b, IrBlock * old, IrBlock * new)
+{ int k = predIndex(b,old);
+  if (k >= 0) b->preds[k] = new;
+}
+
+void irRemovePred( IrBlock * b, IrBlock * p)
+{ int k = predIndex(b,p), j;
+  IrInstr * i;
+  if (k < 0) return;
+  for (j=k;j<b->npreds-1;j++) b->preds[j] = b->preds[j+1];
+  b->npreds--;
+  forInstr(i,b)
+    if (i->op == IrPhi)
+    { for (j=k;j<i->nargs-1;j++) i->args[j] = i->args[j+1];
+      i->nargs--;
+    }
+}
+
+/* Procedure irRetarget makes block b go to block
+ * to wherever it went to block old. The phis of to
+ * get the arguments they had on the edge from old
+ */
+void irRetarget( IrBlock * b, IrBlock * old, IrBlock * to)
+{ int s, k = predIndex(to,old);
+  IrInstr * i;
+  for (s=0;s<b->nsuccs;s++)
+    if (b->succ[s] == old)
+    { b->succ[s] = to;
+      irRemovePred(old,b);
+      addPred(to,b);
+      forInstr(i,to)
+        if (i->op == IrPhi)
+        { int * args = (int *) malloc(to->npreds * sizeof(int));
+          if (args == NULL)
+          { fprintf(listing,"Out of memory error in intermediate code\n");
+            exit(1);
+          }
+          memcpy(args,i->args,i->nargs * sizeof(int));
+          args[i->nargs] = (k >= 0) ? i->args[k] : -1;
+          free(i->args);
+          i->args = args;
+          i->nargs++;
+        }
+    }
+}
+
+/* Function irSplitEdge puts a new block on the
+ * edge from block p to block b and returns it
+ */
+IrBlock * irSplitEdge( IrFunc * f, IrBlock * p, IrBlock * b)
+{ IrBlock * n = irNewBlock(f,(p->depth < b->depth) ? p->depth : b->depth);
+  int s;
+  for (s=0;s<p->nsuccs;s++)
+    if (p->succ[s] == b)
+    { p->succ[s] = n;
+      break;
+    }
+  irReplacePred(b,p,n);
+  addPred(n,p);
+  n->term = IrJump;
+  n->nsuccs = 1;
+  n->succ[0] = b;
+  n->sealed = TRUE;
+  return n;
+}
+
+/* Procedure irReplaceValue makes every use of
+ * value old a use of value new
+ */
+void irReplaceValue( IrFunc * f, int old, int new)
+{ int k, j;
+  IrInstr * i;
+  for (k=0;k<f->nblocks;k++)
+  { IrBlock * b = f->blocks[k];
+    forInstr(i,b)
+      for (j=0;j<i->nargs;j++)
+        if (i->args[j] == old) i->args[j] = new;
+    if (b->cond == old) b->cond = new;
+  }
+}
+
+/* Function irUses returns the number of uses of
+ * value v (the branch conditions included)
+ */
+int irUses( IrFunc * f, int v)
+{ int k, j, n = 0;
+  IrInstr * i;
+  for (k=0;k<f->nblocks;k++)
+  { IrBlock * b = f->blocks[k];
+    forInstr(i,b)
+      for (j=0;j<i->nargs;j++)
+        if (i->args[j] == v) n++;
+    if (((b->term == IrBranch) || (b->term == IrSwitch)) && (b->cond == v))
+      n++;
+  }
+  return n;
+}
+
+/* Function irIsConst is TRUE if value v is a known
+ * constant, which is then stored in *c
+ */
+int irIsConst( IrFunc * f, int v, int * c)
+{ if ((v < 0) || (v >= f->nvalues) || (f->def[v] == NULL) ||
+      (f->def[v]->op != IrConst))
+    return FALSE;
+  *c = f->def[v]->val;
+  return TRUE;
+}
+
+/* Function irHasEffect is TRUE if instruction i
+ * must be kept even if its value is never used
+ */
+int irHasEffect( IrFunc * f, IrInstr * i)
+{ int c;
+  switch (i->op)
+  { case IrIn :
+    case IrOut :
+    case IrStore :
+    case IrCheckLow :
+    case IrCheckHigh :
+    case IrCall :
+      return TRUE;
+    case IrDiv :
+      /* division by zero stops the machine */
+      return !irIsConst(f,i->args[1],&c) || (c == 0);
+    default :
+      return FALSE;
+  }
+}
+
+/* depth-first search for irComputeOrder */
+static void postorder( IrBlock * b, IrBlock ** post, int * n, int * seen)
+{ int s;
+  seen[b->order] = TRUE;
+  /* the likely side of a branch is searched first,
+     so the other side ends up right after the block
+     and the likely one next to where the two meet;
+     by default the then part of an if follows its
+     test as it does in the source. The arms of a
+     switch follow it in order, its default last */
+  for (s=0;s<b->nsuccs;s++)
+  { IrBlock * c;
+    if (b->term == IrBranch) c = b->succ[(s == 0) ? b->likely : 1 - b->likely];
+    else c = b->succ[(s == 0) ? 0 : b->nsuccs - s];
+    if ((c != NULL) && !seen[c->order])
+      postorder(c,post,n,seen);
+  }
+  post[(*n)++] = b;
+}
+
+/* Procedure irComputeOrder numbers the reachable
+ * blocks in reverse postorder and deletes the rest;
+ * afterwards blocks[] is sorted in that order
+ */
+void irComputeOrder( IrFunc * f)
+{ IrBlock ** post;
+  int * seen;
+  int k, n = 0;
+  if (f->nblocks == 0) return;
+  post = (IrBlock **) malloc(f->nblocks * sizeof(IrBlock *));
+  seen = (int *) calloc(f->nblocks,sizeof(int));
+  if ((post == NULL) || (seen == NULL))
+  { fprintf(listing,"Out of memory error in intermediate code\n");
+    exit(1);
+  }
+  for (k=0;k<f->nblocks;k++) f->blocks[k]->order = k;
+  postorder(f->blocks[0],post,&n,seen);
+  /* edges out of unreachable blocks go away */
+  for (k=0;k<f->nblocks;k++)
+    if (! seen[k])
+    { IrBlock * b = f->blocks[k];
+      int s;
+      for (s=0;s<b->nsuccs;s++)
+        if ((b->succ[s] != NULL) && seen[b->succ[s]->order])
+          irRemovePred(b->succ[s],b);
+    }
+  for (k=0;k<n;k++)
+  { f->blocks[k] = post[n-1-k];
+    f->blocks[k]->order = k;
+  }
+  f->nblocks = n;
+  free(post);
+  free(seen);
+}
+
+static IrBlock * intersect( IrBlock * a, IrBlock * b)
+{ while (a != b)
+  { while (a->order > b->order) a = a->idom;
+    while (b->order > a->order) b = b->idom;
+  }
+  return a;
+}
+
+/* Procedure irComputeDominators sets the
+ * immediate dominator of every block (call
+ * irComputeOrder first)
+ */
+void irComputeDominators( IrFunc * f)
+{ int k, p, changed;
+  if (f->nblocks == 0) return;
+  for (k=0;k<f->nblocks;k++) f->blocks[k]->idom = NULL;
+  f->blocks[0]->idom = f->blocks[0];
+  do
+  { changed = FALSE;
+    for (k=1;k<f->nblocks;k++)
+    { IrBlock * b = f->blocks[k], * d = NULL;
+      for (p=0;p<b->npreds;p++)
+        if (b->preds[p]->idom != NULL)
+          d = (d == NULL) ? b->preds[p] : intersect(b->preds[p],d);
+      if (d != b->idom)
+      { b->idom = d;
+        changed = TRUE;
+      }
+    }
+  } while (changed);
+  f->blocks[0]->idom = NULL;
+}
+
+/* Function irDominates is TRUE if block a
+ * dominates block b
+ */
+int irDominates( IrBlock * a, IrBlock * b)
+{ while (b != NULL)
+  { if (a == b) return TRUE;
+    b = b->idom;
+  }
+  return FALSE;
+}
+
+/********************************************/
+/* the verifier                             */
+/********************************************/
+
+static int errors;
+static char * passName;
+
+static void irError( IrBlock * b, char * message, int v)
+{ if (errors++ >= MAXERRORS) return;
+  fprintf(listing,">>> IR error after %s, block B%d: %s",
+          passName,b->id,message);
+  if (v >= 0) fprintf(listing," v%d",v);
+  fprintf(listing,"\n");
+}
+
+/* Function inFunc is TRUE if block b is one of
+   the blocks of f */
+static int inFunc( IrFunc * f, IrBlock * b)
+{ return (b != NULL) && (b->order >= 0) && (b->order < f->nblocks) &&
+         (f->blocks[b->order] == b);
+}
+
+/* Function defReaches is TRUE if the definition
+ * of value v is available at instruction at of
+ * block b (at NULL meaning the end of b)
+ */
+static int defReaches( IrFunc * f, int v, IrBlock * b, IrInstr * at)
+{ IrInstr * d = f->def[v], * i;
+  if (d == NULL) return FALSE;
+  if (d->block != b) return irDominates(d->block,b);
+  for (i=b->first;i != at;i = i->next)
+    if (i == d) return TRUE;
+  return FALSE;
+}
+
+/* Function leadsTo is TRUE if block b is a
+   successor of block p */
+static int leadsTo( IrBlock * p, IrBlock * b)
+{ int s;
+  for (s=0;s<p->nsuccs;s++)
+    if (p->succ[s] == b) return TRUE;
+  return FALSE;
+}
+
+static void checkValue( IrFunc * f, IrBlock * b, int v)
+{ if ((v < 0) || (v >= f->nvalues)) irError(b,"bad value",v);
+  else if (f->def[v] == NULL) irError(b,"use of undefined value",v);
+  else if (! inFunc(f,f->def[v]->block))
+    irError(b,"use of value defined in a deleted block",v);
+}
+
+/* Function irVerify checks the structure of f and,
+ * while it is in SSA form, that every value is
+ * defined once before all of its uses. Problems
+ * are reported to the listing, naming pass as the
+ * last one run. Returns TRUE if f is well formed
+ */
+int irVerify( IrFunc * f, char * pass)
+{ int k, j, s, n;
+  int * ndefs = (int *) calloc(f->nvalues+1,sizeof(int));
+  IrInstr * i;
+  errors = 0;
+  passName = pass;
+  if (ndefs == NULL)
+  { fprintf(listing,"Out of memory error in intermediate code\n");
+    exit(1);
+  }
+  for (k=0;k<f->nblocks;k++) f->blocks[k]->order = k;
+  irComputeDominators(f);
+  for (k=0;k<f->nblocks;k++)
+  { IrBlock * b = f->blocks[k];
+    int phis = TRUE;
+    if ((k == 0) && (b->npreds > 0)) irError(b,"entry block has predecessors",-1);
+    /* the edges must agree in both directions */
+    n = (b->term == IrJump) ? 1 : (b->term == IrBranch) ? 2 :
+        (b->term == IrHalt) ? 0 : b->nsuccs;
+    if ((b->nsuccs != n) || ((b->term == IrSwitch) && (n == 0)))
+      irError(b,"wrong number of successors",-1);
+    for (s=0;s<b->nsuccs;s++)
+    { IrBlock * t = b->succ[s];
+      if (t == NULL) irError(b,"wrong number of successors",-1);
+      else if (! inFunc(f,t)) irError(b,"successor is not in the function",-1);
+      else if (predIndex(t,b) < 0) irError(b,"missing from predecessors of successor",-1);
+    }
+    if (b->term == IrSwitch)
+      for (j=0;j<b->ntable;j++)
+        if ((b->table[j] < 0) || (b->table[j] >= b->nsuccs))
+          irError(b,"switch table entry is not a successor",-1);
+    for (j=0;j<b->npreds;j++)
+      if (!inFunc(f,b->preds[j]) || !leadsTo(b->preds[j],b))
+        irError(b,"predecessor does not lead here",-1);
+    if ((b->term == IrBranch) || (b->term == IrSwitch))
+    { checkValue(f,b,b->cond);
+      if (f->ssa && (b->cond >= 0) && (b->cond < f->nvalues) &&
+          !defReaches(f,b->cond,b,NULL))
+        irError(b,"branch condition not available",b->cond);
+    }
+    for (i=b->first;i != NULL;i = i->next)
+    { if ((i->block != b) || ((i->next != NULL) && (i->next->prev != i)) ||
+          ((i->next == NULL) && (b->last != i)))
+        irError(b,"broken instruction list",i->dst);
+      if (i->op == IrPhi)
+      { if (! phis) irError(b,"phi after other instructions",i->dst);
+        if (! f->ssa) irError(b,"phi outside SSA form",i->dst);
+        if (i->nargs != b->npreds)
+          irError(b,"phi arguments do not match predecessors",i->dst);
+      }
+      else phis = FALSE;
+      if (i->dst >= f->nvalues) irError(b,"bad value",i->dst);
+      else if (i->dst >= 0)
+      { ndefs[i->dst]++;
+        if (f->ssa && (f->def[i->dst] != i))
+          irError(b,"definition not recorded",i->dst);
+      }
+      for (j=0;j<i->nargs;j++)
+      { checkValue(f,b,i->args[j]);
+        if (!f->ssa || (i->args[j] < 0) || (i->args[j] >= f->nvalues)) continue;
+        if (i->op == IrPhi)
+        { if ((j < b->npreds) && !defReaches(f,i->args[j],b->preds[j],NULL))
+            irError(b,"phi argument does not reach its edge",i->args[j]);
+        }
+        else if (! defReaches(f,i->args[j],b,i))
+          irError(b,"use not dominated by definition",i->args[j]);
+      }
+    }
+  }
+  if (f->ssa)
+    for (n=0;n<f->nvalues;n++)
+      if (ndefs[n] > 1) irError(f->blocks[0],"value defined more than once",n);
+  free(ndefs);
+  if (errors > MAXERRORS)
+    fprintf(listing,">>> IR error after %s: %d more problems\n",
+            pass,errors-MAXERRORS);
+  return errors == 0;
+}
+
+/********************************************/
+/* the dumper                               */
+/********************************************/
+
+static char * opName[] =
+   { "const", "copy", "add", "sub", "mul", "div", "lt", "eq",
+     "in", "out", "load", "store", "checklow", "checkhigh", "call", "phi" };
+
+/* Procedure irDump prints f to the listing file */
+void irDump( IrFunc * f)
+{ int k, j;
+  IrInstr * i;
+  for (k=0;k<f->nblocks;k++)
+  { IrBlock * b = f->blocks[k];
+    fprintf(listing,"B%d:",b->id);
+    if (b->npreds > 0)
+    { fprintf(listing,"  <-");
+      for (j=0;j<b->npreds;j++) fprintf(listing," B%d",b->preds[j]->id);
+    }
+    if (b->depth > 0) fprintf(listing,"  (loop depth %d)",b->depth);
+    fprintf(listing,"\n");
+    forInstr(i,b)
+    { fprintf(listing,"    ");
+      if (i->dst >= 0) fprintf(listing,"v%d = ",i->dst);
+      fprintf(listing,"%s",opName[i->op]);
+      if ((i->op == IrConst) || (i->op == IrLoad) || (i->op == IrStore) ||
+          (i->op == IrCheckHigh) || (i->op == IrCall))
+        fprintf(listing," %d",i->val);
+      if ((i->op == IrCopy) && i->val) fprintf(listing,"||");
+      for (j=0;j<i->nargs;j++)
+      { fprintf(listing,"%s v%d",(j > 0) ? "," : "",i->args[j]);
+        if ((i->op == IrPhi) && (j < b->npreds))
+          fprintf(listing," (B%d)",b->preds[j]->id);
+      }
+      if ((i->dst >= 0) && (f->name[i->dst] != NULL))
+        fprintf(listing,"\t\t%s",f->name[i->dst]);
+      fprintf(listing,"\n");
+    }
+    switch (b->term)
+    { case IrJump :
+        fprintf(listing,"    jump B%d\n",b->succ[0]->id);
+        break;
+      case IrBranch :
+        fprintf(listing,"    branch v%d ? B%d : B%d\n",
+                b->cond,b->succ[0]->id,b->succ[1]->id);
+        break;
+      case IrSwitch :
+        fprintf(listing,"    switch v%d - %d [",b->cond,b->low);
+        for (j=0;j<b->ntable;j++)
+          fprintf(listing,"%sB%d",(j > 0) ? " " : "",b->succ[b->table[j]]->id);
+        fprintf(listing,"] else B%d\n",b->succ[0]->id);
+        break;
+      default :
+        fprintf(listing,"    halt\n");
+        break;
+    }
+  }
+}
@@ -0,0 +1,196 @@
+/****************************************************/
+/* File: ir.h                                       */
+/* Intermediate representation for the TINY         */
+/* compiler: basic blocks of three-address code in  */
+/* SSA form                                         */
+/****************************************************/
+
+#ifndef _IR_H_
+#define _IR_H_
+
+/* the operations of the three-address code. Every
+ * operation defines at most one value and uses
+ * values only; the immediate operand of IrConst,
+ * the base address of the array IrLoad (value =
+ * element args[0]) and IrStore (element args[0] =
+ * args[1]) access, the array size IrCheckHigh
+ * compares index args[0] with, and the number of
+ * the procedure IrCall calls are kept in val.
+ * IrCheckLow and IrCheckHigh stop the machine
+ * if the index is below 0 or not below the size.
+ * Variables a procedure uses are passed in memory:
+ * they are stored before a call, with IrStore at
+ * index 0 of the variable, and loaded after it
+ */
+typedef enum
+   { IrConst, IrCopy, IrAdd, IrSub, IrMul, IrDiv, IrLt, IrEq,
+     IrIn, IrOut, IrLoad, IrStore, IrCheckLow, IrCheckHigh, IrCall, IrPhi
+   } IrOp;
+
+/* how a basic block ends */
+typedef enum { IrJump, IrBranch, IrSwitch, IrHalt } IrTerm;
+
+typedef struct IrInstrRec
+   { IrOp op;
+     int dst;      /* value defined, or -1 */
+     int nargs;
+     int * args;   /* values used; a phi has one per
+                      predecessor, in the same order */
+     int val;      /* constant of IrConst; base address
+                      of IrLoad and IrStore; array size
+                      of IrCheckHigh; procedure number
+                      of IrCall; TRUE for an
+                      IrCopy that is one of the copies
+                      ending a block done all at once */
+     int lineno;
+     struct IrBlockRec * block;
+     struct IrInstrRec * prev, * next;
+   } IrInstr;
+
+typedef struct IrBlockRec
+   { int id;
+     IrInstr * first, * last;
+     int npreds, maxpreds;
+     struct IrBlockRec ** preds;
+     /* IrJump goes to succ[0]; IrBranch goes to
+        succ[0] if value cond is nonzero and to
+        succ[1] otherwise; IrSwitch goes to
+        succ[table[cond-low]] if cond-low is in
+        0..ntable-1 and to succ[0] otherwise. The
+        successors of a switch are all different */
+     IrTerm term;
+     int cond;
+     int nsuccs, maxsuccs;
+     struct IrBlockRec ** succ;
+     int low, ntable;
+     int * table;
+     int likely;   /* successor taken more often (1
+                      unless a profile says otherwise) */
+     int depth;    /* repeat nesting depth */
+     int order;    /* reverse postorder number */
+     struct IrBlockRec * idom;
+     int * defs;   /* used while building SSA form */
+     int sealed;
+   } IrBlock;
+
+typedef struct
+   { char * procName;     /* NULL for the main program */
+     int nblocks, maxblocks;
+     IrBlock ** blocks;   /* blocks[0] is the entry */
+     int nextid;          /* id of the next new block */
+     int nvalues, maxvalues;
+     IrInstr ** def;      /* defining instruction */
+     char ** name;        /* source variable or NULL */
+     int ssa;             /* TRUE while in SSA form */
+   } IrFunc;
+
+/* iterate over the instructions of a block */
+#define forInstr(i,b) for ((i) = (b)->first; (i) != NULL; (i) = (i)->next)
+
+/* Function irNewFunc returns an empty function */
+IrFunc * irNewFunc(void);
+
+/* Function irNewBlock adds a block at loop
+ * nesting depth depth to f
+ */
+IrBlock * irNewBlock(IrFunc * f, int depth);
+
+/* Function irNewValue returns a fresh value for
+ * source variable name (which may be NULL)
+ */
+int irNewValue(IrFunc * f, char * name);
+
+/* Function irNewInstr returns an unlinked
+ * instruction with room for nargs arguments that
+ * defines value dst (-1 for none)
+ */
+IrInstr * irNewInstr(IrFunc * f, IrOp op, int dst, int nargs, int lineno);
+
+/* Procedures irAppend, irPrepend and irInsertBefore
+ * link instruction i into a block; irRemove unlinks it
+ */
+void irAppend(IrBlock * b, IrInstr * i);
+void irPrepend(IrBlock * b, IrInstr * i);
+void irInsertBefore(IrInstr * at, IrInstr * i);
+void irRemove(IrFunc * f, IrInstr * i);
+
+/* Procedures irSetJump, irSetBranch, irSetSwitch
+ * and irSetHalt set how block b ends, adding b to
+ * the predecessors of its new successors. The
+ * switch goes to to[cond-low] for cond in low to
+ * low+n-1 and to deflt otherwise
+ */
+void irSetJump(IrBlock * b, IrBlock * to);
+void irSetBranch(IrBlock * b, int cond, IrBlock * ifTrue, IrBlock * ifFalse);
+void irSetSwitch(IrBlock * b, int cond, IrBlock * deflt, int low, int n,
+                 IrBlock ** to);
+void irSetHalt(IrBlock * b);
+
+/* Procedure irReplacePred makes block to (on the
+ * edge from old) come from new instead, keeping the
+ * order of the phi arguments; irRemovePred drops
+ * the edge from p and the phi arguments for it
+ */
+void irReplacePred(IrBlock * b, IrBlock * old, IrBlock * new);
+void irRemovePred(IrBlock * b, IrBlock * p);
+
+/* Procedure irRetarget makes block b go to block
+ * to wherever it went to block old. The phis of to
+ * get the arguments they had on the edge from old
+ */
+void irRetarget(IrBlock * b, IrBlock * old, IrBlock * to);
+
+/* Function irSplitEdge puts a new block on the
+ * edge from block p to block b and returns it
+ */
+IrBlock * irSplitEdge(IrFunc * f, IrBlock * p, IrBlock * b);
+
+/* Procedure irReplaceValue makes every use of
+ * value old a use of value new
+ */
+void irReplaceValue(IrFunc * f, int old, int new);
+
+/* Function irUses returns the number of uses of
+ * value v (the branch conditions included)
+ */
+int irUses(IrFunc * f, int v);
+
+/* Function irIsConst is TRUE if value v is a known
+ * constant, which is then stored in *c
+ */
+int irIsConst(IrFunc * f, int v, int * c);
+
+/* Function irHasEffect is TRUE if instruction i
+ * must be kept even if its value is never used
+ */
+int irHasEffect(IrFunc * f, IrInstr * i);
+
+/* Procedure irComputeOrder numbers the reachable
+ * blocks in reverse postorder and deletes the rest;
+ * afterwards blocks[] is sorted in that order
+ */
+void irComputeOrder(IrFunc * f);
+
+/* Procedure irComputeDominators sets the
+ * immediate dominator of every block (call
+ * irComputeOrder first)
+ */
+void irComputeDominators(IrFunc * f);
+
+/* Function irDominates is TRUE if block a
+ * dominates block b
+ */
+int irDominates(IrBlock * a, IrBlock * b);
+
+/* Function irVerify checks the structure of f and,
+ * while it is in SSA form, that every value is
+ * defined once before all of its uses. Problems
+ * are reported to the listing, naming pass as the
+ * last one run. Returns TRUE if f is well formed
+ */
+int irVerify(IrFunc * f, char * pass);
+
+/* Procedure irDump prints f to the listing file */
+void irDump(IrFunc * f);
+
+#endif
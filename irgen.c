@@ -0,0 +1,748 @@
+/****************************************************/
+/* File: irgen.c                                    */
+/* Translation of the syntax tree into SSA form     */
+/* intermediate code for the TINY compiler          */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "symtab.h"
+#include "ir.h"
+#include "irgen.h"
+
+/* The SSA form is built directly from the tree
+ * (Braun et al., "Simple and Efficient Construction
+ * of Static Single Assignment Form"): each block
+ * remembers the value of every variable it defines,
+ * and a read in a block that does not define the
+ * variable asks the predecessors, placing a phi
+ * where they may disagree. A block is sealed once
+ * all of its predecessors are known; until then its
+ * phis are left incomplete
+ */
+
+static IrFunc * f;
+
+/* the block code is being added to */
+static IrBlock * cur;
+
+/* loop nesting depth of the code being added */
+static int depth;
+
+/* number of variables, and the name of each. Each
+   for loop counts its iterations in a variable of
+   its own, numbered from nlocs up */
+static int nvars;
+static char ** varName;
+static int nlocs, nextCount;
+
+/* a removed trivial phi forwards to the value
+   that replaced it */
+static int * fwd = NULL;
+static int maxfwd = 0;
+
+/* the value 0, which every variable of the main
+   program not declared with another starts out
+   with, and the constant each of the others
+   starts out with once it is read */
+static int zero;
+static int * initial = NULL;
+
+/* the program, and the procedure being translated
+   (NULL for the main program) */
+static TreeNode * program;
+static TreeNode * proc;
+
+/* the incomplete phis of unsealed blocks */
+typedef struct IncompleteRec
+   { IrBlock * block;
+     int var;
+     IrInstr * phi;
+     struct IncompleteRec * next;
+   } * IncompleteList;
+
+static IncompleteList incomplete = NULL;
+
+static int resolve( int v)
+{ while ((v >= 0) && (v < maxfwd) && (fwd[v] >= 0)) v = fwd[v];
+  return v;
+}
+
+static void forward( int v, int to)
+{ if (v >= maxfwd)
+  { int k, old = maxfwd;
+    maxfwd = f->nvalues + 64;
+    fwd = (int *) realloc(fwd,maxfwd * sizeof(int));
+    if (fwd == NULL)
+    { fprintf(listing,"Out of memory error in intermediate code\n");
+      exit(1);
+    }
+    for (k=old;k<maxfwd;k++) fwd[k] = -1;
+  }
+  fwd[v] = to;
+}
+
+static IrBlock * newBlock( int d)
+{ IrBlock * b = irNewBlock(f,d);
+  int k;
+  b->defs = (int *) malloc((nvars+1) * sizeof(int));
+  if (b->defs == NULL)
+  { fprintf(listing,"Out of memory error in intermediate code\n");
+    exit(1);
+  }
+  for (k=0;k<nvars;k++) b->defs[k] = -1;
+  return b;
+}
+
+static int readVariable( int var, IrBlock * b);
+
+/* Function entryValue returns the value variable
+ * var has when the function starts: its initial
+ * value in the main program, and what the caller
+ * left in memory in a procedure (loaded at the end
+ * of the entry block)
+ */
+static int entryValue( int var)
+{ IrInstr * i;
+  if ((var >= nlocs) || ((proc == NULL) && (st_init(var) == 0))) return zero;
+  if (proc == NULL)
+  { i = irNewInstr(f,IrConst,irNewValue(f,varName[var]),0,0);
+    i->val = st_init(var);
+    irAppend(f->blocks[0],i);
+    return initial[var] = i->dst;
+  }
+  i = irNewInstr(f,IrLoad,irNewValue(f,varName[var]),1,proc->lineno);
+  i->args[0] = zero;
+  i->val = var;
+  irAppend(f->blocks[0],i);
+  return i->dst;
+}
+
+/* Function inMemory is TRUE if variable var has
+ * value v in memory as well
+ */
+static int inMemory( int var, int v)
+{ IrInstr * i = f->def[v];
+  if (proc == NULL)
+    return (v == zero) ? (st_init(var) == 0) : (v == initial[var]);
+  return (i != NULL) && (i->op == IrLoad) && (i->val == var) &&
+         (i->args[0] == zero);
+}
+
+static void writeVariable( int var, IrBlock * b, int v)
+{ b->defs[var] = v;
+}
+
+/* Function removeTrivialPhi removes phi if all its
+ * arguments other than itself are the same value,
+ * and returns the value that stands for it
+ */
+static int removeTrivialPhi( IrInstr * phi)
+{ int same = -1, v = phi->dst, k, j, n = 0;
+  IrInstr ** users, * i;
+  for (k=0;k<phi->nargs;k++)
+  { int a = resolve(phi->args[k]);
+    if ((a == same) || (a == v)) continue;
+    if (same >= 0) return v;
+    same = a;
+  }
+  if (same < 0) same = zero;
+  /* phis using this one may become trivial in turn */
+  users = (IrInstr **) malloc(f->nvalues * sizeof(IrInstr *));
+  if (users == NULL)
+  { fprintf(listing,"Out of memory error in intermediate code\n");
+    exit(1);
+  }
+  for (k=0;k<f->nblocks;k++)
+    forInstr(i,f->blocks[k])
+      if ((i->op == IrPhi) && (i != phi))
+        for (j=0;j<i->nargs;j++)
+          if (resolve(i->args[j]) == v)
+          { users[n++] = i;
+            break;
+          }
+  irRemove(f,phi);
+  forward(v,same);
+  for (k=0;k<n;k++)
+    if (users[k]->block != NULL) removeTrivialPhi(users[k]);
+  free(users);
+  return resolve(same);
+}
+
+static int addPhiOperands( int var, IrInstr * phi)
+{ IrBlock * b = phi->block;
+  int k;
+  phi->args = (int *) malloc((b->npreds+1) * sizeof(int));
+  if (phi->args == NULL)
+  { fprintf(listing,"Out of memory error in intermediate code\n");
+    exit(1);
+  }
+  phi->nargs = b->npreds;
+  for (k=0;k<b->npreds;k++)
+    phi->args[k] = readVariable(var,b->preds[k]);
+  return removeTrivialPhi(phi);
+}
+
+static IrInstr * newPhi( int var, IrBlock * b)
+{ IrInstr * phi = irNewInstr(f,IrPhi,irNewValue(f,varName[var]),0,0);
+  irPrepend(b,phi);
+  return phi;
+}
+
+static int readVariable( int var, IrBlock * b)
+{ int v;
+  IrInstr * phi;
+  if (b->defs[var] >= 0) return resolve(b->defs[var]);
+  if (! b->sealed)
+  { IncompleteList l = (IncompleteList) malloc(sizeof(struct IncompleteRec));
+    if (l == NULL)
+    { fprintf(listing,"Out of memory error in intermediate code\n");
+      exit(1);
+    }
+    phi = newPhi(var,b);
+    l->block = b;
+    l->var = var;
+    l->phi = phi;
+    l->next = incomplete;
+    incomplete = l;
+    v = phi->dst;
+  }
+  else if (b->npreds == 0) v = entryValue(var);
+  else if (b->npreds == 1) v = readVariable(var,b->preds[0]);
+  else
+  { /* the phi breaks cycles through loops */
+    phi = newPhi(var,b);
+    writeVariable(var,b,phi->dst);
+    v = addPhiOperands(var,phi);
+  }
+  writeVariable(var,b,v);
+  return v;
+}
+
+static void sealBlock( IrBlock * b)
+{ IncompleteList l, * pl = &incomplete;
+  while ((l = *pl) != NULL)
+    if (l->block == b)
+    { *pl = l->next;
+      addPhiOperands(l->var,l->phi);
+      free(l);
+    }
+    else pl = &l->next;
+  b->sealed = TRUE;
+}
+
+static int emit( IrOp op, int dst, int a, int b, int lineno)
+{ IrInstr * i = irNewInstr(f,op,dst,(a < 0) ? 0 : (b < 0) ? 1 : 2,lineno);
+  if (a >= 0) i->args[0] = a;
+  if (b >= 0) i->args[1] = b;
+  irAppend(cur,i);
+  return dst;
+}
+
+/* Function emitVal is emit for the operations
+ * that keep an address or size in val
+ */
+static int emitVal( IrOp op, int dst, int a, int b, int val, int lineno)
+{ emit(op,dst,a,b,lineno);
+  cur->last->val = val;
+  return dst;
+}
+
+/* Function emitConst adds constant c and returns
+ * its value
+ */
+static int emitConst( int c, int lineno)
+{ IrInstr * i = irNewInstr(f,IrConst,irNewValue(f,NULL),0,lineno);
+  i->val = c;
+  irAppend(cur,i);
+  return i->dst;
+}
+
+static int genExp( TreeNode * tree);
+
+/* Procedure storeVars stores the variables marked
+ * in vars whose values memory does not hold yet;
+ * chars are always in memory
+ */
+static void storeVars( int * vars, int lineno)
+{ int var, v;
+  for (var=0;var<nlocs;var++)
+    if (vars[var] && !st_isByte(var))
+    { v = readVariable(var,cur);
+      if (! inMemory(var,v)) emitVal(IrStore,-1,zero,v,var,lineno);
+    }
+}
+
+/* Function procNumber returns the number of
+ * procedure name among those of the program,
+ * counting from 1
+ */
+static int procNumber( char * name)
+{ TreeNode * d;
+  int n = 0;
+  for (d=program->child[0];d != NULL;d = d->sibling)
+    if (d->kind.decl == ProcK)
+    { n++;
+      if (strcmp(d->attr.name,name) == 0) return n;
+    }
+  return 0;
+}
+
+/* Procedure genCall adds the code for call tree:
+ * the variables the procedure uses are stored
+ * before it, and those it sets are loaded after it
+ */
+static void genCall( TreeNode * tree)
+{ int * reads = (int *) calloc(nlocs+1,sizeof(int));
+  int * writes = (int *) calloc(nlocs+1,sizeof(int));
+  int var;
+  IrInstr * i;
+  if ((reads == NULL) || (writes == NULL))
+  { fprintf(listing,"Out of memory error in intermediate code\n");
+    exit(1);
+  }
+  callEffects(st_proc(tree->attr.name)->child[1],reads,writes);
+  for (var=0;var<nlocs;var++) reads[var] |= writes[var];
+  storeVars(reads,tree->lineno);
+  i = irNewInstr(f,IrCall,-1,0,tree->lineno);
+  i->val = procNumber(tree->attr.name);
+  irAppend(cur,i);
+  for (var=0;var<nlocs;var++)
+    if (writes[var] && !st_isByte(var))
+      writeVariable(var,cur,emitVal(IrLoad,irNewValue(f,varName[var]),zero,-1,
+                                    var,tree->lineno));
+  free(reads);
+  free(writes);
+}
+
+/* Function genIndex adds the code for index, the
+ * index of array access tree, and the bounds
+ * checks tree still needs, and returns the value
+ * of the index
+ */
+static int genIndex( TreeNode * tree, TreeNode * index)
+{ int v = genExp(index);
+  if (tree->check & CHECKLOW)
+    emit(IrCheckLow,-1,v,-1,tree->lineno);
+  if (tree->check & CHECKHIGH)
+    emitVal(IrCheckHigh,-1,v,-1,st_size(tree->attr.name),tree->lineno);
+  return v;
+}
+
+/* Function genExp adds the code for expression
+ * tree and returns the value holding its result
+ */
+static int genExp( TreeNode * tree)
+{ int a, b;
+  IrOp op;
+  IrInstr * i;
+  switch (tree->kind.exp)
+  { case ConstK :
+      i = irNewInstr(f,IrConst,irNewValue(f,NULL),0,tree->lineno);
+      i->val = tree->attr.val;
+      irAppend(cur,i);
+      return i->dst;
+    case IdK :
+      a = st_lookup(tree->attr.name);
+      /* chars stay in memory like arrays */
+      if (st_isByte(a))
+        return emitVal(IrLoad,irNewValue(f,varName[a]),zero,-1,a,
+                       tree->lineno);
+      return readVariable(a,cur);
+    case IndexK :
+      /* arrays stay in memory */
+      a = genIndex(tree,tree->child[0]);
+      return emitVal(IrLoad,irNewValue(f,NULL),a,-1,
+                     st_lookup(tree->attr.name),tree->lineno);
+    case OpK :
+      a = genExp(tree->child[0]);
+      b = genExp(tree->child[1]);
+      switch (tree->attr.op)
+      { case PLUS : op = IrAdd; break;
+        case MINUS : op = IrSub; break;
+        case TIMES : op = IrMul; break;
+        case OVER : op = IrDiv; break;
+        case LT : op = IrLt; break;
+        default : op = IrEq; break;
+      }
+      return emit(op,irNewValue(f,NULL),a,b,tree->lineno);
+    default :
+      return zero;
+  }
+}
+
+/* Procedure genBranch ends the current block with
+ * a branch to ifTrue if test tree holds and to
+ * ifFalse if not. The second operand of and and
+ * or starts a block of its own, so it is only
+ * evaluated if the first one does not decide
+ */
+static void genBranch( TreeNode * tree, IrBlock * ifTrue, IrBlock * ifFalse)
+{ IrBlock * b;
+  if ((tree->kind.exp == OpK) && (tree->attr.op == NOT))
+  { genBranch(tree->child[0],ifFalse,ifTrue);
+    return;
+  }
+  if ((tree->kind.exp == OpK) &&
+      ((tree->attr.op == AND) || (tree->attr.op == OR)))
+  { b = newBlock(depth);
+    if (tree->attr.op == AND) genBranch(tree->child[0],b,ifFalse);
+    else genBranch(tree->child[0],ifTrue,b);
+    sealBlock(b);
+    cur = b;
+    genBranch(tree->child[1],ifTrue,ifFalse);
+    return;
+  }
+  irSetBranch(cur,genExp(tree),ifTrue,ifFalse);
+}
+
+/* Procedure genSwitch ends the current block by
+ * matching value v, the selector of a case
+ * statement, with labels lo..hi: by a switch if
+ * they are dense, by comparing with each in turn if
+ * they are few, and by a binary search on them
+ * otherwise. arms holds the block of each arm, and
+ * deflt the one for a selector no label matches
+ */
+static void genSwitch( int v, CaseLabel * labels, int lo, int hi,
+                       IrBlock ** arms, IrBlock * deflt, int lineno)
+{ int k, c, low, n, pivot, split = caseSplit(labels,lo,hi,&pivot);
+  IrBlock * b, * upper, ** to;
+  if (split == CASETABLE)
+  { low = labels[lo].val;
+    n = labels[hi].val - low + 1;
+    to = (IrBlock **) malloc(n * sizeof(IrBlock *));
+    if (to == NULL)
+    { fprintf(listing,"Out of memory error in intermediate code\n");
+      exit(1);
+    }
+    for (k=0;k<n;k++) to[k] = deflt;
+    for (k=lo;k<=hi;k++) to[labels[k].val - low] = arms[labels[k].arm];
+    irSetSwitch(cur,v,deflt,low,n,to);
+    free(to);
+  }
+  else if (split == CASECHAIN)
+  { for (k=lo;k<=hi;k++)
+    { c = emitConst(labels[k].val,lineno);
+      c = emit(IrEq,irNewValue(f,NULL),v,c,lineno);
+      b = (k < hi) ? newBlock(depth) : deflt;
+      irSetBranch(cur,c,arms[labels[k].arm],b);
+      if (k < hi)
+      { sealBlock(b);
+        cur = b;
+      }
+    }
+    if (lo > hi) irSetJump(cur,deflt);
+  }
+  else
+  { c = emitConst(pivot,lineno);
+    c = emit(IrLt,irNewValue(f,NULL),v,c,lineno);
+    b = newBlock(depth);
+    upper = newBlock(depth);
+    irSetBranch(cur,c,b,upper);
+    sealBlock(b);
+    sealBlock(upper);
+    cur = b;
+    genSwitch(v,labels,lo,split-1,arms,deflt,lineno);
+    cur = upper;
+    genSwitch(v,labels,split,hi,arms,deflt,lineno);
+  }
+}
+
+static void genStmts( TreeNode * tree);
+
+/* Procedure genCase adds the code for case
+ * statement tree: a block for each arm and one for
+ * the else part, all joining after it
+ */
+static void genCase( TreeNode * tree)
+{ CaseLabel * labels;
+  TreeNode * arm;
+  IrBlock ** arms, * deflt, * join;
+  int v, n, k, narms = 0;
+  v = genExp(tree->child[0]);
+  labels = caseLabels(tree,&n);
+  for (arm=tree->child[1];arm != NULL;arm = arm->sibling) narms++;
+  arms = (IrBlock **) malloc((narms+1) * sizeof(IrBlock *));
+  if (arms == NULL)
+  { fprintf(listing,"Out of memory error in intermediate code\n");
+    exit(1);
+  }
+  for (k=0;k<narms;k++) arms[k] = newBlock(depth);
+  deflt = newBlock(depth);
+  join = newBlock(depth);
+  genSwitch(v,labels,0,n-1,arms,deflt,tree->lineno);
+  for (arm=tree->child[1],k=0;arm != NULL;arm = arm->sibling,k++)
+  { sealBlock(arms[k]);
+    cur = arms[k];
+    genStmts(arm->child[1]);
+    irSetJump(cur,join);
+  }
+  sealBlock(deflt);
+  cur = deflt;
+  genStmts(tree->child[2]);
+  irSetJump(cur,join);
+  sealBlock(join);
+  cur = join;
+  free(arms);
+  free(labels);
+}
+
+/* Procedure genStmts adds the code for the
+ * statement sequence tree
+ */
+static void genStmts( TreeNode * tree)
+{ for (;tree != NULL;tree = tree->sibling)
+  { IrBlock * b1, * b2, * join;
+    int v, var, x, count;
+    if (tree->nodekind != StmtK) continue;
+    switch (tree->kind.stmt)
+    { case AssignK :
+        var = st_lookup(tree->attr.name);
+        if (tree->child[1] != NULL)
+        { x = genIndex(tree,tree->child[1]);
+          v = genExp(tree->child[0]);
+          emitVal(IrStore,-1,x,v,var,tree->lineno);
+          break;
+        }
+        v = genExp(tree->child[0]);
+        if (st_isByte(var))
+        { emitVal(IrStore,-1,zero,v,var,tree->lineno);
+          break;
+        }
+        v = emit(IrCopy,irNewValue(f,varName[var]),v,-1,tree->lineno);
+        writeVariable(var,cur,v);
+        break;
+      case ReadK :
+        var = st_lookup(tree->attr.name);
+        if (tree->child[0] != NULL)
+        { x = genIndex(tree,tree->child[0]);
+          v = emit(IrIn,irNewValue(f,NULL),-1,-1,tree->lineno);
+          emitVal(IrStore,-1,x,v,var,tree->lineno);
+          break;
+        }
+        v = emit(IrIn,irNewValue(f,varName[var]),-1,-1,tree->lineno);
+        if (st_isByte(var)) emitVal(IrStore,-1,zero,v,var,tree->lineno);
+        else writeVariable(var,cur,v);
+        break;
+      case WriteK :
+        v = genExp(tree->child[0]);
+        emit(IrOut,-1,v,-1,tree->lineno);
+        break;
+      case CallK :
+        genCall(tree);
+        break;
+      case CaseK :
+        genCase(tree);
+        break;
+      case IfK :
+        b1 = newBlock(depth);
+        b2 = (tree->child[2] != NULL) ? newBlock(depth) : NULL;
+        join = newBlock(depth);
+        genBranch(tree->child[0],b1,(b2 != NULL) ? b2 : join);
+        sealBlock(b1);
+        cur = b1;
+        genStmts(tree->child[1]);
+        irSetJump(cur,join);
+        if (b2 != NULL)
+        { sealBlock(b2);
+          cur = b2;
+          genStmts(tree->child[2]);
+          irSetJump(cur,join);
+        }
+        sealBlock(join);
+        cur = join;
+        break;
+      case RepeatK :
+        /* the body is entered from before the loop
+           and from its own end */
+        b1 = newBlock(++depth);
+        irSetJump(cur,b1);
+        cur = b1;
+        genStmts(tree->child[0]);
+        join = newBlock(depth-1);
+        genBranch(tree->child[1],join,b1);
+        --depth;
+        sealBlock(b1);
+        sealBlock(join);
+        cur = join;
+        break;
+      case WhileK :
+        /* the test is entered from before the loop and
+           from the end of the body; it is laid out
+           after the body when the code is generated */
+        b2 = newBlock(++depth);
+        irSetJump(cur,b2);
+        cur = b2;
+        b1 = newBlock(depth);
+        join = newBlock(depth-1);
+        genBranch(tree->child[0],b1,join);
+        sealBlock(b1);
+        cur = b1;
+        genStmts(tree->child[1]);
+        irSetJump(cur,b2);
+        --depth;
+        sealBlock(b2);
+        sealBlock(join);
+        cur = join;
+        break;
+      case ForK :
+        /* the count of iterations still to go, less
+           one, is tested instead of the variable */
+        var = st_lookup(tree->attr.name);
+        x = genExp(tree->child[0]);
+        v = genExp(tree->child[1]);
+        v = emit(IrSub,irNewValue(f,NULL),v,x,tree->lineno);
+        count = nextCount++;
+        writeVariable(count,cur,v);
+        if (st_isByte(var)) emitVal(IrStore,-1,zero,x,var,tree->lineno);
+        else
+        { x = emit(IrCopy,irNewValue(f,varName[var]),x,-1,tree->lineno);
+          writeVariable(var,cur,x);
+        }
+        b2 = newBlock(++depth);
+        irSetJump(cur,b2);
+        cur = b2;
+        v = emit(IrLt,irNewValue(f,NULL),readVariable(count,cur),zero,
+                 tree->lineno);
+        b1 = newBlock(depth);
+        join = newBlock(depth-1);
+        irSetBranch(cur,v,join,b1);
+        /* the body goes right after the test, like
+           that of a while loop */
+        cur->likely = 0;
+        sealBlock(b1);
+        cur = b1;
+        genStmts(tree->child[2]);
+        x = emitConst(1,tree->lineno);
+        if (st_isByte(var))
+        { v = emitVal(IrLoad,irNewValue(f,varName[var]),zero,-1,var,
+                      tree->lineno);
+          v = emit(IrAdd,irNewValue(f,NULL),v,x,tree->lineno);
+          emitVal(IrStore,-1,zero,v,var,tree->lineno);
+        }
+        else
+        { v = emit(IrAdd,irNewValue(f,varName[var]),readVariable(var,cur),x,
+                   tree->lineno);
+          writeVariable(var,cur,v);
+        }
+        x = emitConst(-1,tree->lineno);
+        v = emit(IrAdd,irNewValue(f,NULL),readVariable(count,cur),x,
+                 tree->lineno);
+        writeVariable(count,cur,v);
+        irSetJump(cur,b2);
+        --depth;
+        sealBlock(b2);
+        sealBlock(join);
+        cur = join;
+        break;
+      default :
+        break;
+    }
+  }
+}
+
+/* Procedure collectNames records the name of every
+ * variable of tree by its memory location, and
+ * counts the for loops
+ */
+static void collectNames( TreeNode * tree)
+{ int k;
+  for (;tree != NULL;tree = tree->sibling)
+  { if (((tree->nodekind == StmtK) &&
+         ((tree->kind.stmt == AssignK) || (tree->kind.stmt == ReadK) ||
+          (tree->kind.stmt == ForK))) ||
+        ((tree->nodekind == ExpK) && (tree->kind.exp == IdK)))
+    { int loc = st_lookup(tree->attr.name);
+      if ((loc >= 0) && (loc < nlocs)) varName[loc] = tree->attr.name;
+    }
+    if ((tree->nodekind == StmtK) && (tree->kind.stmt == ForK)) nvars++;
+    for (k=0;k<MAXCHILDREN;k++) collectNames(tree->child[k]);
+  }
+}
+
+/* Function irGen translates the statements of
+ * procedure p of syntaxTree, or of the main
+ * program if p is NULL, into a function in SSA form
+ */
+IrFunc * irGen( TreeNode * syntaxTree, TreeNode * p)
+{ IrInstr * i;
+  int k, j, changed;
+  f = irNewFunc();
+  program = syntaxTree;
+  proc = p;
+  f->procName = (p != NULL) ? p->attr.name : NULL;
+  nvars = nlocs = nextCount = st_maxloc();
+  varName = (char **) calloc(nlocs+1,sizeof(char *));
+  if (varName == NULL)
+  { fprintf(listing,"Out of memory error in intermediate code\n");
+    exit(1);
+  }
+  collectNames(syntaxTree);
+  /* the counts of the for loops have no name */
+  varName = (char **) realloc(varName,(nvars+1) * sizeof(char *));
+  if (varName == NULL)
+  { fprintf(listing,"Out of memory error in intermediate code\n");
+    exit(1);
+  }
+  for (k=nlocs;k<=nvars;k++) varName[k] = NULL;
+  depth = 0;
+  incomplete = NULL;
+  maxfwd = 0;
+  fwd = NULL;
+  cur = newBlock(0);
+  cur->sealed = TRUE;
+  /* the variables not declared with an initial
+     value start out as 0 */
+  i = irNewInstr(f,IrConst,zero = irNewValue(f,NULL),0,0);
+  i->val = 0;
+  irAppend(cur,i);
+  initial = (int *) malloc((nlocs+1) * sizeof(int));
+  if (initial == NULL)
+  { fprintf(listing,"Out of memory error in intermediate code\n");
+    exit(1);
+  }
+  for (k=0;k<nlocs;k++) initial[k] = -1;
+  if (p == NULL) genStmts(syntaxTree->child[1]);
+  else
+  { int * writes = (int *) calloc(nlocs+1,sizeof(int));
+    if (writes == NULL)
+    { fprintf(listing,"Out of memory error in intermediate code\n");
+      exit(1);
+    }
+    genStmts(p->child[1]);
+    /* the caller finds what the procedure set in
+       memory */
+    callEffects(p->child[1],NULL,writes);
+    storeVars(writes,p->lineno);
+    free(writes);
+  }
+  irSetHalt(cur);
+  /* rewrite uses of removed phis, and remove the
+     phis that became trivial only then */
+  do
+  { changed = FALSE;
+    for (k=0;k<f->nblocks;k++)
+    { IrBlock * b = f->blocks[k];
+      IrInstr * next;
+      for (i=b->first;(i != NULL) && (i->block == b);i = next)
+      { next = i->next;
+        for (j=0;j<i->nargs;j++) i->args[j] = resolve(i->args[j]);
+        if ((i->op == IrPhi) && (removeTrivialPhi(i) != i->dst))
+          changed = TRUE;
+      }
+      b->cond = resolve(b->cond);
+    }
+  } while (changed);
+  for (k=0;k<f->nblocks;k++)
+  { free(f->blocks[k]->defs);
+    f->blocks[k]->defs = NULL;
+  }
+  free(fwd);
+  fwd = NULL;
+  maxfwd = 0;
+  free(initial);
+  initial = NULL;
+  irComputeOrder(f);
+  return f;
+}
@@ -0,0 +1,18 @@
+/****************************************************/
+/* File: irgen.h                                    */
+/* Intermediate code generator interface for the    */
+/* TINY compiler                                    */
+/****************************************************/
+
+#ifndef _IRGEN_H_
+#define _IRGEN_H_
+
+#include "ir.h"
+
+/* Function irGen translates the statements of
+ * procedure p of syntaxTree, or of the main
+ * program if p is NULL, into a function in SSA form
+ */
+IrFunc * irGen(TreeNode * syntaxTree, TreeNode * p);
+
+#endif
@@ -0,0 +1,271 @@
+/****************************************************/
+/* File: iropt.c                                    */
+/* Optimization passes over the intermediate code   */
+/* of the TINY compiler                             */
+/****************************************************/
+
+#include "globals.h"
+#include "ir.h"
+#include "iropt.h"
+
+/* Function phiValue returns the value all the
+ * arguments of phi other than its own result
+ * agree on, or -1 if they differ
+ */
+static int phiValue( IrInstr * phi)
+{ int same = -1, k;
+  for (k=0;k<phi->nargs;k++)
+  { int a = phi->args[k];
+    if ((a == same) || (a == phi->dst)) continue;
+    if (same >= 0) return -1;
+    same = a;
+  }
+  return same;
+}
+
+/* Function irCopyProp replaces the uses of copies,
+ * and of phis whose arguments are all the same, by
+ * the value copied. It returns the number of
+ * instructions removed
+ */
+int irCopyProp( IrFunc * f)
+{ int k, v, n = 0, changed;
+  IrInstr * i, * next;
+  do
+  { changed = FALSE;
+    for (k=0;k<f->nblocks;k++)
+      for (i=f->blocks[k]->first;i != NULL;i = next)
+      { next = i->next;
+        if (i->op == IrCopy) v = i->args[0];
+        else if (i->op == IrPhi) v = phiValue(i);
+        else continue;
+        if (v < 0) continue;
+        irRemove(f,i);
+        irReplaceValue(f,i->dst,v);
+        n++;
+        changed = TRUE;
+      }
+  } while (changed);
+  return n;
+}
+
+/* size of the value numbering hash table */
+#define HASHSIZE 211
+
+/* an instruction whose value is available, in a
+   hash bucket */
+typedef struct VnRec
+   { IrInstr * instr;
+     int hash;
+     struct VnRec * next;
+   } * VnList;
+
+static VnList table[HASHSIZE];
+
+/* the entries in the order they were added, so the
+   ones of a block can be dropped on leaving it */
+static VnList * added = NULL;
+static int nadded = 0;
+
+/* the value each removed value was replaced by,
+   or -1 */
+static int * repl = NULL;
+
+static int replacement( int v)
+{ while ((v >= 0) && (repl[v] >= 0)) v = repl[v];
+  return v;
+}
+
+/* Function keyVal returns the part of the key of
+ * instruction i that is not in its arguments
+ */
+static int keyVal( IrInstr * i)
+{ if ((i->op == IrConst) || (i->op == IrCheckHigh)) return i->val;
+  if (i->op == IrPhi) return i->block->id;
+  return 0;
+}
+
+static int hashOf( IrInstr * i)
+{ unsigned int h = i->op * 31u + keyVal(i);
+  int k;
+  for (k=0;k<i->nargs;k++) h = h * 17u + i->args[k];
+  return h % HASHSIZE;
+}
+
+static int sameKey( IrInstr * a, IrInstr * b)
+{ int k;
+  if ((a->op != b->op) || (a->nargs != b->nargs) || (keyVal(a) != keyVal(b)))
+    return FALSE;
+  for (k=0;k<a->nargs;k++)
+    if (a->args[k] != b->args[k]) return FALSE;
+  return TRUE;
+}
+
+/* Procedure numberBlock removes the instructions of
+ * block b that compute a value already available from
+ * b or a block dominating it, and goes on with the
+ * blocks b immediately dominates
+ */
+static void numberBlock( IrFunc * f, IrBlock * b, int * n)
+{ int mark = nadded, k, h, v;
+  IrInstr * i, * next;
+  VnList e;
+  for (i=b->first;i != NULL;i = next)
+  { next = i->next;
+    for (k=0;k<i->nargs;k++) i->args[k] = replacement(i->args[k]);
+    switch (i->op)
+    { case IrCopy :
+        v = i->args[0];
+        break;
+      case IrPhi :
+        v = phiValue(i);
+        break;
+      case IrAdd :
+      case IrMul :
+      case IrEq :
+        /* operands of commutative operations in a
+           fixed order */
+        if (i->args[0] > i->args[1])
+        { v = i->args[0];
+          i->args[0] = i->args[1];
+          i->args[1] = v;
+        }
+        v = -1;
+        break;
+      case IrIn :
+      case IrOut :
+      case IrLoad :
+      case IrStore :
+      case IrCall :
+        /* memory is not numbered */
+        continue;
+      default :
+        v = -1;
+        break;
+    }
+    if (v < 0)
+    { /* a division or bounds check that may trap
+         already ran wherever an equal one
+         dominates it */
+      h = hashOf(i);
+      for (e=table[h];e != NULL;e = e->next)
+        if (sameKey(e->instr,i)) break;
+      if ((e != NULL) && (i->dst < 0))
+      { /* a check that is known to pass */
+        irRemove(f,i);
+        (*n)++;
+        continue;
+      }
+      if (e != NULL) v = e->instr->dst;
+      else
+      { e = (VnList) malloc(sizeof(struct VnRec));
+        if (e == NULL)
+        { fprintf(listing,"Out of memory error in intermediate code\n");
+          exit(1);
+        }
+        e->instr = i;
+        e->hash = h;
+        e->next = table[h];
+        table[h] = e;
+        added = (VnList *) realloc(added,(nadded+1) * sizeof(VnList));
+        if (added == NULL)
+        { fprintf(listing,"Out of memory error in intermediate code\n");
+          exit(1);
+        }
+        added[nadded++] = e;
+        continue;
+      }
+    }
+    repl[i->dst] = v;
+    irRemove(f,i);
+    (*n)++;
+  }
+  b->cond = replacement(b->cond);
+  for (k=0;k<f->nblocks;k++)
+    if (f->blocks[k]->idom == b) numberBlock(f,f->blocks[k],n);
+  while (nadded > mark)
+  { e = added[--nadded];
+    table[e->hash] = e->next;
+    free(e);
+  }
+}
+
+/* Function irValueNumber removes the instructions
+ * that compute a value already computed on every
+ * path to them. It returns the number removed
+ */
+int irValueNumber( IrFunc * f)
+{ int k, j, n = 0;
+  IrInstr * i;
+  if (f->nblocks == 0) return 0;
+  repl = (int *) malloc((f->nvalues+1) * sizeof(int));
+  if (repl == NULL)
+  { fprintf(listing,"Out of memory error in intermediate code\n");
+    exit(1);
+  }
+  for (k=0;k<f->nvalues;k++) repl[k] = -1;
+  for (k=0;k<HASHSIZE;k++) table[k] = NULL;
+  irComputeDominators(f);
+  numberBlock(f,f->blocks[0],&n);
+  /* phis see the values of later blocks */
+  for (k=0;k<f->nblocks;k++)
+  { IrBlock * b = f->blocks[k];
+    forInstr(i,b)
+      for (j=0;j<i->nargs;j++) i->args[j] = replacement(i->args[j]);
+    b->cond = replacement(b->cond);
+  }
+  free(repl);
+  repl = NULL;
+  free(added);
+  added = NULL;
+  return n;
+}
+
+/* Procedure markLive marks value v and the values
+ * its definition uses as live
+ */
+static void markLive( IrFunc * f, int v, int * live)
+{ IrInstr * d;
+  int k;
+  if ((v < 0) || live[v]) return;
+  live[v] = TRUE;
+  d = f->def[v];
+  if (d != NULL)
+    for (k=0;k<d->nargs;k++) markLive(f,d->args[k],live);
+}
+
+/* Function irDeadCode removes the instructions
+ * whose values are never used. It returns the
+ * number removed
+ */
+int irDeadCode( IrFunc * f)
+{ int * live = (int *) calloc(f->nvalues+1,sizeof(int));
+  int k, j, n = 0;
+  IrInstr * i, * next;
+  if (live == NULL)
+  { fprintf(listing,"Out of memory error in intermediate code\n");
+    exit(1);
+  }
+  for (k=0;k<f->nblocks;k++)
+  { IrBlock * b = f->blocks[k];
+    if ((b->term == IrBranch) || (b->term == IrSwitch))
+      markLive(f,b->cond,live);
+    forInstr(i,b)
+      if (irHasEffect(f,i))
+      { if (i->dst >= 0) live[i->dst] = TRUE;
+        for (j=0;j<i->nargs;j++) markLive(f,i->args[j],live);
+      }
+  }
+  /* instructions with an effect were marked live
+     above, so the rest can go in any order */
+  for (k=0;k<f->nblocks;k++)
+    for (i=f->blocks[k]->first;i != NULL;i = next)
+    { next = i->next;
+      if ((i->dst >= 0) && !live[i->dst])
+      { irRemove(f,i);
+        n++;
+      }
+    }
+  free(live);
+  return n;
+}
@@ -0,0 +1,31 @@
+/****************************************************/
+/* File: iropt.h                                    */
+/* Intermediate code optimizer interface for the    */
+/* TINY compiler                                    */
+/****************************************************/
+
+#ifndef _IROPT_H_
+#define _IROPT_H_
+
+#include "ir.h"
+
+/* Function irCopyProp replaces the uses of copies,
+ * and of phis whose arguments are all the same, by
+ * the value copied. It returns the number of
+ * instructions removed
+ */
+int irCopyProp(IrFunc * f);
+
+/* Function irValueNumber removes the instructions
+ * that compute a value already computed on every
+ * path to them. It returns the number removed
+ */
+int irValueNumber(IrFunc * f);
+
+/* Function irDeadCode removes the instructions
+ * whose values are never used. It returns the
+ * number removed
+ */
+int irDeadCode(IrFunc * f);
+
+#endif
@@ -0,0 +1,973 @@
+/****************************************************/
+/* File: loop.c                                     */
+/* Loop optimizations on the syntax tree for the    */
+/* TINY compiler (induction variables, loop         */
+/* invariant code motion and unrolling)             */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "symtab.h"
+#include "fold.h"
+#include "loop.h"
+
+/* the whole program, for questions about uses of
+   a variable outside a loop */
+static TreeNode * program = NULL;
+
+/* number of multiplications turned into running
+   additions, and of exit tests rewritten */
+static int reduced = 0;
+static int retested = 0;
+
+/* number of invariant expressions and whole
+   assignments moved out of loops */
+static int hoisted = 0;
+static int moved = 0;
+
+/* loops running at most MAXFULL times are unrolled
+   completely */
+#define MAXFULL 16
+
+/* trip counts are only worked out up to MAXTRIP */
+#define MAXTRIP 100000
+
+/* the estimated size in TM instructions unrolling
+   may grow the program to; tm.c has room for
+   IADDR_SIZE = 1024 instructions, and the estimate
+   leaves space for spill code */
+#define CODEBUDGET 640
+
+/* the estimated number of TM instructions a
+   procedure takes besides its body: saving and
+   restoring the return address and registers */
+#define PROCSIZE 6
+
+/* number of loops unrolled completely and partly,
+   and the instructions still left in the budget */
+static int unrolled = 0;
+static int partial = 0;
+static int budget = 0;
+
+static int isId( TreeNode * t, char * name)
+{ return (t != NULL) && (t->nodekind == ExpK) && (t->kind.exp == IdK) &&
+         (strcmp(t->attr.name,name) == 0);
+}
+
+/* Function calledBody returns the body of the
+ * procedure t calls, or NULL if t is no call
+ */
+static TreeNode * calledBody( TreeNode * t)
+{ if ((t->nodekind != StmtK) || (t->kind.stmt != CallK)) return NULL;
+  return st_proc(t->attr.name)->child[1];
+}
+
+/* Function countDefs returns the number of
+ * statements in t (and its siblings) that assign,
+ * read or count variable name, those of the
+ * procedures called included
+ */
+static int countDefs( TreeNode * t, char * name)
+{ int n = 0, i;
+  for (;t != NULL;t = t->sibling)
+  { if ((t->nodekind == StmtK) &&
+        ((t->kind.stmt == AssignK) || (t->kind.stmt == ReadK) ||
+         (t->kind.stmt == ForK)) &&
+        (strcmp(t->attr.name,name) == 0))
+      n++;
+    n += countDefs(calledBody(t),name);
+    for (i=0;i<MAXCHILDREN;i++)
+      n += countDefs(t->child[i],name);
+  }
+  return n;
+}
+
+/* Function countUses returns the number of times
+ * variable name is read in t (and its siblings),
+ * the procedures called included
+ */
+static int countUses( TreeNode * t, char * name)
+{ int n = 0, i;
+  for (;t != NULL;t = t->sibling)
+  { if (isId(t,name)) n++;
+    n += countUses(calledBody(t),name);
+    for (i=0;i<MAXCHILDREN;i++)
+      n += countUses(t->child[i],name);
+  }
+  return n;
+}
+
+/* Function stmtUses returns the number of times
+ * statement t (not its siblings) reads variable
+ * name
+ */
+static int stmtUses( TreeNode * t, char * name)
+{ TreeNode * s = t->sibling;
+  int n;
+  t->sibling = NULL;
+  n = countUses(t,name);
+  t->sibling = s;
+  return n;
+}
+
+/* Function loopDefs returns the number of
+ * statements that set variable name each time
+ * round loop, counting the step of a for loop's
+ * own variable
+ */
+static int loopDefs( TreeNode * loop, char * name)
+{ switch (loop->kind.stmt)
+  { case WhileK :
+      return countDefs(loop->child[1],name);
+    case ForK :
+      return countDefs(loop->child[2],name) +
+             (strcmp(loop->attr.name,name) == 0);
+    default :
+      return countDefs(loop->child[0],name);
+  }
+}
+
+/* isInvariant is TRUE for a leaf whose value does
+   not change while loop runs */
+static int isInvariant( TreeNode * t, TreeNode * loop)
+{ if (t->kind.exp == ConstK) return TRUE;
+  return (t->kind.exp == IdK) && (loopDefs(loop,t->attr.name) == 0);
+}
+
+static TreeNode * newLeaf( TreeNode * model, int lineno)
+{ TreeNode * t = newExpNode(model->kind.exp);
+  if (t == NULL) return NULL;
+  t->lineno = lineno;
+  t->type = model->type;
+  if (model->kind.exp == ConstK) t->attr.val = model->attr.val;
+  else t->attr.name = model->attr.name;
+  return t;
+}
+
+static TreeNode * newOp( TokenType op, TreeNode * p1, TreeNode * p2,
+                         int lineno)
+{ TreeNode * t = newExpNode(OpK);
+  if (t == NULL) return NULL;
+  t->lineno = lineno;
+  t->type = Integer;
+  t->attr.op = op;
+  t->child[0] = p1;
+  t->child[1] = p2;
+  return t;
+}
+
+/* Function basicStep returns TRUE if statement s is
+ * i := i + c, c + i or i - c for a constant c, and
+ * stores c (negated for -) in *step. A char wraps
+ * around at 256, so it never counts
+ */
+static int basicStep( TreeNode * s, int * step)
+{ TreeNode * e;
+  char * name;
+  if ((s->nodekind != StmtK) || (s->kind.stmt != AssignK) ||
+      (s->child[1] != NULL))
+    return FALSE;
+  name = s->attr.name;
+  if (st_isByte(st_lookup(name))) return FALSE;
+  e = s->child[0];
+  if ((e->kind.exp != OpK) || (e->child[0] == NULL) || (e->child[1] == NULL))
+    return FALSE;
+  if ((e->attr.op == PLUS) && isId(e->child[0],name) &&
+      (e->child[1]->kind.exp == ConstK))
+  { *step = e->child[1]->attr.val;
+    return TRUE;
+  }
+  if ((e->attr.op == PLUS) && isId(e->child[1],name) &&
+      (e->child[0]->kind.exp == ConstK))
+  { *step = e->child[0]->attr.val;
+    return TRUE;
+  }
+  if ((e->attr.op == MINUS) && isId(e->child[0],name) &&
+      (e->child[1]->kind.exp == ConstK))
+    return evalOp(MINUS,0,e->child[1]->attr.val,step);
+  return FALSE;
+}
+
+/* Function derivedFactor returns the factor k if
+ * statement s is y := i * k or y := k * i with k
+ * invariant in loop and y not a char, and NULL
+ * otherwise
+ */
+static TreeNode * derivedFactor( TreeNode * s, char * iv, TreeNode * loop)
+{ TreeNode * e;
+  if ((s->nodekind != StmtK) || (s->kind.stmt != AssignK) ||
+      (s->child[1] != NULL) || (strcmp(s->attr.name,iv) == 0) ||
+      st_isByte(st_lookup(s->attr.name)))
+    return NULL;
+  e = s->child[0];
+  if ((e->kind.exp != OpK) || (e->attr.op != TIMES)) return NULL;
+  if (isId(e->child[0],iv) && isInvariant(e->child[1],loop) &&
+      !isId(e->child[1],s->attr.name))
+    return e->child[1];
+  if (isId(e->child[1],iv) && isInvariant(e->child[0],loop) &&
+      !isId(e->child[0],s->attr.name))
+    return e->child[0];
+  return NULL;
+}
+
+/* Function reduceDerived tries to turn derived
+ * induction variable definition s (y := i * k) in
+ * the body of the loop at *pp into a running
+ * addition. i steps by step in the body, and
+ * incFirst tells whether its increment comes before
+ * s in the body. Returns TRUE if it did
+ */
+static int reduceDerived( TreeNode ** pp, TreeNode * s, TreeNode * k,
+                          int step, int incFirst)
+{ TreeNode * loop = *pp, * p, * pre, * e;
+  TokenType op;
+  int lineno = s->lineno, val;
+  char * y = s->attr.name;
+  /* y must be set only here, and not be read in the
+     body before this point on the first iteration */
+  if (countDefs(loop->child[0],y) != 1) return FALSE;
+  for (p=loop->child[0];p != s;p = p->sibling)
+    if (stmtUses(p,y) > 0) return FALSE;
+  /* the step of y is step * k */
+  if (k->kind.exp == ConstK)
+  { evalOp(TIMES,step,k->attr.val,&val);
+    op = PLUS;
+    e = newExpNode(ConstK);
+    if (e == NULL) return FALSE;
+    e->lineno = lineno;
+    e->type = Integer;
+    e->attr.val = val;
+  }
+  else if ((step == 1) || (step == -1))
+  { op = (step == 1) ? PLUS : MINUS;
+    e = newLeaf(k,lineno);
+    if (e == NULL) return FALSE;
+  }
+  else return FALSE;
+  /* before the loop: y := i * k, less one step of y
+     if s runs before i is stepped */
+  pre = newStmtNode(AssignK);
+  if (pre == NULL) return FALSE;
+  pre->lineno = lineno;
+  pre->attr.name = y;
+  pre->child[0] = newOp(TIMES,newLeaf(s->child[0]->child[0],lineno),
+                        newLeaf(s->child[0]->child[1],lineno),lineno);
+  if (! incFirst)
+    pre->child[0] = newOp((op == PLUS) ? MINUS : PLUS,pre->child[0],
+                          newLeaf(e,lineno),lineno);
+  pre->sibling = loop;
+  *pp = pre;
+  /* in the loop: y := y + step * k */
+  p = newExpNode(IdK);
+  if (p == NULL) return FALSE;
+  p->lineno = lineno;
+  p->type = Integer;
+  p->attr.name = y;
+  s->child[0] = newOp(op,p,e,lineno);
+  reduced++;
+  return TRUE;
+}
+
+/* Procedure replaceTest rewrites the exit test of
+ * the loop i = n (n constant) into one on derived
+ * induction variable y = i * k and drops the step of
+ * i, when i is not needed otherwise. k must be an
+ * odd constant so that multiplying by it (modulo
+ * the word size) keeps = intact. preUses is the
+ * number of reads of i in the statements put in
+ * front of the loop
+ */
+static void replaceTest( TreeNode * loop, TreeNode * inc, int step,
+                         TreeNode * s, TreeNode * k, int incFirst,
+                         int preUses, int nested)
+{ TreeNode * test = loop->child[1], * n, ** pp;
+  char * iv = inc->attr.name;
+  int val, stepk;
+  if (nested || (test->kind.exp != OpK) || (test->attr.op != EQ)) return;
+  if (isId(test->child[0],iv) && (test->child[1]->kind.exp == ConstK))
+    n = test->child[1];
+  else if (isId(test->child[1],iv) && (test->child[0]->kind.exp == ConstK))
+    n = test->child[0];
+  else return;
+  if ((k->kind.exp != ConstK) || ((k->attr.val & 1) == 0)) return;
+  /* i must be read only by its own step and the
+     test, and elsewhere only to start y off */
+  if (countUses(loop->child[0],iv) + countUses(loop->child[1],iv) != 2)
+    return;
+  if (countUses(program->child[1],iv) != 2 + preUses) return;
+  /* y at the test is i * k, or one step less */
+  evalOp(TIMES,n->attr.val,k->attr.val,&val);
+  evalOp(TIMES,step,k->attr.val,&stepk);
+  if (! incFirst) evalOp(MINUS,val,stepk,&val);
+  n->attr.val = val;
+  if (test->child[0] == n) test->child[1]->attr.name = s->attr.name;
+  else test->child[0]->attr.name = s->attr.name;
+  /* unlink the step of i from the body */
+  for (pp = &loop->child[0];*pp != inc;pp = &(*pp)->sibling)
+    ;
+  *pp = inc->sibling;
+  retested++;
+}
+
+/* Function reduceLoop looks for induction variables
+ * in repeat statement loop, which follows *start in
+ * its statement sequence. A basic induction variable
+ * i is stepped by a constant once per iteration at
+ * the top level of the body, and set nowhere else in
+ * the loop. Returns TRUE if it reduced a derived
+ * induction variable
+ */
+static int reduceLoop( TreeNode ** start, TreeNode * loop, int nested)
+{ TreeNode * inc, * s, * k, ** pp, * p;
+  int step, incFirst, preUses;
+  for (inc=loop->child[0];inc != NULL;inc = inc->sibling)
+  { if (! basicStep(inc,&step)) continue;
+    if (countDefs(loop->child[0],inc->attr.name) != 1) continue;
+    incFirst = FALSE;
+    for (s=loop->child[0];s != NULL;s = s->sibling)
+    { if (s == inc)
+      { incFirst = TRUE;
+        continue;
+      }
+      k = derivedFactor(s,inc->attr.name,loop);
+      if (k == NULL) continue;
+      for (pp = start;*pp != loop;pp = &(*pp)->sibling)
+        ;
+      if (! reduceDerived(pp,s,k,step,incFirst)) continue;
+      preUses = 0;
+      for (p = *start;p != loop;p = p->sibling)
+        preUses += countUses(p->child[0],inc->attr.name);
+      replaceTest(loop,inc,step,s,k,incFirst,preUses,nested);
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+/* Procedure reduceStmts handles every loop in the
+ * statement sequence at *pp, innermost loops first
+ */
+static void reduceStmts( TreeNode ** pp, int nested)
+{ while (*pp != NULL)
+  { TreeNode * t = *pp;
+    if (t->nodekind == StmtK)
+    { if ((t->kind.stmt == IfK) || (t->kind.stmt == CaseK))
+      { reduceStmts(&t->child[1],nested);
+        reduceStmts(&t->child[2],nested);
+      }
+      else if (t->kind.stmt == ArmK)
+        reduceStmts(&t->child[1],nested);
+      else if (t->kind.stmt == RepeatK)
+      { reduceStmts(&t->child[0],TRUE);
+        while (reduceLoop(pp,t,nested))
+          ;
+        /* skip the statements put in front of it */
+        while (*pp != t) pp = &(*pp)->sibling;
+      }
+      else if (t->kind.stmt == WhileK)
+        reduceStmts(&t->child[1],TRUE);
+      else if (t->kind.stmt == ForK)
+        reduceStmts(&t->child[2],TRUE);
+    }
+    pp = &(*pp)->sibling;
+  }
+}
+
+/* Function strengthReduce replaces multiplications
+ * of induction variables by loop invariants with
+ * running additions, and rewrites exit tests to use
+ * them. It returns the number of changes
+ */
+int strengthReduce( TreeNode * syntaxTree)
+{ if ((syntaxTree == NULL) || (syntaxTree->nodekind != ProgK)) return 0;
+  program = syntaxTree;
+  reduced = retested = 0;
+  reduceStmts(&syntaxTree->child[1],FALSE);
+  if (TraceOptimize)
+    fprintf(listing,"Strength reduction: %d multiplications, %d exit tests\n",
+            reduced,retested);
+  return reduced + retested;
+}
+
+/* isInvariantExp is TRUE if expression t reads no
+   variable that loop sets (an array element is
+   never taken to be invariant) */
+static int isInvariantExp( TreeNode * t, TreeNode * loop)
+{ if (t == NULL) return TRUE;
+  if (t->kind.exp == OpK)
+    return isInvariantExp(t->child[0],loop) &&
+           isInvariantExp(t->child[1],loop);
+  return isInvariant(t,loop);
+}
+
+static int sameExp( TreeNode * a, TreeNode * b)
+{ if ((a == NULL) || (b == NULL)) return a == b;
+  if (a->kind.exp != b->kind.exp) return FALSE;
+  switch (a->kind.exp)
+  { case ConstK : return a->attr.val == b->attr.val;
+    case IdK : return strcmp(a->attr.name,b->attr.name) == 0;
+    case IndexK : return FALSE; /* memory may have changed */
+    default :
+      return (a->attr.op == b->attr.op) &&
+             sameExp(a->child[0],b->child[0]) &&
+             sameExp(a->child[1],b->child[1]);
+  }
+}
+
+/* Procedure insertBefore puts statement s right in
+ * front of loop in the sequence that starts at *start
+ */
+static void insertBefore( TreeNode ** start, TreeNode * loop, TreeNode * s)
+{ TreeNode ** pp;
+  for (pp = start;*pp != loop;pp = &(*pp)->sibling)
+    ;
+  s->sibling = loop;
+  *pp = s;
+}
+
+/* Procedure hoistExp replaces each largest invariant
+ * operator subtree of the expression at *tp by a
+ * temporary that is set in front of the loop. The
+ * same expression hoisted twice shares one temporary.
+ * Comparisons and and, or and not stay put, so
+ * tests keep their fused branches, and nothing that
+ * may trap is moved
+ */
+static void hoistExp( TreeNode ** tp, TreeNode ** start, TreeNode * loop)
+{ TreeNode * t = *tp, * p, * s;
+  char * name = NULL;
+  if ((t != NULL) && (t->kind.exp == IndexK))
+    hoistExp(&t->child[0],start,loop);
+  if ((t == NULL) || (t->kind.exp != OpK)) return;
+  if ((t->attr.op == LT) || (t->attr.op == EQ) || (t->attr.op == AND) ||
+      (t->attr.op == OR) || (t->attr.op == NOT) ||
+      !isInvariantExp(t,loop) || mayTrap(t))
+  { hoistExp(&t->child[0],start,loop);
+    hoistExp(&t->child[1],start,loop);
+    return;
+  }
+  /* everything set in front of the loop keeps its
+     value while the loop runs */
+  for (p = *start;p != loop;p = p->sibling)
+    if ((p->kind.stmt == AssignK) && (p->child[1] == NULL) &&
+        sameExp(p->child[0],t))
+      name = p->attr.name;
+  if (name == NULL)
+  { name = st_temp(t->lineno,IntK);
+    s = newStmtNode(AssignK);
+    if ((name == NULL) || (s == NULL)) return;
+    s->lineno = t->lineno;
+    s->attr.name = name;
+    s->child[0] = t;
+    insertBefore(start,loop,s);
+  }
+  p = newExpNode(IdK);
+  if (p == NULL) return;
+  p->lineno = t->lineno;
+  p->type = t->type;
+  p->attr.name = name;
+  *tp = p;
+  hoisted++;
+}
+
+/* Procedure hoistStmts hoists invariant expressions
+ * out of the statement sequence t inside loop
+ */
+static void hoistStmts( TreeNode * t, TreeNode ** start, TreeNode * loop)
+{ for (;t != NULL;t = t->sibling)
+    switch (t->kind.stmt)
+    { case IfK :
+      case CaseK :
+        hoistExp(&t->child[0],start,loop);
+        hoistStmts(t->child[1],start,loop);
+        hoistStmts(t->child[2],start,loop);
+        break;
+      case ArmK :
+        hoistStmts(t->child[1],start,loop);
+        break;
+      case RepeatK :
+        hoistStmts(t->child[0],start,loop);
+        hoistExp(&t->child[1],start,loop);
+        break;
+      case WhileK :
+        hoistExp(&t->child[0],start,loop);
+        hoistStmts(t->child[1],start,loop);
+        break;
+      case ForK :
+        hoistExp(&t->child[0],start,loop);
+        hoistExp(&t->child[1],start,loop);
+        hoistStmts(t->child[2],start,loop);
+        break;
+      case AssignK :
+        hoistExp(&t->child[1],start,loop);
+        hoistExp(&t->child[0],start,loop);
+        break;
+      case ReadK :
+      case WriteK :
+        hoistExp(&t->child[0],start,loop);
+        break;
+      default :
+        break;
+    }
+}
+
+/* Function moveAssign moves one assignment x := e
+ * (not to an array element) out of the loop that
+ * follows *start, if it is at the top level of the
+ * body, e is invariant and
+ * cannot trap, x is set nowhere else in the loop,
+ * and x is not read in the body before it (the body
+ * always runs, so x gets the same value either way).
+ * Returns TRUE if it moved one
+ */
+static int moveAssign( TreeNode ** start, TreeNode * loop)
+{ TreeNode ** pp, * s, * p;
+  for (pp = &loop->child[0];(s = *pp) != NULL;pp = &s->sibling)
+  { if ((s->kind.stmt != AssignK) || (s->child[1] != NULL) ||
+        !isInvariantExp(s->child[0],loop) ||
+        mayTrap(s->child[0]) || (countDefs(loop->child[0],s->attr.name) != 1))
+      continue;
+    for (p = loop->child[0];p != s;p = p->sibling)
+      if (stmtUses(p,s->attr.name) > 0) break;
+    if (p != s) continue;
+    /* leave a body behind; an empty repeat does not parse
+       and code generation expects one statement */
+    if ((s == loop->child[0]) && (s->sibling == NULL)) continue;
+    *pp = s->sibling;
+    insertBefore(start,loop,s);
+    moved++;
+    return TRUE;
+  }
+  return FALSE;
+}
+
+/* Procedure hoistLoops moves loop invariant code out
+ * of every loop in the statement sequence at *pp,
+ * innermost loops first. The body of a while or for
+ * loop may not run at all, so only expressions that
+ * cannot trap leave it, never whole assignments
+ */
+static void hoistLoops( TreeNode ** pp)
+{ while (*pp != NULL)
+  { TreeNode * t = *pp;
+    if (t->nodekind == StmtK)
+    { if ((t->kind.stmt == IfK) || (t->kind.stmt == CaseK))
+      { hoistLoops(&t->child[1]);
+        hoistLoops(&t->child[2]);
+      }
+      else if (t->kind.stmt == ArmK)
+        hoistLoops(&t->child[1]);
+      else if (t->kind.stmt == RepeatK)
+      { hoistLoops(&t->child[0]);
+        while (moveAssign(pp,t))
+          ;
+        hoistStmts(t->child[0],pp,t);
+        hoistExp(&t->child[1],pp,t);
+        /* skip the statements put in front of it */
+        while (*pp != t) pp = &(*pp)->sibling;
+      }
+      else if (t->kind.stmt == WhileK)
+      { hoistLoops(&t->child[1]);
+        hoistStmts(t->child[1],pp,t);
+        hoistExp(&t->child[0],pp,t);
+        while (*pp != t) pp = &(*pp)->sibling;
+      }
+      else if (t->kind.stmt == ForK)
+      { hoistLoops(&t->child[2]);
+        hoistStmts(t->child[2],pp,t);
+        while (*pp != t) pp = &(*pp)->sibling;
+      }
+    }
+    pp = &(*pp)->sibling;
+  }
+}
+
+/* Function hoistInvariants moves computations whose
+ * value does not change in a loop in front of it.
+ * It returns the number of changes
+ */
+int hoistInvariants( TreeNode * syntaxTree)
+{ if ((syntaxTree == NULL) || (syntaxTree->nodekind != ProgK)) return 0;
+  hoisted = moved = 0;
+  hoistLoops(&syntaxTree->child[1]);
+  if (TraceOptimize)
+    fprintf(listing,"Loop invariant code motion: %d expressions, "
+            "%d assignments\n",hoisted,moved);
+  return hoisted + moved;
+}
+
+/* Function checkSize returns the number of TM
+ * instructions of the bounds checks of array
+ * access t
+ */
+static int checkSize( TreeNode * t)
+{ return ((t->check & CHECKLOW) ? 2 : 0) + ((t->check & CHECKHIGH) ? 3 : 0);
+}
+
+/* Function codeSize estimates the number of TM
+ * instructions of t and its siblings
+ */
+int codeSize( TreeNode * t)
+{ TreeNode * p;
+  int n = 0;
+  for (;t != NULL;t = t->sibling)
+    if (t->nodekind == StmtK)
+      switch (t->kind.stmt)
+      { case IfK :
+          n += codeSize(t->child[0]) + codeSize(t->child[1]) +
+               codeSize(t->child[2]) + 2;
+          break;
+        case CaseK :
+          n += codeSize(t->child[0]) + codeSize(t->child[1]) +
+               codeSize(t->child[2]) + 1;
+          break;
+        case ArmK :
+          /* a test and a jump per label at most, and
+             the jump out of the arm */
+          n += codeSize(t->child[1]) + 1;
+          for (p=t->child[0];p != NULL;p = p->sibling) n += 2;
+          break;
+        case RepeatK :
+          n += codeSize(t->child[0]) + codeSize(t->child[1]) + 1;
+          break;
+        case WhileK :
+          n += codeSize(t->child[0]) + codeSize(t->child[1]) + 2;
+          break;
+        case ForK :
+          n += codeSize(t->child[0]) + codeSize(t->child[1]) +
+               codeSize(t->child[2]) + 5;
+          break;
+        case ReadK :
+          n += 2;
+          if (t->child[0] != NULL)
+            n += codeSize(t->child[0]) + checkSize(t);
+          break;
+        case CallK :
+          /* the return address and the jump */
+          n += 2;
+          break;
+        default :
+          n += codeSize(t->child[0]) + codeSize(t->child[1]) + 1;
+          if (t->child[1] != NULL) n += checkSize(t);
+          break;
+      }
+    else if (t->kind.exp == OpK)
+      n += codeSize(t->child[0]) + codeSize(t->child[1]) +
+           (((t->attr.op == LT) || (t->attr.op == EQ)) ? 4 :
+            (t->attr.op == NOT) ? 0 : 1);
+    else if (t->kind.exp == IndexK)
+      n += codeSize(t->child[0]) + checkSize(t) + 1;
+    else n++;
+  return n;
+}
+
+/* Function lastOf returns the last statement of
+ * the sequence t
+ */
+static TreeNode * lastOf( TreeNode * t)
+{ while (t->sibling != NULL) t = t->sibling;
+  return t;
+}
+
+/* Function copies returns n copies of statement
+ * sequence body chained together, the last one
+ * being body itself, or NULL if memory runs out
+ */
+static TreeNode * copies( TreeNode * body, int n)
+{ TreeNode * first = body, * c;
+  while (--n > 0)
+  { c = copyTree(body);
+    if (c == NULL) return NULL;
+    lastOf(c)->sibling = first;
+    first = c;
+  }
+  return first;
+}
+
+/* Function defines is TRUE if statement t (not its
+ * siblings) assigns, reads or counts variable name
+ */
+static int defines( TreeNode * t, char * name)
+{ int i;
+  if (((t->kind.stmt == AssignK) || (t->kind.stmt == ReadK) ||
+       (t->kind.stmt == ForK)) &&
+      (strcmp(t->attr.name,name) == 0))
+    return TRUE;
+  if (countDefs(calledBody(t),name) > 0) return TRUE;
+  for (i=0;i<MAXCHILDREN;i++)
+    if (countDefs(t->child[i],name) > 0) return TRUE;
+  return FALSE;
+}
+
+/* Function testVar returns the variable the
+ * expression t reads, or NULL if it reads none or
+ * more than one
+ */
+static char * testVar( TreeNode * t)
+{ char * a, * b;
+  if (t->kind.exp == IdK) return t->attr.name;
+  if (t->kind.exp != OpK) return NULL;
+  a = testVar(t->child[0]);
+  if (t->attr.op == NOT) return a;
+  b = testVar(t->child[1]);
+  if (a == NULL) return (t->child[0]->kind.exp == ConstK) ? b : NULL;
+  if (b == NULL) return (t->child[1]->kind.exp == ConstK) ? a : NULL;
+  return (strcmp(a,b) == 0) ? a : NULL;
+}
+
+/* Function evalTest evaluates expression t with
+ * variable iv set to val, like the machine would
+ */
+static int evalTest( TreeNode * t, char * iv, int val, int * result)
+{ int a, b;
+  switch (t->kind.exp)
+  { case ConstK :
+      *result = t->attr.val;
+      return TRUE;
+    case IdK :
+      *result = val;
+      return TRUE;
+    default :
+      if (t->attr.op == NOT)
+        return evalTest(t->child[0],iv,val,&a) && evalOp(NOT,a,a,result);
+      return evalTest(t->child[0],iv,val,&a) &&
+             evalTest(t->child[1],iv,val,&b) &&
+             evalOp(t->attr.op,a,b,result);
+  }
+}
+
+/* Function tripCount returns the number of times
+ * the body of loop runs, or 0 if it is not known.
+ * It must be a counter that starts out as a constant
+ * before the loop in the sequence at start (or is
+ * still 0 in the program's own sequence), is stepped
+ * by a constant once on every iteration, and is the
+ * only variable the until test reads
+ */
+static int tripCount( TreeNode * start, TreeNode * loop, int top)
+{ char * iv = testVar(loop->child[1]);
+  TreeNode * s, * init = NULL;
+  int val = 0, step, t, r;
+  if ((iv == NULL) || (countDefs(loop->child[0],iv) != 1)) return 0;
+  for (s=loop->child[0];s != NULL;s = s->sibling)
+    if ((s->nodekind == StmtK) && (s->kind.stmt == AssignK) &&
+        (strcmp(s->attr.name,iv) == 0))
+      break;
+  if ((s == NULL) || !basicStep(s,&step) || (step == 0)) return 0;
+  for (s=start;s != loop;s = s->sibling)
+    if ((s->nodekind == StmtK) && defines(s,iv)) init = s;
+  if (init != NULL)
+  { if ((init->kind.stmt != AssignK) || (init->child[0]->kind.exp != ConstK))
+      return 0;
+    val = init->child[0]->attr.val;
+  }
+  else if (! top) return 0;
+  for (t=1;t<=MAXTRIP;t++)
+  { evalOp(PLUS,val,step,&val);
+    if (! evalTest(loop->child[1],iv,val,&r)) return 0;
+    if (r) return t;
+  }
+  return 0;
+}
+
+/* Function unrollLoop unrolls loop, the statement
+ * at *pp in the sequence at start, if its trip count
+ * is known and the budget allows. It returns the
+ * last statement of what took the loop's place, or
+ * NULL if it was left alone
+ */
+static TreeNode * unrollLoop( TreeNode ** pp, TreeNode * start, int top)
+{ TreeNode * loop = *pp, * body = loop->child[0], * pre, * c, * last;
+  int n = tripCount(start,loop,top), size, grow, k, r;
+  if ((n == 0) || (body == NULL)) return NULL;
+  size = codeSize(body);
+  grow = (n-1) * size - codeSize(loop->child[1]) - 1;
+  if ((n <= MAXFULL) && (grow <= budget))
+  { /* the test is false until the last time round,
+       so the loop becomes n copies of its body */
+    c = copies(body,n);
+    if (c == NULL) return NULL;
+    budget -= grow;
+    last = lastOf(body);
+    last->sibling = loop->sibling;
+    *pp = c;
+    unrolled++;
+    return last;
+  }
+  /* otherwise k bodies run between two tests, after
+     the n mod k iterations that do not fill a group */
+  for (k=UnrollFactor;(k > 1) && ((n % k + k - 1) * size > budget);k--)
+    ;
+  if ((k < 2) || (n < 2 * k)) return NULL;
+  r = n % k;
+  pre = (r > 0) ? copies(copyTree(body),r) : NULL;
+  c = copies(body,k);
+  if ((c == NULL) || ((r > 0) && (pre == NULL))) return NULL;
+  budget -= (r + k - 1) * size;
+  loop->child[0] = c;
+  if (pre != NULL)
+  { lastOf(pre)->sibling = loop;
+    *pp = pre;
+  }
+  partial++;
+  return loop;
+}
+
+/* Function newStep returns the statement i := i + 1
+ * stepping the variable of for loop
+ */
+static TreeNode * newStep( TreeNode * loop)
+{ TreeNode * s = newStmtNode(AssignK), * i = newExpNode(IdK),
+           * one = newExpNode(ConstK);
+  if ((s == NULL) || (i == NULL) || (one == NULL)) return NULL;
+  s->lineno = i->lineno = one->lineno = loop->lineno;
+  s->attr.name = i->attr.name = loop->attr.name;
+  i->type = one->type = Integer;
+  one->attr.val = 1;
+  s->child[0] = newOp(PLUS,i,one,loop->lineno);
+  return s;
+}
+
+/* Function unrollFor unrolls for loop, the
+ * statement at *pp, if its bounds are constants and
+ * the budget allows: completely into copies of its
+ * body each followed by the step of its variable,
+ * or else into a repeat loop going through
+ * UnrollFactor such copies between two tests. It
+ * returns the last statement of what took the
+ * loop's place, or NULL if it was left alone
+ */
+static TreeNode * unrollFor( TreeNode ** pp)
+{ TreeNode * loop = *pp, * body = loop->child[2], * init, * step, * c,
+           * pre, * rep, * test, * i, * n1;
+  int n, size, grow, k, r, last;
+  if ((body == NULL) || (loop->child[0]->kind.exp != ConstK) ||
+      (loop->child[1]->kind.exp != ConstK))
+    return NULL;
+  evalOp(MINUS,loop->child[1]->attr.val,loop->child[0]->attr.val,&n);
+  if ((n < 0) || (n >= MAXTRIP)) return NULL;
+  n++;
+  size = codeSize(body) + 1;
+  grow = n * size + 1 - codeSize(loop);
+  if ((n <= MAXFULL) && (grow <= budget))
+  { init = newStmtNode(AssignK);
+    step = newStep(loop);
+    if ((init == NULL) || (step == NULL)) return NULL;
+    lastOf(body)->sibling = step;
+    c = copies(body,n);
+    if (c == NULL) return NULL;
+    init->lineno = loop->lineno;
+    init->attr.name = loop->attr.name;
+    init->child[0] = loop->child[0];
+    init->sibling = c;
+    step->sibling = loop->sibling;
+    *pp = init;
+    budget -= grow;
+    unrolled++;
+    return step;
+  }
+  /* the repeat loop tests for one past the last
+     value, which a char never gets to if it wraps */
+  if (st_isByte(st_lookup(loop->attr.name))) return NULL;
+  for (k=UnrollFactor;(k > 1) && ((n % k + k) * size > budget);k--)
+    ;
+  if ((k < 2) || (n < 2 * k)) return NULL;
+  init = newStmtNode(AssignK);
+  step = newStep(loop);
+  rep = newStmtNode(RepeatK);
+  i = newExpNode(IdK);
+  n1 = newExpNode(ConstK);
+  if ((init == NULL) || (step == NULL) || (rep == NULL) || (i == NULL) ||
+      (n1 == NULL))
+    return NULL;
+  lastOf(body)->sibling = step;
+  r = n % k;
+  pre = (r > 0) ? copies(copyTree(body),r) : NULL;
+  c = copies(body,k);
+  test = newOp(EQ,i,n1,loop->lineno);
+  if ((c == NULL) || ((r > 0) && (pre == NULL)) || (test == NULL))
+    return NULL;
+  /* the variable is one past the last value when
+     the loop is done */
+  i->lineno = n1->lineno = loop->lineno;
+  i->attr.name = loop->attr.name;
+  i->type = n1->type = Integer;
+  evalOp(PLUS,loop->child[1]->attr.val,1,&last);
+  n1->attr.val = last;
+  test->type = Boolean;
+  rep->lineno = init->lineno = loop->lineno;
+  rep->child[0] = c;
+  rep->child[1] = test;
+  rep->sibling = loop->sibling;
+  init->attr.name = loop->attr.name;
+  init->child[0] = loop->child[0];
+  if (pre != NULL)
+  { init->sibling = pre;
+    lastOf(pre)->sibling = rep;
+  }
+  else init->sibling = rep;
+  *pp = init;
+  budget -= (r + k) * size;
+  partial++;
+  return rep;
+}
+
+/* Procedure unrollStmts unrolls the repeat and for
+ * loops of the statement sequence at start,
+ * innermost loops first; top is TRUE for the
+ * sequence of the program itself
+ */
+static void unrollStmts( TreeNode ** start, int top)
+{ TreeNode ** pp = start, * t, * last;
+  while ((t = *pp) != NULL)
+  { if (t->nodekind == StmtK)
+    { if ((t->kind.stmt == IfK) || (t->kind.stmt == CaseK))
+      { unrollStmts(&t->child[1],FALSE);
+        unrollStmts(&t->child[2],FALSE);
+      }
+      else if (t->kind.stmt == ArmK)
+        unrollStmts(&t->child[1],FALSE);
+      else if (t->kind.stmt == RepeatK)
+      { unrollStmts(&t->child[0],FALSE);
+        last = unrollLoop(pp,*start,top);
+        if (last != NULL)
+        { pp = &last->sibling;
+          continue;
+        }
+      }
+      else if (t->kind.stmt == WhileK)
+        unrollStmts(&t->child[1],FALSE);
+      else if (t->kind.stmt == ForK)
+      { unrollStmts(&t->child[2],FALSE);
+        last = unrollFor(pp);
+        if (last != NULL)
+        { pp = &last->sibling;
+          continue;
+        }
+      }
+    }
+    pp = &t->sibling;
+  }
+}
+
+/* Function unrollLoops unrolls repeat and for loops
+ * whose trip count is known at compile time: completely
+ * if they are short, and otherwise UnrollFactor
+ * times, as long as the program stays within the
+ * instruction memory of the machine. It returns the
+ * number of loops unrolled
+ */
+int unrollLoops( TreeNode * syntaxTree)
+{ TreeNode * d;
+  if ((syntaxTree == NULL) || (syntaxTree->nodekind != ProgK)) return 0;
+  unrolled = partial = 0;
+  budget = CODEBUDGET - codeSize(syntaxTree->child[1]);
+  /* the procedures take room as well */
+  for (d=syntaxTree->child[0];d != NULL;d = d->sibling)
+    if (d->kind.decl == ProcK) budget -= codeSize(d->child[1]) + PROCSIZE;
+  unrollStmts(&syntaxTree->child[1],TRUE);
+  if (TraceOptimize)
+    fprintf(listing,"Loop unrolling: %d loops completely, %d partly\n",
+            unrolled,partial);
+  return unrolled + partial;
+}
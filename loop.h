@@ -0,0 +1,37 @@
+/****************************************************/
+/* File: loop.h                                     */
+/* Loop optimization interface for the TINY         */
+/* compiler                                         */
+/****************************************************/
+
+#ifndef _LOOP_H_
+#define _LOOP_H_
+
+/* Function strengthReduce replaces multiplications
+ * of induction variables by loop invariants with
+ * running additions, and rewrites exit tests to use
+ * them. It returns the number of changes
+ */
+int strengthReduce(TreeNode * syntaxTree);
+
+/* Function hoistInvariants moves computations whose
+ * value does not change in a repeat loop in front of
+ * it. It returns the number of changes
+ */
+int hoistInvariants(TreeNode * syntaxTree);
+
+/* Function unrollLoops unrolls repeat loops whose
+ * trip count is known at compile time, completely
+ * or UnrollFactor times, within the instruction
+ * memory of the machine. It returns the number of
+ * loops unrolled
+ */
+int unrollLoops(TreeNode * syntaxTree);
+
+/* Function codeSize estimates the number of TM
+ * instructions of the statements or expression t
+ * and its siblings
+ */
+int codeSize(TreeNode * t);
+
+#endif
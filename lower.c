@@ -0,0 +1,1367 @@
+/****************************************************/
+/* File: lower.c                                    */
+/* Translation of the intermediate code into TM     */
+/* code for the TINY compiler                       */
+/****************************************************/
+
+#include <limits.h>
+#include "globals.h"
+#include "symtab.h"
+#include "code.h"
+#include "pass.h"
+#include "ir.h"
+#include "lower.h"
+
+/* MAXDEPTH caps the loop nesting used for weights */
+#define MAXDEPTH 4
+
+/* The function is taken out of SSA form by putting
+ * a copy for every phi at the end of each
+ * predecessor (edges from a block with several
+ * successors into a block with phis are split first, so the
+ * copies only run on their own edge). Values are then
+ * given the registers FIRSTREG..LASTREG by colouring
+ * their interference graph in order of weight, copies
+ * preferring a common register so that they vanish;
+ * values that do not fit live in data memory above the
+ * variables. A value used only by the very next
+ * instruction is passed in ac, constants are loaded
+ * where they are used, and a comparison used only by
+ * the branch ending its block becomes the jump itself
+ */
+
+static IrFunc * f;
+static int nvals;
+
+/* the registers a procedure saves in its frame,
+   one bit each */
+static int saved;
+
+/* the first data memory location not taken by the
+   variables or the values of the functions done so
+   far: a procedure may run while any of them is
+   live, so their values get locations of their own */
+static int spillBase;
+
+/* per value */
+static int * reg;     /* register, or -1 */
+static int * slot;    /* memory location if not in a register */
+static int * inAc;    /* passed to the next instruction in ac */
+static int * fused;   /* comparison done by the branch */
+static int * homed;   /* needs a register or memory location */
+static int * nuses;
+static int * weight;
+
+/* sets of values, one bit each */
+typedef unsigned int * Set;
+static int nwords;
+
+/* the interference graph, one set per value */
+static Set adj;
+
+static void * getMem( int n, int size)
+{ void * p = calloc(n > 0 ? n : 1,size);
+  if (p == NULL)
+  { fprintf(listing,"Out of memory error in intermediate code\n");
+    exit(1);
+  }
+  return p;
+}
+
+static int inSet( Set s, int v)
+{ return (s[v / 32] >> (v % 32)) & 1;
+}
+
+static void addSet( Set s, int v)
+{ s[v / 32] |= 1u << (v % 32);
+}
+
+static void delSet( Set s, int v)
+{ s[v / 32] &= ~(1u << (v % 32));
+}
+
+static int loopWeight( int depth)
+{ int w = 1;
+  if (depth > MAXDEPTH) depth = MAXDEPTH;
+  while (depth-- > 0) w *= 10;
+  return w;
+}
+
+static int hasPhis( IrBlock * b)
+{ return (b->first != NULL) && (b->first->op == IrPhi);
+}
+
+/********************************************/
+/* leaving SSA form                         */
+/********************************************/
+
+static void appendCopy( IrBlock * b, int dst, int src)
+{ IrInstr * i = irNewInstr(f,IrCopy,dst,1,0);
+  i->args[0] = src;
+  i->val = TRUE;
+  irAppend(b,i);
+}
+
+/* Procedure leaveSSA replaces the phis by copies
+ * at the end of the predecessors. The copies ending a
+ * block are done all at once, so they are only put
+ * in sequence once their values have homes
+ */
+static void leaveSSA(void)
+{ int k, s, p, nblocks = f->nblocks;
+  IrInstr * i, * next;
+  for (k=0;k<nblocks;k++)
+  { IrBlock * b = f->blocks[k];
+    if (b->nsuccs < 2) continue;
+    for (s=0;s<b->nsuccs;s++)
+      if (hasPhis(b->succ[s])) irSplitEdge(f,b,b->succ[s]);
+  }
+  irComputeOrder(f);
+  for (k=0;k<f->nblocks;k++)
+  { IrBlock * b = f->blocks[k];
+    if (! hasPhis(b)) continue;
+    for (p=0;p<b->npreds;p++)
+      forInstr(i,b)
+        if ((i->op == IrPhi) && (i->args[p] != i->dst))
+          appendCopy(b->preds[p],i->dst,i->args[p]);
+    for (i=b->first;(i != NULL) && (i->op == IrPhi);i = next)
+    { next = i->next;
+      irRemove(f,i);
+    }
+  }
+  f->ssa = FALSE;
+}
+
+/********************************************/
+/* choosing where values live               */
+/********************************************/
+
+/* Function nextReal returns the instruction after
+ * i that produces code (constants produce none)
+ */
+static IrInstr * nextReal( IrInstr * i)
+{ for (i=i->next;(i != NULL) && (i->op == IrConst);i = i->next)
+    ;
+  return i;
+}
+
+static int usesValue( IrInstr * i, int v)
+{ int k;
+  for (k=0;k<i->nargs;k++)
+    if (i->args[k] == v) return TRUE;
+  return FALSE;
+}
+
+/* Function armCopy returns the copy of block a, an
+ * arm of a branch, if that is all a does besides
+ * naming constants; otherwise it returns NULL
+ */
+static IrInstr * armCopy( IrBlock * a)
+{ IrInstr * i, * c = NULL;
+  if ((a->npreds != 1) || (a->term != IrJump)) return NULL;
+  forInstr(i,a)
+    if ((i->op == IrCopy) && (c == NULL)) c = i;
+    else if (i->op != IrConst) return NULL;
+  return c;
+}
+
+/* Function canSpeculate is TRUE if copy c ending an
+ * arm of the branch ending block b can be done in b,
+ * before the branch, where o is the other arm: the
+ * branch and o must not read its destination, and o
+ * must give it a value of its own
+ */
+static int canSpeculate( IrBlock * b, IrBlock * o, IrInstr * c)
+{ IrInstr * i;
+  int v = c->dst, writes = FALSE;
+  if ((o->npreds != 1) || (o->term != IrJump) ||
+      (o->succ[0] != c->block->succ[0]) || (b->cond == v))
+    return FALSE;
+  forInstr(i,o)
+  { if (usesValue(i,v)) return FALSE;
+    if (i->dst == v) writes = TRUE;
+  }
+  i = f->def[b->cond];
+  return writes && ((i == NULL) || !usesValue(i,v));
+}
+
+/* Procedure ifConvert turns a branch whose arms both
+ * end in a copy to the same value into a one-armed
+ * one, by making one of the copies ahead of the
+ * branch and letting the other overwrite it. TM has
+ * no conditional move, so that is as close to a
+ * branch-free select as it gets: the emptied arm
+ * needs no jump to the join, which makes up for the
+ * copy the other arm does in vain. Only an arm doing
+ * a single copy is worth it; the likely successor is
+ * tried first, as its path gets shorter
+ */
+static void ifConvert(void)
+{ int k, s, n = 0;
+  IrInstr * c, * i, * next;
+  for (k=0;k<f->nblocks;k++)
+  { IrBlock * b = f->blocks[k];
+    if ((b->term != IrBranch) || (b->succ[0] == b->succ[1])) continue;
+    for (s=0;s<2;s++)
+    { IrBlock * a = b->succ[(s == 0) ? b->likely : 1 - b->likely];
+      c = armCopy(a);
+      if ((c == NULL) || !canSpeculate(b,b->succ[0] == a ? b->succ[1] :
+                                       b->succ[0],c))
+        continue;
+      for (i=a->first;i != NULL;i = next)
+      { int defines = (i->dst >= 0) && (f->def[i->dst] == i);
+        next = i->next;
+        irRemove(f,i);
+        irAppend(b,i);
+        if (defines) f->def[i->dst] = i;
+      }
+      c->val = FALSE;
+      n++;
+      break;
+    }
+  }
+  if (TraceOptimize)
+    fprintf(listing,"If-conversion: %d branches converted\n",n);
+}
+
+/* Procedure classify decides which values are
+ * passed in ac, which comparisons become jumps and
+ * which values need a home
+ */
+static void classify(void)
+{ int k, j, v;
+  IrInstr * i, * n;
+  for (k=0;k<f->nblocks;k++)
+  { IrBlock * b = f->blocks[k];
+    forInstr(i,b)
+      for (j=0;j<i->nargs;j++) nuses[i->args[j]]++;
+    if ((b->term == IrBranch) || (b->term == IrSwitch)) nuses[b->cond]++;
+  }
+  for (k=0;k<f->nblocks;k++)
+  { IrBlock * b = f->blocks[k];
+    if (b->term != IrBranch) continue;
+    v = b->cond;
+    i = f->def[v];
+    if ((i != NULL) && (i->block == b) && (nuses[v] == 1) &&
+        ((i->op == IrLt) || (i->op == IrEq)))
+    { /* nothing in a block ending in a branch
+         redefines a value, so the comparison can
+         move next to the jump */
+      irRemove(f,i);
+      irAppend(b,i);
+      f->def[v] = i;
+      fused[v] = TRUE;
+    }
+  }
+  for (k=0;k<f->nblocks;k++)
+  { IrBlock * b = f->blocks[k];
+    forInstr(i,b)
+    { v = i->dst;
+      if ((v < 0) || (i->op == IrConst) || (i->op == IrCopy) || fused[v] ||
+          (nuses[v] != 1))
+        continue;
+      n = nextReal(i);
+      if (n != NULL)
+        inAc[v] = (n->op != IrCopy) && usesValue(n,v);
+      else
+        inAc[v] = ((b->term == IrBranch) || (b->term == IrSwitch)) &&
+                  (b->cond == v);
+    }
+  }
+  for (k=0;k<f->nblocks;k++)
+    forInstr(i,f->blocks[k])
+    { v = i->dst;
+      if ((v >= 0) && (i->op != IrConst) && !inAc[v] && !fused[v] &&
+          (nuses[v] > 0))
+        homed[v] = TRUE;
+    }
+}
+
+/* Function isParallel is TRUE for one of the
+ * copies ending a block that are done all at once
+ */
+static int isParallel( IrInstr * i)
+{ return (i->op == IrCopy) && i->val;
+}
+
+/* Function groupStart returns the first of the
+ * copies done at once with copy i
+ */
+static IrInstr * groupStart( IrInstr * i)
+{ while ((i->prev != NULL) && isParallel(i->prev)) i = i->prev;
+  return i;
+}
+
+static int isGroupDst( IrInstr * g, int v)
+{ for (;g != NULL;g = g->next)
+    if (g->dst == v) return TRUE;
+  return FALSE;
+}
+
+/* Procedure throughGroup turns the values live
+ * after the copies starting at g into those live
+ * before them
+ */
+static void throughGroup( IrInstr * g, Set live)
+{ IrInstr * c;
+  for (c=g;c != NULL;c = c->next) delSet(live,c->dst);
+  for (c=g;c != NULL;c = c->next)
+    if (homed[c->args[0]]) addSet(live,c->args[0]);
+}
+
+/* Procedure interfere builds the interference graph
+ * of the homed values from their liveness, and
+ * weighs each value by its uses and definitions
+ */
+static void interfere(void)
+{ Set * in = (Set *) getMem(f->nblocks,sizeof(Set));
+  Set * out = (Set *) getMem(f->nblocks,sizeof(Set));
+  Set live = (Set) getMem(nwords,sizeof(unsigned int));
+  int k, j, w, v, x, changed;
+  IrInstr * i;
+  for (k=0;k<f->nblocks;k++)
+  { in[k] = (Set) getMem(nwords,sizeof(unsigned int));
+    out[k] = (Set) getMem(nwords,sizeof(unsigned int));
+  }
+  /* live values at block boundaries */
+  do
+  { changed = FALSE;
+    for (k=f->nblocks-1;k>=0;k--)
+    { IrBlock * b = f->blocks[k];
+      int s;
+      for (j=0;j<nwords;j++) live[j] = 0;
+      for (s=0;s<b->nsuccs;s++)
+        for (j=0;j<nwords;j++) live[j] |= in[b->succ[s]->order][j];
+      for (j=0;j<nwords;j++) out[k][j] = live[j];
+      if (((b->term == IrBranch) || (b->term == IrSwitch)) && homed[b->cond])
+        addSet(live,b->cond);
+      for (i=b->last;i != NULL;i = i->prev)
+      { if (isParallel(i))
+        { i = groupStart(i);
+          throughGroup(i,live);
+          continue;
+        }
+        if (i->dst >= 0) delSet(live,i->dst);
+        for (j=0;j<i->nargs;j++)
+          if (homed[i->args[j]]) addSet(live,i->args[j]);
+      }
+      for (j=0;j<nwords;j++)
+        if (live[j] != in[k][j])
+        { in[k][j] = live[j];
+          changed = TRUE;
+        }
+    }
+  } while (changed);
+  /* a definition interferes with everything live
+     after it, except the source of a copy */
+  for (k=0;k<f->nblocks;k++)
+  { IrBlock * b = f->blocks[k];
+    w = loopWeight(b->depth);
+    for (j=0;j<nwords;j++) live[j] = out[k][j];
+    if (((b->term == IrBranch) || (b->term == IrSwitch)) && homed[b->cond])
+    { addSet(live,b->cond);
+      weight[b->cond] += w;
+    }
+    for (i=b->last;i != NULL;i = i->prev)
+    { if (isParallel(i))
+      { IrInstr * c;
+        i = groupStart(i);
+        for (c=i;c != NULL;c = c->next)
+        { v = c->dst;
+          if (! homed[v]) continue;
+          weight[v] += w;
+          if (homed[c->args[0]]) weight[c->args[0]] += w;
+          /* the source may share the register unless
+             the group gives it a new value */
+          for (x=0;x<nvals;x++)
+            if (inSet(live,x) && (x != v) &&
+                ((x != c->args[0]) || isGroupDst(i,x)))
+            { addSet(adj + v*nwords,x);
+              addSet(adj + x*nwords,v);
+            }
+        }
+        throughGroup(i,live);
+        continue;
+      }
+      v = i->dst;
+      if ((v >= 0) && homed[v])
+      { weight[v] += w;
+        for (x=0;x<nvals;x++)
+          if (inSet(live,x) && (x != v) &&
+              !((i->op == IrCopy) && (x == i->args[0])))
+          { addSet(adj + v*nwords,x);
+            addSet(adj + x*nwords,v);
+          }
+        delSet(live,v);
+      }
+      for (j=0;j<i->nargs;j++)
+        if (homed[i->args[j]])
+        { addSet(live,i->args[j]);
+          weight[i->args[j]] += w;
+        }
+    }
+  }
+  for (k=0;k<f->nblocks;k++)
+  { free(in[k]);
+    free(out[k]);
+  }
+  free(in);
+  free(out);
+  free(live);
+}
+
+/* copies are coalesced into classes of values that
+   share a home; root[v] leads to the class of v */
+static int * root;
+
+static int findRoot( int v)
+{ while (root[v] != v) v = root[v] = root[root[v]];
+  return v;
+}
+
+/* a copy and how much it is worth removing */
+typedef struct
+   { IrInstr * copy;
+     int weight;
+   } CopyRec;
+
+static int byCopyWeight( const void * a, const void * b)
+{ return ((const CopyRec *) b)->weight - ((const CopyRec *) a)->weight;
+}
+
+/* Procedure coalesce merges the values of every
+ * copy that do not interfere into one class, the
+ * most often executed copies first. Among those,
+ * copies carrying a value around a loop go first,
+ * so the values they join keep one register for the
+ * whole loop
+ */
+static void coalesce(void)
+{ CopyRec * copies;
+  int n = 0, k, j, a, b, x;
+  IrInstr * i;
+  for (k=0;k<f->nblocks;k++)
+    forInstr(i,f->blocks[k])
+      if (i->op == IrCopy) n++;
+  copies = (CopyRec *) getMem(n,sizeof(CopyRec));
+  n = 0;
+  for (k=0;k<f->nblocks;k++)
+  { IrBlock * b = f->blocks[k];
+    int back = (b->term == IrJump) && (b->succ[0]->order <= b->order);
+    forInstr(i,b)
+      if ((i->op == IrCopy) && homed[i->dst] && homed[i->args[0]])
+      { copies[n].copy = i;
+        copies[n++].weight = 2 * loopWeight(b->depth) + back;
+      }
+  }
+  qsort(copies,n,sizeof(CopyRec),byCopyWeight);
+  for (k=0;k<n;k++)
+  { a = findRoot(copies[k].copy->dst);
+    b = findRoot(copies[k].copy->args[0]);
+    if ((a == b) || inSet(adj + a*nwords,b)) continue;
+    root[b] = a;
+    weight[a] += weight[b];
+    for (j=0;j<nwords;j++) adj[a*nwords+j] |= adj[b*nwords+j];
+    for (x=0;x<nvals;x++)
+      if (inSet(adj + b*nwords,x)) addSet(adj + x*nwords,a);
+  }
+  free(copies);
+}
+
+static int byWeight( const void * a, const void * b)
+{ int x = *(const int *) a, y = *(const int *) b;
+  if (weight[x] != weight[y]) return weight[y] - weight[x];
+  return x - y;
+}
+
+/* Function partner returns the register (or, if
+ * memory is TRUE, the memory location) of a value
+ * v is copied to or from that is free in used[], or
+ * -1 if there is none
+ */
+static int partner( int v, int * used, int memory)
+{ int k, j, w;
+  IrInstr * i;
+  for (k=0;k<f->nblocks;k++)
+    forInstr(i,f->blocks[k])
+    { if (i->op != IrCopy) continue;
+      if (i->dst == v) w = i->args[0];
+      else if (i->args[0] == v) w = i->dst;
+      else continue;
+      if (! homed[w]) continue;
+      w = findRoot(w);
+      j = memory ? ((reg[w] < 0) ? slot[w] : -1) : reg[w];
+      if ((j >= 0) && !used[j]) return j;
+    }
+  return -1;
+}
+
+/* Procedure assignHomes colours the interference
+ * graph with the registers, heaviest values first,
+ * and then gives the values left over locations in
+ * data memory the same way
+ */
+static void assignHomes(void)
+{ int * order = (int *) getMem(nvals,sizeof(int));
+  int base = spillBase;
+  int * used = (int *) getMem(base + nvals + LASTREG + 1,sizeof(int));
+  int n = 0, k, v, x, r;
+  for (v=0;v<nvals;v++)
+    if (homed[v] && (findRoot(v) == v)) order[n++] = v;
+  qsort(order,n,sizeof(int),byWeight);
+  for (k=0;k<n;k++)
+  { v = order[k];
+    for (r=0;r<=LASTREG;r++) used[r] = (r < FIRSTREG);
+    for (x=0;x<nvals;x++)
+      if (inSet(adj + v*nwords,x) && (reg[findRoot(x)] >= 0))
+        used[reg[findRoot(x)]] = TRUE;
+    r = partner(v,used,FALSE);
+    if (r < 0)
+      for (r=FIRSTREG;(r <= LASTREG) && used[r];r++)
+        ;
+    reg[v] = (r <= LASTREG) ? r : -1;
+  }
+  for (k=0;k<n;k++)
+  { v = order[k];
+    if (reg[v] >= 0) continue;
+    for (r=0;r<base+nvals;r++) used[r] = (r < base);
+    for (x=0;x<nvals;x++)
+      if (inSet(adj + v*nwords,x) && (slot[findRoot(x)] >= 0))
+        used[slot[findRoot(x)]] = TRUE;
+    r = partner(v,used,TRUE);
+    if (r < 0)
+      for (r=base;used[r];r++)
+        ;
+    slot[v] = r;
+  }
+  saved = 0;
+  for (v=0;v<nvals;v++)
+    if (homed[v])
+    { reg[v] = reg[findRoot(v)];
+      slot[v] = slot[findRoot(v)];
+      if (reg[v] >= 0) saved |= 1 << reg[v];
+      if (slot[v] >= spillBase) spillBase = slot[v] + 1;
+    }
+  free(order);
+  free(used);
+}
+
+/* registers are locations 0..pc; memory location
+   m is location MEMLOC+m */
+#define MEMLOC 8
+
+static int locOf( int v)
+{ return (reg[v] >= 0) ? reg[v] : MEMLOC + slot[v];
+}
+
+/* Procedure dropMoves removes the copies whose
+ * value already is where it is copied to, and the
+ * instructions whose value is never used
+ */
+static void dropMoves(void)
+{ int k, v, w;
+  IrInstr * i, * next;
+  for (k=0;k<f->nblocks;k++)
+    for (i=f->blocks[k]->first;i != NULL;i = next)
+    { next = i->next;
+      v = i->dst;
+      if ((v < 0) || (i->op == IrConst)) continue;
+      if ((nuses[v] == 0) && !inAc[v] && !irHasEffect(f,i))
+        irRemove(f,i);
+      else if ((i->op == IrCopy) && homed[w = i->args[0]] &&
+               (locOf(v) == locOf(w)))
+        irRemove(f,i);
+    }
+}
+
+/********************************************/
+/* emitting TM code                         */
+/********************************************/
+
+/* location of each block's code, by order */
+static int * start;
+
+/* a forward jump waiting for its target */
+typedef struct PatchRec
+   { int loc;
+     char * op;
+     int r;
+     IrBlock * to;
+     struct PatchRec * next;
+   } * PatchList;
+
+static PatchList patches = NULL;
+
+/* a switch whose jump table waits for the code of
+   its successors; loc is where the address of the
+   table is taken */
+typedef struct SwitchRec
+   { int loc;
+     IrBlock * b;
+     struct SwitchRec * next;
+   } * SwitchList;
+
+static SwitchList switches = NULL;
+
+/* a call waiting for the entry of the procedure */
+typedef struct CallRec
+   { int loc;
+     int proc;
+     struct CallRec * next;
+   } * CallList;
+
+static CallList calls = NULL;
+
+/* Function skipped is TRUE for a block whose only
+ * code would be a jump to its successor
+ */
+static int skipped( IrBlock * b)
+{ IrInstr * i;
+  if ((b->order == 0) || (b->term != IrJump)) return FALSE;
+  forInstr(i,b)
+    if (i->op != IrConst) return FALSE;
+  return TRUE;
+}
+
+/* Function dest returns the block whose code a jump
+ * to b really goes to
+ */
+static IrBlock * dest( IrBlock * b)
+{ int n = 0;
+  while (skipped(b) && (n++ < f->nblocks)) b = b->succ[0];
+  return b;
+}
+
+/* Function following returns the block whose code
+ * comes after that of block k
+ */
+static IrBlock * following( int k)
+{ for (k=k+1;k<f->nblocks;k++)
+    if (! skipped(f->blocks[k])) return f->blocks[k];
+  return NULL;
+}
+
+static void emitJump( char * op, int r, IrBlock * to)
+{ if (start[to->order] >= 0)
+    emitRM_Abs(op,r,start[to->order],"jump to block");
+  else
+  { PatchList p = (PatchList) getMem(1,sizeof(struct PatchRec));
+    p->loc = emitSkip(1);
+    p->op = op;
+    p->r = r;
+    p->to = to;
+    p->next = patches;
+    patches = p;
+  }
+}
+
+/* Function fetch returns the register holding
+ * value v, loading it into register scratch first if
+ * it is a constant or lives in memory
+ */
+static int fetch( int v, int scratch)
+{ int c;
+  if (inAc[v]) return ac;
+  if (irIsConst(f,v,&c))
+  { emitRM("LDC",scratch,c,0,"load const");
+    return scratch;
+  }
+  if (reg[v] >= 0) return reg[v];
+  emitRM("LD",scratch,slot[v],gp,"load value from memory");
+  return scratch;
+}
+
+/* Function target returns the register value v is
+ * computed into
+ */
+static int target( int v)
+{ if ((v >= 0) && homed[v] && (reg[v] >= 0)) return reg[v];
+  return ac;
+}
+
+/* Procedure store puts value v, computed into
+ * register r, into its memory location if it has one
+ */
+static void store( int v, int r)
+{ if ((v >= 0) && homed[v] && (reg[v] < 0))
+    emitRM("ST",r,slot[v],gp,"store value to memory");
+}
+
+/* Function scratch0 returns the register the first
+ * operand of i may be loaded into
+ */
+static int scratch0( IrInstr * i)
+{ return ((i->nargs > 1) && inAc[i->args[1]]) ? ac1 : ac;
+}
+
+/* Function genDiff emits the code of comparison i
+ * up to the difference of its operands, and returns
+ * the register that holds the difference
+ */
+static int genDiff( IrInstr * i)
+{ int a = i->args[0], b = i->args[1], c, r1, r2;
+  if ((i->op == IrEq) && irIsConst(f,a,&c) && !irIsConst(f,b,&c))
+  { a = b;
+    b = i->args[0];
+  }
+  if (irIsConst(f,b,&c) && (c == 0)) return fetch(a,ac);
+  if (irIsConst(f,b,&c) && (c != INT_MIN))
+  { r1 = fetch(a,ac);
+    emitRM("LDA",ac,-c,r1,"op: compare with constant");
+    return ac;
+  }
+  r1 = fetch(a,scratch0(i));
+  r2 = fetch(b,ac1);
+  emitRO("SUB",ac,r1,r2,"op: compare");
+  return ac;
+}
+
+/* Procedure genMove copies location s (or constant
+ * c if s is -1) to location d
+ */
+static void genMove( int d, int s, int c)
+{ if (s < 0)
+  { if (d < MEMLOC) emitRM("LDC",d,c,0,"copy const");
+    else
+    { emitRM("LDC",ac1,c,0,"load const");
+      emitRM("ST",ac1,d-MEMLOC,gp,"copy const to memory");
+    }
+  }
+  else if (d < MEMLOC)
+  { if (s < MEMLOC) emitRM("LDA",d,0,s,"copy");
+    else emitRM("LD",d,s-MEMLOC,gp,"copy from memory");
+  }
+  else if (s < MEMLOC) emitRM("ST",s,d-MEMLOC,gp,"copy to memory");
+  else
+  { emitRM("LD",ac1,s-MEMLOC,gp,"copy from memory");
+    emitRM("ST",ac1,d-MEMLOC,gp,"copy to memory");
+  }
+}
+
+/* Procedure genGroup emits the copies done at once
+ * starting at g: a copy waits until nothing still
+ * needs the old contents of its destination, and a
+ * cycle is broken by saving one of them in ac
+ */
+static void genGroup( IrInstr * g)
+{ IrInstr * c;
+  int n = 0, k, j, left = 0, progress, blocked;
+  int * dst, * src, * val, * done;
+  for (c=g;c != NULL;c = c->next) n++;
+  dst = (int *) getMem(n,sizeof(int));
+  src = (int *) getMem(n,sizeof(int));
+  val = (int *) getMem(n,sizeof(int));
+  done = (int *) getMem(n,sizeof(int));
+  for (k=0,c=g;c != NULL;k++,c = c->next)
+  { dst[k] = locOf(c->dst);
+    src[k] = irIsConst(f,c->args[0],&val[k]) ? -1 : locOf(c->args[0]);
+    if (dst[k] == src[k]) done[k] = TRUE;
+    else left++;
+  }
+  while (left > 0)
+  { progress = FALSE;
+    for (k=0;k<n;k++)
+    { if (done[k]) continue;
+      blocked = FALSE;
+      for (j=0;j<n;j++)
+        if (!done[j] && (j != k) && (src[j] == dst[k])) blocked = TRUE;
+      if (blocked) continue;
+      genMove(dst[k],src[k],val[k]);
+      done[k] = TRUE;
+      left--;
+      progress = TRUE;
+    }
+    if (! progress)
+    { for (k=0;done[k];k++)
+        ;
+      genMove(ac,dst[k],0);
+      for (j=0;j<n;j++)
+        if (!done[j] && (src[j] == dst[k])) src[j] = ac;
+    }
+  }
+  free(dst);
+  free(src);
+  free(val);
+  free(done);
+}
+
+/* Procedure genInstr emits the code of instruction i */
+static void genInstr( IrInstr * i)
+{ int v = i->dst, t = target(i->dst), c, r, r1, r2;
+  char * jump, * op;
+  switch (i->op)
+  { case IrConst :
+      break;
+    case IrCopy :
+      if (irIsConst(f,i->args[0],&c))
+        emitRM("LDC",t,c,0,"copy const");
+      else
+      { r = fetch(i->args[0],t);
+        if (r != t) emitRM("LDA",t,0,r,"copy");
+      }
+      store(v,t);
+      break;
+    case IrAdd :
+    case IrSub :
+      /* a constant addend goes into LDA */
+      if (irIsConst(f,i->args[1],&c) &&
+          ((i->op == IrAdd) || (c != INT_MIN)))
+      { r = fetch(i->args[0],ac);
+        emitRM("LDA",t,(i->op == IrAdd) ? c : -c,r,"op: add constant");
+        store(v,t);
+        break;
+      }
+      if ((i->op == IrAdd) && irIsConst(f,i->args[0],&c))
+      { r = fetch(i->args[1],ac);
+        emitRM("LDA",t,c,r,"op: add constant");
+        store(v,t);
+        break;
+      }
+      /* fall through */
+    case IrMul :
+    case IrDiv :
+      r1 = fetch(i->args[0],scratch0(i));
+      r2 = fetch(i->args[1],ac1);
+      emitRO((i->op == IrAdd) ? "ADD" : (i->op == IrSub) ? "SUB" :
+             (i->op == IrMul) ? "MUL" : "DIV",t,r1,r2,"op");
+      store(v,t);
+      break;
+    case IrLt :
+    case IrEq :
+      if (fused[v]) break;
+      r = genDiff(i);
+      jump = (i->op == IrLt) ? "JLT" : "JEQ";
+      /* turn the difference into 0 or 1 */
+      if (r != t)
+      { emitRM("LDC",t,1,0,"true case");
+        emitRM(jump,r,1,pc,"skip if true");
+        emitRM("LDC",t,0,0,"false case");
+      }
+      else
+      { emitRM(jump,t,2,pc,"br if true");
+        emitRM("LDC",t,0,0,"false case");
+        emitRM("LDA",pc,1,pc,"unconditional jmp");
+        emitRM("LDC",t,1,0,"true case");
+      }
+      store(v,t);
+      break;
+    case IrIn :
+      emitRO("IN",t,0,0,"read integer value");
+      store(v,t);
+      break;
+    case IrOut :
+      emitRO("OUT",fetch(i->args[0],ac),0,0,"write value");
+      break;
+    case IrLoad :
+      op = st_isByte(i->val) ? "LDB" : "LD";
+      if (irIsConst(f,i->args[0],&c))
+        emitRM(op,t,st_addr(i->val)+c,gp,"load array element");
+      else
+        emitRM(op,t,st_addr(i->val),fetch(i->args[0],t),"load array element");
+      store(v,t);
+      break;
+    case IrStore :
+      op = st_isByte(i->val) ? "STB" : "ST";
+      if (irIsConst(f,i->args[0],&c))
+      { r1 = gp;
+        c += st_addr(i->val);
+        r2 = fetch(i->args[1],ac);
+      }
+      else
+      { c = st_addr(i->val);
+        r1 = fetch(i->args[0],scratch0(i));
+        r2 = fetch(i->args[1],ac1);
+      }
+      emitRM(op,r2,c,r1,"store array element");
+      break;
+    case IrCheckLow :
+      /* a failed check stores to address -1, which
+         stops the machine with a data memory fault */
+      r = fetch(i->args[0],ac);
+      emitRM("JGE",r,1,pc,"check: index >= 0");
+      emitRM("ST",r,-1,gp,"check: index out of bounds");
+      break;
+    case IrCheckHigh :
+      r = fetch(i->args[0],ac);
+      emitRM("LDA",ac,-i->val,r,"check: index - size");
+      emitRM("JLT",ac,1,pc,"check: index < size");
+      emitRM("ST",ac,-1,gp,"check: index out of bounds");
+      break;
+    case IrCall :
+      /* the return address is passed in ac */
+      emitRM("LDA",ac,1,pc,"call: return address");
+      { CallList l = (CallList) getMem(1,sizeof(struct CallRec));
+        l->loc = emitSkip(1);
+        l->proc = i->val;
+        l->next = calls;
+        calls = l;
+      }
+      break;
+    default :
+      emitComment("BUG: phi left in code");
+      break;
+  }
+}
+
+/* Procedure genEntry emits the start of a
+ * procedure: the return address and the registers
+ * it uses go to a frame on the mp stack
+ */
+static void genEntry(void)
+{ int r, n = 0;
+  emitRM("ST",ac,0,mp,"procedure: save return address");
+  for (r=FIRSTREG;r<=LASTREG;r++)
+    if (saved & (1 << r)) emitRM("ST",r,-(++n),mp,"procedure: save register");
+  emitRM("LDA",mp,-(n+1),mp,"procedure: push frame");
+}
+
+/* Procedure genReturn emits the end of a
+ * procedure, undoing genEntry
+ */
+static void genReturn(void)
+{ int r, n = 0;
+  for (r=FIRSTREG;r<=LASTREG;r++)
+    if (saved & (1 << r)) n++;
+  emitRM("LDA",mp,n+1,mp,"procedure: pop frame");
+  n = 0;
+  for (r=FIRSTREG;r<=LASTREG;r++)
+    if (saved & (1 << r)) emitRM("LD",r,-(++n),mp,"procedure: restore register");
+  emitRM("LD",pc,0,mp,"procedure: return");
+}
+
+/* Procedure genTerm emits the code ending block b,
+ * where next is the block whose code follows
+ */
+static void genTerm( IrBlock * b, IrBlock * next)
+{ IrBlock * t, * e;
+  char * jt, * jf;
+  int r, v;
+  switch (b->term)
+  { case IrJump :
+      t = dest(b->succ[0]);
+      if (t != next) emitJump("LDA",pc,t);
+      break;
+    case IrBranch :
+      v = b->cond;
+      if (fused[v])
+      { r = genDiff(f->def[v]);
+        jt = (f->def[v]->op == IrLt) ? "JLT" : "JEQ";
+        jf = (f->def[v]->op == IrLt) ? "JGE" : "JNE";
+      }
+      else
+      { r = fetch(v,ac);
+        jt = "JNE";
+        jf = "JEQ";
+      }
+      t = dest(b->succ[0]);
+      e = dest(b->succ[1]);
+      if (t == e)
+      { if (t != next) emitJump("LDA",pc,t);
+      }
+      else if (e == next) emitJump(jt,r,t);
+      else if (t == next) emitJump(jf,r,e);
+      else
+      { emitJump(jt,r,t);
+        emitJump("LDA",pc,e);
+      }
+      break;
+    case IrSwitch :
+      /* the selector less the lowest label indexes
+         the jump table if it is in range */
+      r = fetch(b->cond,ac);
+      e = dest(b->succ[0]);
+      emitRM("LDA",ac1,-b->low,r,"switch: selector - lowest label");
+      emitJump("JLT",ac1,e);
+      emitRM("LDA",ac,-b->ntable,ac1,"switch: past the table?");
+      emitJump("JGE",ac,e);
+      { SwitchList w = (SwitchList) getMem(1,sizeof(struct SwitchRec));
+        w->loc = emitSkip(1);
+        w->b = b;
+        w->next = switches;
+        switches = w;
+      }
+      emitRO("ADD",ac,ac,ac1,"switch: table entry");
+      emitRM("LDA",pc,0,ac,"switch: jmp through table");
+      break;
+    default :
+      if (f->procName == NULL) emitRO("HALT",0,0,0,"");
+      else genReturn();
+      break;
+  }
+}
+
+/* Procedure rotateLoops moves the test of each
+ * loop that has it at the top (a block ending in a
+ * branch into the block after it, whose end jumps
+ * back to the test) to after the body. The loop is
+ * then entered by a jump to the test, and each time
+ * round takes the branch back alone. Only the
+ * layout changes, so the order is no longer reverse
+ * postorder afterwards
+ */
+static void rotateLoops(void)
+{ int k = 0, j, l;
+  while (k < f->nblocks)
+  { IrBlock * b = f->blocks[k], * in, * out;
+    l = -1;
+    if ((b->term == IrBranch) && (k+1 < f->nblocks))
+    { in = f->blocks[k+1];
+      out = (b->succ[0] == in) ? b->succ[1] : b->succ[0];
+      /* the end of the loop is the one block after
+         the test that comes back to it */
+      for (j=0;j<b->npreds;j++)
+        if (b->preds[j]->order > k)
+        { if ((l >= 0) || (b->preds[j]->term != IrJump)) break;
+          l = b->preds[j]->order;
+        }
+      if ((j < b->npreds) || ((b->succ[0] != in) && (b->succ[1] != in)) ||
+          ((out->order > k) && (out->order <= l)))
+        l = -1;
+    }
+    if (l < 0)
+    { k++;
+      continue;
+    }
+    for (j=k;j<l;j++)
+    { f->blocks[j] = f->blocks[j+1];
+      f->blocks[j]->order = j;
+    }
+    f->blocks[l] = b;
+    b->order = l;
+  }
+}
+
+/* Procedure genCode emits the blocks in order and
+ * then fills in the forward jumps and the jump
+ * tables of the switches
+ */
+static void genCode(void)
+{ int k, * to;
+  char buf[40];
+  PatchList p;
+  SwitchList w;
+  start = (int *) getMem(f->nblocks,sizeof(int));
+  for (k=0;k<f->nblocks;k++) start[k] = -1;
+  for (k=0;k<f->nblocks;k++)
+  { IrBlock * b = f->blocks[k];
+    IrInstr * i;
+    if (skipped(b)) continue;
+    start[k] = emitSkip(0);
+    if (TraceCode)
+    { sprintf(buf,"block B%d",b->id);
+      emitComment(buf);
+    }
+    forInstr(i,b)
+      if (isParallel(i))
+      { genGroup(i);
+        break;
+      }
+      else genInstr(i);
+    genTerm(b,following(k));
+  }
+  while ((p = patches) != NULL)
+  { emitBackup(p->loc);
+    emitRM_Abs(p->op,p->r,start[p->to->order],"jump to block");
+    emitRestore();
+    patches = p->next;
+    free(p);
+  }
+  while ((w = switches) != NULL)
+  { to = (int *) getMem(w->b->ntable,sizeof(int));
+    for (k=0;k<w->b->ntable;k++)
+      to[k] = start[dest(w->b->succ[w->b->table[k]])->order];
+    addJumpTable(w->loc,to,w->b->ntable);
+    free(to);
+    switches = w->next;
+    free(w);
+  }
+}
+
+/* Function relayout marks the successor each
+ * branch of f took more often as likely, count
+ * being the number of times each instruction ran.
+ * It returns the number of branches whose layout
+ * changes
+ */
+static int relayout( int * count)
+{ int * bcount, k, s, changed = 0;
+  bcount = (int *) getMem(f->nblocks,sizeof(int));
+  for (k=0;k<f->nblocks;k++)
+    bcount[k] = (start[k] >= 0) ? count[emitFinalLoc(start[k])] : -1;
+  /* an edge into a block with no other predecessor
+     ran as often as the block; the other edge of the
+     branch gets the rest */
+  for (k=0;k<f->nblocks;k++)
+  { IrBlock * b = f->blocks[k];
+    int edge[2], likely;
+    if ((b->term != IrBranch) || (dest(b->succ[0]) == dest(b->succ[1])) ||
+        (bcount[k] < 0))
+      continue;
+    for (s=0;s<2;s++)
+    { IrBlock * c = b->succ[s];
+      edge[s] = (!skipped(c) && (c->npreds == 1)) ? bcount[c->order] : -1;
+    }
+    if ((edge[0] < 0) && (edge[1] < 0)) continue;
+    for (s=0;s<2;s++)
+      if (edge[s] < 0) edge[s] = bcount[k] - edge[1-s];
+    likely = (edge[0] > edge[1]) ? 0 : 1;
+    if (likely != b->likely)
+    { b->likely = likely;
+      changed++;
+    }
+  }
+  free(bcount);
+  return changed;
+}
+
+/* Function readProfile reads the number of times
+ * each instruction of the code just generated ran
+ * from the profile file the TM simulator wrote. It
+ * returns NULL if there is no profile that matches
+ * the code, by the size and checksum of the code
+ * the profile heads its counts with
+ */
+static int * readProfile( char * codefile)
+{ char * name = getMem(strlen(codefile)+6,sizeof(char)), * dot;
+  FILE * prof;
+  int * count, size, loc, n;
+  unsigned sum;
+  strcpy(name,codefile);
+  dot = strrchr(name,'.');
+  if (dot != NULL) *dot = '\0';
+  strcat(name,".prof");
+  prof = fopen(name,"r");
+  if (prof == NULL)
+  { fprintf(listing,"Profile %s not found\n",name);
+    free(name);
+    return NULL;
+  }
+  size = emitFinalLoc(iCodeSize);
+  if ((fscanf(prof," code %d %u",&n,&sum) != 2) || (n != size) ||
+      (sum != emitChecksum()))
+  { fprintf(listing,"Profile %s does not match the code\n",name);
+    fclose(prof);
+    free(name);
+    return NULL;
+  }
+  count = (int *) getMem(size+1,sizeof(int));
+  while (fscanf(prof,"%d %d",&loc,&n) == 2)
+    if ((loc < 0) || (loc >= size) || (n < 0))
+    { fprintf(listing,"Profile %s does not match the code\n",name);
+      free(count);
+      count = NULL;
+      break;
+    }
+    else count[loc] += n;
+  fclose(prof);
+  free(name);
+  return count;
+}
+
+/* Procedure genPrelude emits the comments heading
+ * the code file, file being the one naming it, the
+ * standard prelude and the data section
+ */
+static void genPrelude( char * file)
+{ int a, w;
+  emitFunction("program");
+  emitComment("TINY Compilation to TM Code");
+  emitComment(file);
+  emitComment("Standard prelude:");
+  emitRM("LD",mp,0,ac,"load maxaddress from location 0");
+  /* location 0 holds the maxaddress until now, so
+     its initial value is stored here */
+  if ((w = st_initWord(0)) != 0)
+  { emitRM("LDC",ac1,w,0,"load initial value of location 0");
+    emitRM("ST",ac1,0,ac,"initialize location 0");
+  }
+  else emitRM("ST",ac,0,ac,"clear location 0");
+  for (a=1;a<st_datasize();a++)
+    if ((w = st_initWord(a)) != 0) emitData(a,w,"initial value");
+  emitComment("End of standard prelude.");
+}
+
+/* Procedure listHomes prints where the values live */
+static void listHomes(void)
+{ int v;
+  fprintf(listing,"\nValue locations:\n");
+  for (v=0;v<nvals;v++)
+  { if (! homed[v]) continue;
+    fprintf(listing,"  v%d",v);
+    if (f->name[v] != NULL) fprintf(listing," (%s)",f->name[v]);
+    if (reg[v] >= 0) fprintf(listing,": register %d\n",reg[v]);
+    else fprintf(listing,": memory %d\n",slot[v]);
+  }
+}
+
+/* what is kept of each function between choosing
+   homes for its values and emitting its code */
+typedef struct
+   { IrFunc * f;
+     int nvals, nwords, saved, entry;
+     int * reg, * slot, * inAc, * fused, * homed, * nuses, * weight,
+         * root, * start;
+     Set adj;
+   } FuncState;
+
+static FuncState * funcs = NULL;
+static int nfuncs = 0;
+
+/* Procedures saveFunc and loadFunc keep the state
+ * of function k and take it up again
+ */
+static void saveFunc( int k)
+{ FuncState * p = &funcs[k];
+  p->f = f; p->nvals = nvals; p->nwords = nwords; p->saved = saved;
+  p->reg = reg; p->slot = slot; p->inAc = inAc; p->fused = fused;
+  p->homed = homed; p->nuses = nuses; p->weight = weight;
+  p->root = root; p->start = start; p->adj = adj;
+}
+
+static void loadFunc( int k)
+{ FuncState * p = &funcs[k];
+  f = p->f; nvals = p->nvals; nwords = p->nwords; saved = p->saved;
+  reg = p->reg; slot = p->slot; inAc = p->inAc; fused = p->fused;
+  homed = p->homed; nuses = p->nuses; weight = p->weight;
+  root = p->root; start = p->start; adj = p->adj;
+}
+
+/* Procedure chooseHomes takes f out of SSA form
+ * and decides where its values live
+ */
+static void chooseHomes(void)
+{ int v;
+  leaveSSA();
+  if (OptLevel >= 2) ifConvert();
+  nvals = f->nvalues;
+  nwords = (nvals + 31) / 32;
+  reg = (int *) getMem(nvals,sizeof(int));
+  slot = (int *) getMem(nvals,sizeof(int));
+  inAc = (int *) getMem(nvals,sizeof(int));
+  fused = (int *) getMem(nvals,sizeof(int));
+  homed = (int *) getMem(nvals,sizeof(int));
+  nuses = (int *) getMem(nvals,sizeof(int));
+  weight = (int *) getMem(nvals,sizeof(int));
+  root = (int *) getMem(nvals,sizeof(int));
+  adj = (Set) getMem(nvals * nwords,sizeof(unsigned int));
+  start = NULL;
+  for (v=0;v<nvals;v++)
+  { reg[v] = slot[v] = -1;
+    root[v] = v;
+  }
+  classify();
+  if (! irVerify(f,"out-of-SSA translation")) Error = TRUE;
+  if (TraceIR)
+  { if (f->procName != NULL)
+      fprintf(listing,"\nProcedure %s:\n",f->procName);
+    fprintf(listing,"\nIntermediate code after out-of-SSA translation:\n");
+    irDump(f);
+  }
+  interfere();
+  coalesce();
+  assignHomes();
+  dropMoves();
+  if (TraceIR) listHomes();
+  rotateLoops();
+}
+
+/* Procedure genProgram emits the code of the
+ * functions, the main program first, each
+ * procedure framed by genEntry and genReturn,
+ * then the jump tables of the switches, and
+ * points the calls at the procedures; file names
+ * the code file
+ */
+static void genProgram( char * file)
+{ int k;
+  CallList l;
+  genPrelude(file);
+  for (k=0;k<nfuncs;k++)
+  { loadFunc(k);
+    if (f->procName != NULL)
+    { emitFunction(f->procName);
+      emitComment(f->procName);
+      funcs[k].entry = emitSkip(0);
+      genEntry();
+    }
+    free(start);
+    genCode();
+    if (k == 0) emitComment("End of execution.");
+    saveFunc(k);
+  }
+  emitJumpTables();
+  while ((l = calls) != NULL)
+  { if ((l->proc > 0) && (l->proc < nfuncs))
+    { emitBackup(l->loc);
+      emitRM_Abs("LDA",pc,funcs[l->proc].entry,"call: jmp to procedure");
+      emitRestore();
+    }
+    calls = l->next;
+    free(l);
+  }
+}
+
+/* Procedure irLower translates the n functions of
+ * funcs, the main program first and then the
+ * procedures in the order IrCall numbers them,
+ * into TM code written to the code file. The last
+ * parameter (codefile) is the file name of the code
+ * file, and is used to print the file name as a
+ * comment in the code file
+ */
+void irLower( IrFunc ** func, int n, char * codefile)
+{ char * s = malloc(strlen(codefile)+7);
+  int k, changed, * count;
+  strcpy(s,"File: ");
+  strcat(s,codefile);
+  nfuncs = n;
+  funcs = (FuncState *) getMem(n,sizeof(FuncState));
+  spillBase = st_datasize();
+  for (k=0;k<n;k++)
+  { f = func[k];
+    chooseHomes();
+    saveFunc(k);
+  }
+  genProgram(s);
+  /* clean up the buffered code and write it out */
+  runCodePasses();
+  /* the code is laid out as when the profile was
+     taken, so its counts can be matched to blocks */
+  if (ProfileUse && ((count = readProfile(codefile)) != NULL))
+  { changed = 0;
+    for (k=0;k<n;k++)
+    { loadFunc(k);
+      changed += relayout(count);
+    }
+    free(count);
+    if (TraceOptimize)
+      fprintf(listing,"Profile-guided layout: %d branches changed\n",changed);
+    if (changed > 0)
+    { emitReset();
+      for (k=0;k<n;k++)
+      { loadFunc(k);
+        irComputeOrder(f);
+        rotateLoops();
+        saveFunc(k);
+      }
+      genProgram(s);
+      runCodePasses();
+    }
+  }
+  emitFlush();
+  for (k=0;k<n;k++)
+  { loadFunc(k);
+    free(start);
+    free(reg);
+    free(slot);
+    free(inAc);
+    free(fused);
+    free(homed);
+    free(nuses);
+    free(weight);
+    free(root);
+    free(adj);
+  }
+  free(funcs);
+  free(s);
+}
@@ -0,0 +1,22 @@
+/****************************************************/
+/* File: lower.h                                    */
+/* Interface of the translation of the intermediate */
+/* code into TM code for the TINY compiler          */
+/****************************************************/
+
+#ifndef _LOWER_H_
+#define _LOWER_H_
+
+#include "ir.h"
+
+/* Procedure irLower translates the n functions of
+ * funcs, the main program first and then the
+ * procedures in the order IrCall numbers them,
+ * into TM code written to the code file. The last
+ * parameter (codefile) is the file name of the code
+ * file, and is used to print the file name as a
+ * comment in the code file
+ */
+void irLower(IrFunc ** funcs, int n, char * codefile);
+
+#endif
@@ -12,6 +12,17 @@
 /* set NO_ANALYZE to TRUE to get a parser-only compiler */
 #define NO_ANALYZE FALSE
 
+/* set NO_OPTIMIZE to TRUE to get a compiler that
+ * generates code straight from the checked tree
+ */
+#define NO_OPTIMIZE FALSE
+
+/* set NO_IR to TRUE to get a compiler that generates
+ * code by walking the syntax tree instead of going
+ * through the SSA intermediate code
+ */
+#define NO_IR FALSE
+
 /* set NO_CODE to TRUE to get a compiler that does not
  * generate code
  */
@@ -24,8 +35,16 @@
 #include "parse.h"
 #if !NO_ANALYZE
 #include "analyze.h"
+#include "pass.h"
 #if !NO_CODE
+#include "symtab.h"
+#include "code.h"
+#if NO_IR
 #include "cgen.h"
+#else
+#include "irgen.h"
+#include "lower.h"
+#endif
 #endif
 #endif
 #endif
@@ -42,17 +61,58 @@ int TraceScan = TRUE;
 int TraceParse = TRUE;
 int TraceAnalyze = TRUE;
 int TraceCode = TRUE;
+int TraceOptimize = TRUE;
+int TraceIR = TRUE;
+
+int OptLevel = 2;
+int OptSize = FALSE;
+int PassStats = FALSE;
+int EvalFuel = 100000;
+int ProfileUse = FALSE;
+int UnrollFactor = 4;
 
 int Error = FALSE;
 
+/* Procedure usage reports how to call the compiler
+ * and exits
+ */
+static void usage( char * name)
+{ fprintf(stderr,"usage: %s [-O0|-O1|-O2|-Os] [-fpass-stats] "
+          "[-feval-fuel=n] [-funroll-factor=n] [-fprofile-use] "
+          "<filename>\n",name);
+  exit(1);
+}
+
 main( int argc, char * argv[] )
 { TreeNode * syntaxTree;
   char pgm[120]; /* source code file name */
-  if (argc != 2)
-    { fprintf(stderr,"usage: %s <filename>\n",argv[0]);
-      exit(1);
+  char * file = NULL;
+  int k;
+  for (k=1;k<argc;k++)
+    if (argv[k][0] != '-')
+    { if (file != NULL) usage(argv[0]);
+      file = argv[k];
     }
-  strcpy(pgm,argv[1]) ;
+    else if ((argv[k][1] == 'O') && (argv[k][2] != '\0') &&
+             (argv[k][3] == '\0') && (strchr("012s",argv[k][2]) != NULL))
+    { OptSize = (argv[k][2] == 's');
+      OptLevel = OptSize ? 2 : argv[k][2] - '0';
+    }
+    else if (strcmp(argv[k],"-fpass-stats") == 0) PassStats = TRUE;
+    else if (strcmp(argv[k],"-fprofile-use") == 0) ProfileUse = TRUE;
+    else if (strncmp(argv[k],"-feval-fuel=",12) == 0)
+    { char * end;
+      EvalFuel = (int) strtol(argv[k]+12,&end,10);
+      if ((*end != '\0') || (EvalFuel < 0)) usage(argv[0]);
+    }
+    else if (strncmp(argv[k],"-funroll-factor=",16) == 0)
+    { char * end;
+      UnrollFactor = (int) strtol(argv[k]+16,&end,10);
+      if ((*end != '\0') || (UnrollFactor < 1)) usage(argv[0]);
+    }
+    else usage(argv[0]);
+  if (file == NULL) usage(argv[0]);
+  strcpy(pgm,file) ;
   if (strchr (pgm, '.') == NULL)
      strcat(pgm,".tny");
   source = fopen(pgm,"r");
@@ -78,6 +138,16 @@ main( int argc, char * argv[] )
     typeCheck(syntaxTree);
     if (TraceAnalyze) fprintf(listing,"\nType Checking Finished\n");
   }
+#if !NO_OPTIMIZE
+  if (! Error)
+  { if (TraceOptimize) fprintf(listing,"\nOptimizing...\n");
+    runTreePasses(syntaxTree);
+    if (TraceOptimize) {
+      fprintf(listing,"\nOptimized syntax tree:\n");
+      printTree(syntaxTree);
+    }
+  }
+#endif
 #if !NO_CODE
   if (! Error)
   { char * codefile;
@@ -90,12 +160,52 @@ main( int argc, char * argv[] )
     { printf("Unable to open %s\n",codefile);
       exit(1);
     }
-    codeGen(syntaxTree->child[1],codefile);
+#if NO_IR
+    codeGen(syntaxTree,codefile);
+#else
+    { /* the main program and each procedure left
+         after inlining become a function */
+      TreeNode * d, * p = NULL;
+      IrFunc ** funcs;
+      int n = 1, k;
+      for (d=syntaxTree->child[0];d != NULL;d = d->sibling)
+        if (d->kind.decl == ProcK) n++;
+      funcs = (IrFunc **) malloc(n * sizeof(IrFunc *));
+      if (funcs == NULL)
+      { fprintf(listing,"Out of memory error\n");
+        exit(1);
+      }
+      d = syntaxTree->child[0];
+      for (k=0;k<n;k++)
+      { if (k > 0)
+        { while (d->kind.decl != ProcK) d = d->sibling;
+          p = d;
+          d = d->sibling;
+        }
+        funcs[k] = irGen(syntaxTree,p);
+        if (TraceIR) {
+          if (p != NULL) fprintf(listing,"\nProcedure %s:\n",p->attr.name);
+          fprintf(listing,"\nIntermediate code:\n");
+          irDump(funcs[k]);
+        }
+        if (! irVerify(funcs[k],"SSA construction")) Error = TRUE;
+        runIrPasses(funcs[k]);
+      }
+      if (! Error) irLower(funcs,n,codefile);
+      free(funcs);
+    }
+#endif
     fclose(code);
+    if (OptSize)
+    { listCodeSize();
+      fprintf(listing,"\nData memory: %d words of variables (%d unpacked)\n",
+              st_datasize(),st_maxloc());
+    }
   }
 #endif
 #endif
 #endif
+  if (PassStats) printPassStats();
   fclose(source);
   return 0;
 }
@@ -16,15 +16,26 @@ static TokenType token; /* holds current token */
 static TreeNode * program(void);
 static TreeNode * declaration_list(void);
 static TreeNode * declaration(void);
+static TreeNode * proc_declaration(void);
+static TreeNode * parameter(void);
 static TreeNode * type_specifier(void);
 static TreeNode * stmt_sequence(void);
 static TreeNode * statement(void);
 static TreeNode * if_stmt(void);
 static TreeNode * repeat_stmt(void);
+static TreeNode * while_stmt(void);
+static TreeNode * for_stmt(void);
+static TreeNode * case_stmt(void);
+static TreeNode * case_arm(void);
+static TreeNode * constant(void);
 static TreeNode * assign_stmt(void);
+static TreeNode * arg_list(void);
 static TreeNode * read_stmt(void);
 static TreeNode * write_stmt(void);
 static TreeNode * exp(void);
+static TreeNode * and_exp(void);
+static TreeNode * not_exp(void);
+static TreeNode * comparison(void);
 static TreeNode * simple_exp(void);
 static TreeNode * term(void);
 static TreeNode * factor(void);
@@ -59,7 +70,7 @@ TreeNode * declaration_list(void)
 {
   TreeNode * t = declaration();
   TreeNode * p = t;
-  while ((token == INT) || (token == CHAR))
+  while ((token == INT) || (token == CHAR) || (token == PROCEDURE))
   { TreeNode * q;
     q = declaration();
     if (q!=NULL) {
@@ -76,16 +87,82 @@ TreeNode * declaration_list(void)
 
 TreeNode * declaration(void)
 {
-	TreeNode * t = type_specifier();
+	TreeNode * t;
+	if (token==PROCEDURE) return proc_declaration();
+	t = type_specifier();
  	 if ((t!=NULL) && (token==ID))
    		 t->attr.name = copyString(tokenString);
 	 match(ID);
+	 if (token==LBRACKET) {
+	   /* array declaration: child[0] is the size */
+	   match(LBRACKET);
+	   if (t!=NULL) {
+	     t->child[0] = newExpNode(ConstK);
+	     if ((t->child[0]!=NULL) && (token==NUM))
+	       t->child[0]->attr.val = atoi(tokenString);
+	   }
+	   match(NUM);
+	   match(RBRACKET);
+	 }
+	 if (token==ASSIGN) {
+	   /* initializer: child[1] is the list of values,
+	      one for each element from the first on */
+	   TreeNode * p;
+	   match(ASSIGN);
+	   p = constant();
+	   if (t!=NULL) t->child[1] = p;
+	   while (token==COMMA) {
+	     TreeNode * q;
+	     match(COMMA);
+	     q = constant();
+	     if ((p!=NULL) && (q!=NULL)) {
+	       p->sibling = q;
+	       p = q;
+	     }
+	   }
+	 }
 	 //printf("match ID!\n");
 	 match(SEMI);
 	 //printf("match ;\n");
 	 return t;
 }
 
+TreeNode * proc_declaration(void)
+{ TreeNode * t = newDeclNode(ProcK);
+  match(PROCEDURE);
+  if ((t!=NULL) && (token==ID))
+    t->attr.name = copyString(tokenString);
+  match(ID);
+  match(LPAREN);
+  /* child[0] is the parameter list, child[1] the body */
+  if (token!=RPAREN) {
+    TreeNode * p = parameter();
+    if (t!=NULL) t->child[0] = p;
+    while (token==COMMA) {
+      TreeNode * q;
+      match(COMMA);
+      q = parameter();
+      if ((p!=NULL) && (q!=NULL)) {
+        p->sibling = q;
+        p = q;
+      }
+    }
+  }
+  match(RPAREN);
+  if (t!=NULL) t->child[1] = stmt_sequence();
+  match(END);
+  match(SEMI);
+  return t;
+}
+
+TreeNode * parameter(void)
+{ TreeNode * t = type_specifier();
+  if ((t!=NULL) && (token==ID))
+    t->attr.name = copyString(tokenString);
+  match(ID);
+  return t;
+}
+
 TreeNode * type_specifier(void)
 {
 	TreeNode * t = NULL;
@@ -105,7 +182,7 @@ TreeNode * stmt_sequence(void)
 { TreeNode * t = statement();
   TreeNode * p = t;
   while ((token!=ENDFILE) && (token!=END) &&
-         (token!=ELSE) && (token!=UNTIL))
+         (token!=ELSE) && (token!=UNTIL) && (token!=BAR))
   { TreeNode * q;
     match(SEMI);
     q = statement();
@@ -125,6 +202,9 @@ TreeNode * statement(void)
   switch (token) {
     case IF : t = if_stmt(); break;
     case REPEAT : t = repeat_stmt(); break;
+    case WHILE : t = while_stmt(); break;
+    case FOR : t = for_stmt(); break;
+    case CASE : t = case_stmt(); break;
     case ID : t = assign_stmt(); break;
     case READ : t = read_stmt(); break;
     case WRITE : t = write_stmt(); break;
@@ -159,22 +239,150 @@ TreeNode * repeat_stmt(void)
   return t;
 }
 
+TreeNode * while_stmt(void)
+{ TreeNode * t = newStmtNode(WhileK);
+  match(WHILE);
+  if (t!=NULL) t->child[0] = exp();
+  match(DO);
+  if (t!=NULL) t->child[1] = stmt_sequence();
+  match(END);
+  return t;
+}
+
+TreeNode * for_stmt(void)
+{ TreeNode * t = newStmtNode(ForK);
+  match(FOR);
+  if ((t!=NULL) && (token==ID))
+    t->attr.name = copyString(tokenString);
+  match(ID);
+  match(ASSIGN);
+  /* child[0] and child[1] are the first and last
+     value of the loop variable, child[2] the body */
+  if (t!=NULL) t->child[0] = exp();
+  match(TO);
+  if (t!=NULL) t->child[1] = exp();
+  match(DO);
+  if (t!=NULL) t->child[2] = stmt_sequence();
+  match(END);
+  return t;
+}
+
+TreeNode * case_stmt(void)
+{ TreeNode * t = newStmtNode(CaseK);
+  TreeNode * p;
+  match(CASE);
+  if (t!=NULL) t->child[0] = exp();
+  match(OF);
+  /* child[1] is the list of arms, child[2] the
+     else part */
+  p = case_arm();
+  if (t!=NULL) t->child[1] = p;
+  while (token==BAR) {
+    TreeNode * q;
+    match(BAR);
+    q = case_arm();
+    if ((p!=NULL) && (q!=NULL)) {
+      p->sibling = q;
+      p = q;
+    }
+  }
+  if (token==ELSE) {
+    match(ELSE);
+    if (t!=NULL) t->child[2] = stmt_sequence();
+  }
+  match(END);
+  return t;
+}
+
+TreeNode * case_arm(void)
+{ TreeNode * t = newStmtNode(ArmK);
+  TreeNode * p = constant();
+  /* child[0] is the list of labels, child[1] the
+     statements */
+  if (t!=NULL) t->child[0] = p;
+  while (token==COMMA) {
+    TreeNode * q;
+    match(COMMA);
+    q = constant();
+    if ((p!=NULL) && (q!=NULL)) {
+      p->sibling = q;
+      p = q;
+    }
+  }
+  match(COLON);
+  if (t!=NULL) t->child[1] = stmt_sequence();
+  return t;
+}
+
+TreeNode * constant(void)
+{ TreeNode * t = newExpNode(ConstK);
+  int sign = 1;
+  if (token==MINUS) {
+    match(MINUS);
+    sign = -1;
+  }
+  if ((t!=NULL) && (token==NUM))
+    t->attr.val = sign * atoi(tokenString);
+  match(NUM);
+  return t;
+}
+
 TreeNode * assign_stmt(void)
 { TreeNode * t = newStmtNode(AssignK);
   if ((t!=NULL) && (token==ID))
     t->attr.name = copyString(tokenString);
   match(ID);
+  if (token==LPAREN) {
+    /* procedure call: child[0] is the argument list */
+    if (t!=NULL) {
+      t->kind.stmt = CallK;
+      t->child[0] = arg_list();
+    }
+    else arg_list();
+    return t;
+  }
+  if (token==LBRACKET) {
+    /* element store: child[1] is the index */
+    match(LBRACKET);
+    if (t!=NULL) t->child[1] = exp();
+    match(RBRACKET);
+  }
   match(ASSIGN);
   if (t!=NULL) t->child[0] = exp();
   return t;
 }
 
+TreeNode * arg_list(void)
+{ TreeNode * t = NULL;
+  match(LPAREN);
+  if (token!=RPAREN) {
+    TreeNode * p = t = exp();
+    while (token==COMMA) {
+      TreeNode * q;
+      match(COMMA);
+      q = exp();
+      if ((p!=NULL) && (q!=NULL)) {
+        p->sibling = q;
+        p = q;
+      }
+    }
+  }
+  match(RPAREN);
+  return t;
+}
+
 TreeNode * read_stmt(void)
 { TreeNode * t = newStmtNode(ReadK);
   match(READ);
   if ((t!=NULL) && (token==ID))
     t->attr.name = copyString(tokenString);
   match(ID);
+  if (token==LBRACKET) {
+    /* read into an element: child[0] is the index */
+    match(LBRACKET);
+    if (t!=NULL) t->child[0] = exp();
+    match(RBRACKET);
+  }
   return t;
 }
 
@@ -186,6 +394,48 @@ TreeNode * write_stmt(void)
 }
 
 TreeNode * exp(void)
+{ TreeNode * t = and_exp();
+  while (token==OR)
+  { TreeNode * p = newExpNode(OpK);
+    if (p!=NULL) {
+      p->child[0] = t;
+      p->attr.op = token;
+      t = p;
+      match(token);
+      t->child[1] = and_exp();
+    }
+  }
+  return t;
+}
+
+TreeNode * and_exp(void)
+{ TreeNode * t = not_exp();
+  while (token==AND)
+  { TreeNode * p = newExpNode(OpK);
+    if (p!=NULL) {
+      p->child[0] = t;
+      p->attr.op = token;
+      t = p;
+      match(token);
+      t->child[1] = not_exp();
+    }
+  }
+  return t;
+}
+
+TreeNode * not_exp(void)
+{ TreeNode * t;
+  if (token!=NOT) return comparison();
+  t = newExpNode(OpK);
+  match(NOT);
+  if (t!=NULL) {
+    t->attr.op = NOT;
+    t->child[0] = not_exp();
+  }
+  return t;
+}
+
+TreeNode * comparison(void)
 { TreeNode * t = simple_exp();
   if ((token==LT)||(token==EQ)) {
     TreeNode * p = newExpNode(OpK);
@@ -245,6 +495,15 @@ TreeNode * factor(void)
       if ((t!=NULL) && (token==ID))
         t->attr.name = copyString(tokenString);
       match(ID);
+      if (token==LBRACKET) {
+        /* element load: child[0] is the index */
+        match(LBRACKET);
+        if (t!=NULL) {
+          t->kind.exp = IndexK;
+          t->child[0] = exp();
+        }
+        match(RBRACKET);
+      }
       break;
     case LPAREN :
       match(LPAREN);
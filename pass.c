@@ -0,0 +1,140 @@
+/****************************************************/
+/* File: pass.c                                     */
+/* Pass manager for the TINY compiler: runs the     */
+/* optimization passes of the optimization level    */
+/* and keeps statistics on them                     */
+/****************************************************/
+
+#include <sys/time.h>
+#include "globals.h"
+#include "fold.h"
+#include "loop.h"
+#include "range.h"
+#include "peval.h"
+#include "inline.h"
+#include "ir.h"
+#include "iropt.h"
+#include "peep.h"
+#include "pass.h"
+
+/* what a pass works on */
+typedef enum { TreePass, IrPass, CodePass } PassKind;
+
+/* pass flags: a CLEANUP pass only runs if a pass
+   of its kind changed something since the last
+   cleanup (the code passes start out changed), and
+   a pass that GROWS the code is left out when
+   optimizing for size */
+#define CLEANUP 1
+#define GROWS 2
+
+/* the passes, in the order they run; a pass runs
+   at its level and above */
+static struct
+   { char * name;
+     PassKind kind;
+     int level;
+     int flags;
+     int (* tree)(TreeNode *);
+     int (* ir)(IrFunc *);
+     int (* code)(void);
+     int runs;
+     int changes;
+     double msecs;
+   } pass[] =
+   { {"procedure inlining",TreePass,1,0,inlineCalls,NULL,NULL,0,0,0.0},
+     {"partial evaluation",TreePass,2,0,partialEval,NULL,NULL,0,0,0.0},
+     {"constant folding",TreePass,1,CLEANUP,constFold,NULL,NULL,0,0,0.0},
+     {"value range analysis",TreePass,2,0,rangeFold,NULL,NULL,0,0,0.0},
+     {"constant folding",TreePass,2,CLEANUP,constFold,NULL,NULL,0,0,0.0},
+     {"strength reduction",TreePass,2,0,strengthReduce,NULL,NULL,0,0,0.0},
+     {"loop invariant code motion",TreePass,2,0,hoistInvariants,NULL,NULL,0,0,0.0},
+     {"constant folding",TreePass,2,CLEANUP,constFold,NULL,NULL,0,0,0.0},
+     {"loop unrolling",TreePass,2,GROWS,unrollLoops,NULL,NULL,0,0,0.0},
+     {"constant folding",TreePass,2,CLEANUP,constFold,NULL,NULL,0,0,0.0},
+     {"copy propagation",IrPass,1,0,NULL,irCopyProp,NULL,0,0,0.0},
+     {"value numbering",IrPass,1,0,NULL,irValueNumber,NULL,0,0,0.0},
+     {"dead code elimination",IrPass,1,0,NULL,irDeadCode,NULL,0,0,0.0},
+     {"peephole optimization",CodePass,1,0,NULL,NULL,peephole,0,0,0.0},
+     {NULL,TreePass,0,0,NULL,NULL,NULL,0,0,0.0}
+   };
+
+/* the wall clock time in milliseconds */
+static double now(void)
+{ struct timeval tv;
+  gettimeofday(&tv,NULL);
+  return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+/* Procedure runPasses runs the enabled passes of
+ * kind over the tree or f
+ */
+static void runPasses( PassKind kind, TreeNode * t, IrFunc * f)
+{ int k, n, dirty = TRUE;
+  double start;
+  for (k=0;pass[k].name != NULL;k++)
+  { if ((pass[k].kind != kind) || (OptLevel < pass[k].level) ||
+        (OptSize && (pass[k].flags & GROWS)))
+      continue;
+    if (pass[k].flags & CLEANUP)
+    { if (! dirty) continue;
+      dirty = FALSE;
+    }
+    start = now();
+    switch (kind)
+    { case TreePass : n = pass[k].tree(t); break;
+      case IrPass : n = pass[k].ir(f); break;
+      default : n = pass[k].code(); break;
+    }
+    pass[k].msecs += now() - start;
+    pass[k].runs++;
+    pass[k].changes += n;
+    if (n > 0) dirty = TRUE;
+    if (kind == IrPass)
+    { if (TraceOptimize)
+        fprintf(listing,"IR %s: %d instructions removed\n",pass[k].name,n);
+      if (! irVerify(f,pass[k].name)) Error = TRUE;
+      if (TraceIR)
+      { fprintf(listing,"\nIntermediate code after %s:\n",pass[k].name);
+        irDump(f);
+      }
+    }
+  }
+}
+
+/* Procedure runTreePasses runs the syntax tree
+ * passes enabled at the optimization level
+ */
+void runTreePasses( TreeNode * syntaxTree)
+{ runPasses(TreePass,syntaxTree,NULL);
+}
+
+/* Procedure runIrPasses runs the intermediate
+ * code passes enabled at the optimization level,
+ * verifying f after each one
+ */
+void runIrPasses( IrFunc * f)
+{ runPasses(IrPass,NULL,f);
+}
+
+/* Procedure runCodePasses runs the passes over
+ * the buffered TM code enabled at the
+ * optimization level
+ */
+void runCodePasses(void)
+{ runPasses(CodePass,NULL,NULL);
+}
+
+/* Procedure printPassStats lists the time each
+ * pass took and the changes it made
+ */
+void printPassStats(void)
+{ int k;
+  if (OptSize) fprintf(listing,"\nPass statistics (-Os):\n");
+  else fprintf(listing,"\nPass statistics (-O%d):\n",OptLevel);
+  fprintf(listing,"  %-28s %5s %8s %10s\n","pass","runs","changes","time (ms)");
+  for (k=0;pass[k].name != NULL;k++)
+    if (pass[k].runs > 0)
+      fprintf(listing,"  %-28s %5d %8d %10.3f\n",pass[k].name,
+              pass[k].runs,pass[k].changes,pass[k].msecs);
+}
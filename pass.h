@@ -0,0 +1,33 @@
+/****************************************************/
+/* File: pass.h                                     */
+/* Pass manager interface for the TINY compiler     */
+/****************************************************/
+
+#ifndef _PASS_H_
+#define _PASS_H_
+
+#include "ir.h"
+
+/* Procedure runTreePasses runs the syntax tree
+ * passes enabled at the optimization level
+ */
+void runTreePasses(TreeNode * syntaxTree);
+
+/* Procedure runIrPasses runs the intermediate
+ * code passes enabled at the optimization level,
+ * verifying f after each one
+ */
+void runIrPasses(IrFunc * f);
+
+/* Procedure runCodePasses runs the passes over
+ * the buffered TM code enabled at the
+ * optimization level
+ */
+void runCodePasses(void);
+
+/* Procedure printPassStats lists the time each
+ * pass took and the changes it made
+ */
+void printPassStats(void);
+
+#endif
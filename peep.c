@@ -0,0 +1,628 @@
+/****************************************************/
+/* File: peep.c                                     */
+/* Peephole optimizer over the buffered TM code     */
+/* for the TINY compiler                            */
+/****************************************************/
+
+#include <limits.h>
+#include "globals.h"
+#include "code.h"
+#include "peep.h"
+
+/* registers that are never dead: the program
+   counter and the two memory base registers */
+#define ALWAYSLIVE ((1 << pc) | (1 << mp) | (1 << gp))
+
+#define ALLREGS 0xff
+
+/* per location: is it the target of a jump, and
+   the registers live on entry and on exit */
+static int * isLabel = NULL;
+static int * liveIn = NULL;
+static int * liveOut = NULL;
+
+/* TRUE if the code has a jump whose destination is
+   not known, such as a load of pc from memory */
+static int indirect = FALSE;
+
+/* Function nextLive returns the first location at
+ * or after loc that holds a kept instruction
+ */
+static int nextLive( int loc)
+{ while ((loc < iCodeSize) &&
+         (iCode[loc].deleted || (iCode[loc].op == NULL)))
+    loc++;
+  return loc;
+}
+
+static int opIs( TMInstr * i, char * op)
+{ return (i->op != NULL) && (strcmp(i->op,op) == 0);
+}
+
+/* isJump is TRUE for any instruction that may
+   change pc */
+static int isJump( TMInstr * i)
+{ return (i->op[0] == 'J') ||
+         ((opIs(i,"LDA") || opIs(i,"LD") || opIs(i,"LDC")) && (i->r == pc));
+}
+
+/* isUncondJump is TRUE if control never falls
+   through to the next instruction */
+static int isUncondJump( TMInstr * i)
+{ return opIs(i,"HALT") || ((i->op[0] != 'J') && isJump(i));
+}
+
+/* Function readSet returns the registers read by
+ * instruction i
+ */
+static int readSet( TMInstr * i)
+{ if (! i->isRM)
+  { if (opIs(i,"OUT")) return 1 << i->r;
+    if (opIs(i,"IN") || opIs(i,"HALT")) return 0;
+    return (1 << i->s) | (1 << i->t);
+  }
+  if (opIs(i,"LDC")) return 0;
+  if (opIs(i,"ST") || opIs(i,"STB") || (i->op[0] == 'J'))
+    return (1 << i->r) | (1 << i->s);
+  return 1 << i->s;
+}
+
+/* Function writeSet returns the registers written
+ * by instruction i
+ */
+static int writeSet( TMInstr * i)
+{ if (opIs(i,"ST") || opIs(i,"STB") || opIs(i,"OUT") || opIs(i,"HALT"))
+    return 0;
+  if (i->op[0] == 'J') return 1 << pc;
+  return 1 << i->r;
+}
+
+/* Function condMask returns the signs of a
+ * register (1 for negative, 2 for zero, 4 for
+ * positive) on which conditional jump i is taken,
+ * or 0 if i is not a conditional jump
+ */
+static int condMask( TMInstr * i)
+{ if (i->op[0] != 'J') return 0;
+  if (opIs(i,"JLT")) return 1;
+  if (opIs(i,"JLE")) return 3;
+  if (opIs(i,"JEQ")) return 2;
+  if (opIs(i,"JNE")) return 5;
+  if (opIs(i,"JGE")) return 6;
+  return 4;
+}
+
+/* the conditional jump taken on the signs of
+   mask */
+static char * condOp( int mask)
+{ static char * ops[] = {NULL,"JLT","JEQ","JLE","JGT","JNE","JGE",NULL};
+  return ops[mask];
+}
+
+/* Function jumpDest returns the kept location a
+ * jump instruction goes to
+ */
+static int jumpDest( TMInstr * i)
+{ if (i->target >= iCodeSize) return iCodeSize;
+  return nextLive(i->target);
+}
+
+/* Procedure analyze finds the jump targets and
+ * computes register liveness over the whole code
+ */
+static void analyze(void)
+{ int loc, changed;
+  for (loc=0;loc<=iCodeSize;loc++)
+  { isLabel[loc] = FALSE;
+    liveIn[loc] = liveOut[loc] = 0;
+  }
+  indirect = FALSE;
+  /* a return address taken by a call marks a
+     label as well */
+  for (loc=0;loc<iCodeSize;loc++)
+    if (!iCode[loc].deleted && (iCode[loc].op != NULL))
+    { if (iCode[loc].target >= 0) isLabel[jumpDest(&iCode[loc])] = TRUE;
+      else if (isJump(&iCode[loc])) indirect = TRUE;
+    }
+  do
+  { changed = FALSE;
+    for (loc=iCodeSize-1;loc>=0;loc--)
+    { TMInstr * i = &iCode[loc];
+      int out = 0, in;
+      if (i->deleted || (i->op == NULL)) continue;
+      if (opIs(i,"HALT")) out = 0;
+      else if (isJump(i) && (i->target < 0)) out = ALLREGS;
+      else
+      { if (! isUncondJump(i))
+          out |= liveIn[nextLive(loc+1)];
+        if (i->target >= 0)
+          out |= liveIn[jumpDest(i)];
+      }
+      out |= ALWAYSLIVE;
+      in = readSet(i) | (out & ~writeSet(i));
+      if ((in != liveIn[loc]) || (out != liveOut[loc]))
+      { liveIn[loc] = in;
+        liveOut[loc] = out;
+        changed = TRUE;
+      }
+    }
+  } while (changed);
+}
+
+/* Function sameBlock returns the next kept location
+ * after loc if control can only reach it from loc,
+ * or -1 otherwise
+ */
+static int sameBlock( int loc)
+{ int j = nextLive(loc+1);
+  if ((j >= iCodeSize) || isLabel[j] || isJump(&iCode[loc])) return -1;
+  return j;
+}
+
+static void deleteInstr( int loc)
+{ iCode[loc].deleted = TRUE;
+}
+
+static void makeMove( TMInstr * i, int to, int from)
+{ i->op = "LDA";
+  i->isRM = TRUE;
+  i->r = to;
+  i->d = 0;
+  i->s = from;
+  i->target = -1;
+}
+
+/***********************************************/
+/* the rules; each returns TRUE if it changed  */
+/* the code at loc                             */
+/***********************************************/
+
+/* a jump to the instruction that follows it */
+static int jumpToNext( int loc)
+{ TMInstr * i = &iCode[loc];
+  if (!isJump(i) || (i->target < 0)) return FALSE;
+  if (jumpDest(i) != nextLive(loc+1)) return FALSE;
+  deleteInstr(loc);
+  return TRUE;
+}
+
+/* a jump to an unconditional jump goes straight
+   to where that one goes */
+static int jumpToJump( int loc)
+{ TMInstr * i = &iCode[loc], * k;
+  int j;
+  if (!isJump(i) || (i->target < 0) || ((j = jumpDest(i)) >= iCodeSize))
+    return FALSE;
+  k = &iCode[j];
+  if (!isUncondJump(k) || opIs(k,"HALT") || (k->target < 0) ||
+      (k->target == i->target))
+    return FALSE;
+  i->target = k->target;
+  return TRUE;
+}
+
+/* a conditional jump to a test of the same
+   register: the outcome of that test is known when
+   the jump is taken, so the jump can go on to
+   where the test leads */
+static int jumpToKnownTest( int loc)
+{ TMInstr * i = &iCode[loc], * k;
+  int j, m = condMask(i), mk;
+  if ((m == 0) || (i->r == pc) || (i->target < 0) ||
+      ((j = jumpDest(i)) >= iCodeSize))
+    return FALSE;
+  k = &iCode[j];
+  mk = condMask(k);
+  if ((mk == 0) || (k->r != i->r) || (k->target < 0)) return FALSE;
+  if ((m & ~mk) == 0)
+  { if (k->target == i->target) return FALSE;
+    i->target = k->target;
+  }
+  else if ((m & mk) == 0) i->target = j + 1;
+  else return FALSE;
+  return TRUE;
+}
+
+/* a conditional jump over an unconditional one:
+   the opposite test jumps to where that one goes */
+static int branchOverJump( int loc)
+{ TMInstr * i = &iCode[loc], * k;
+  int j, m = condMask(i);
+  if ((m == 0) || (i->r == pc) || (i->target < 0)) return FALSE;
+  j = nextLive(loc+1);
+  if ((j >= iCodeSize) || isLabel[j]) return FALSE;
+  k = &iCode[j];
+  if (!opIs(k,"LDA") || (k->r != pc) || (k->target < 0) ||
+      (jumpDest(i) != nextLive(j+1)))
+    return FALSE;
+  i->op = condOp(7 & ~m);
+  i->target = k->target;
+  deleteInstr(j);
+  return TRUE;
+}
+
+/* code after an unconditional jump that no jump
+   goes to can never run */
+static int unreachable( int loc)
+{ TMInstr * i = &iCode[loc];
+  int j, n = 0;
+  if (indirect || !isUncondJump(i)) return FALSE;
+  for (j=nextLive(loc+1);(j < iCodeSize) && !isLabel[j];j=nextLive(j+1))
+  { deleteInstr(j);
+    n++;
+  }
+  return n > 0;
+}
+
+/* ST r,X followed by LD r2,X: the value is still
+   in r */
+static int storeLoad( int loc)
+{ TMInstr * i = &iCode[loc], * k;
+  int j;
+  if (!opIs(i,"ST") || ((j = sameBlock(loc)) < 0)) return FALSE;
+  k = &iCode[j];
+  if (!opIs(k,"LD") || (k->d != i->d) || (k->s != i->s) || (k->r == pc))
+    return FALSE;
+  if (k->r == i->r) deleteInstr(j);
+  else makeMove(k,k->r,i->r);
+  return TRUE;
+}
+
+/* Temporaries on the mp stack are stored by one ST
+ * and read back by the next LD of the same slot. If
+ * the stored register is still intact at the LD (or
+ * the value is a known constant), the slot is not
+ * needed
+ */
+static int tempPushPop( int loc)
+{ TMInstr * i = &iCode[loc], * prev = NULL, * k;
+  int j, p, constant = FALSE, val = 0;
+  if (!opIs(i,"ST") || (i->s != mp)) return FALSE;
+  /* a constant loaded just before the push */
+  for (p=loc-1;(p >= 0) && (iCode[p].deleted || (iCode[p].op == NULL));p--)
+    ;
+  if ((p >= 0) && !isLabel[loc] && opIs(&iCode[p],"LDC") &&
+      (iCode[p].r == i->r))
+  { prev = &iCode[p];
+    constant = TRUE;
+    val = prev->d;
+  }
+  for (j=loc;(j = sameBlock(j)) >= 0;)
+  { k = &iCode[j];
+    if ((k->s == mp) && (k->d == i->d))
+    { if (!opIs(k,"LD") || (k->r == pc)) return FALSE;
+      if (constant)
+      { k->op = "LDC";
+        k->d = val;
+        k->s = 0;
+      }
+      else if (k->r == i->r) deleteInstr(j);
+      else makeMove(k,k->r,i->r);
+      deleteInstr(loc);
+      return TRUE;
+    }
+    if (!constant && (writeSet(k) & (1 << i->r))) return FALSE;
+    /* a call moves the stack */
+    if (isJump(k) || (writeSet(k) & (1 << mp))) return FALSE;
+  }
+  return FALSE;
+}
+
+/* LDC r,c followed by ADD x,y,r (or SUB x,y,r) with r
+   dead afterwards: LDA x,c(y) */
+static int constAdd( int loc)
+{ TMInstr * i = &iCode[loc], * k;
+  int j, y;
+  if (!opIs(i,"LDC") || (i->r == pc) || ((j = sameBlock(loc)) < 0))
+    return FALSE;
+  k = &iCode[j];
+  if (k->isRM || (!opIs(k,"ADD") && !opIs(k,"SUB"))) return FALSE;
+  if ((k->t == i->r) && (k->s != i->r)) y = k->s;
+  else if (opIs(k,"ADD") && (k->s == i->r) && (k->t != i->r)) y = k->t;
+  else return FALSE;
+  if ((k->r != i->r) && (liveOut[j] & (1 << i->r))) return FALSE;
+  if (opIs(k,"SUB") && (i->d == INT_MIN)) return FALSE;
+  k->d = opIs(k,"SUB") ? - i->d : i->d;
+  k->op = "LDA";
+  k->isRM = TRUE;
+  k->s = y;
+  k->target = -1;
+  deleteInstr(loc);
+  return TRUE;
+}
+
+/* LDA r,0(y) whose only use is the next instruction:
+   that instruction can read y instead */
+static int forwardMove( int loc)
+{ TMInstr * i = &iCode[loc], * k;
+  int j, r = i->r, y = i->s;
+  if (!opIs(i,"LDA") || (i->d != 0) || (r == pc) || (y == pc) || (r == y) ||
+      ((j = sameBlock(loc)) < 0))
+    return FALSE;
+  k = &iCode[j];
+  if (!(readSet(k) & (1 << r))) return FALSE;
+  if ((liveOut[j] & (1 << r)) && !(writeSet(k) & (1 << r))) return FALSE;
+  if (! k->isRM)
+  { if (k->s == r) k->s = y;
+    if (k->t == r) k->t = y;
+    if (opIs(k,"OUT")) k->r = y;
+  }
+  else
+  { if (k->s == r) k->s = y;
+    if ((opIs(k,"ST") || opIs(k,"STB") || (k->op[0] == 'J')) && (k->r == r))
+      k->r = y;
+  }
+  deleteInstr(loc);
+  return TRUE;
+}
+
+/* LDA r,0(r) does nothing */
+static int selfMove( int loc)
+{ TMInstr * i = &iCode[loc];
+  if (!opIs(i,"LDA") || (i->d != 0) || (i->s != i->r)) return FALSE;
+  deleteInstr(loc);
+  return TRUE;
+}
+
+/* an instruction without side effects whose result
+   is never read (DIV may trap, and so may a load
+   from anywhere but the data and temp areas) */
+static int deadWrite( int loc)
+{ TMInstr * i = &iCode[loc];
+  if (!(opIs(i,"LDC") || opIs(i,"LDA") || opIs(i,"ADD") ||
+        opIs(i,"SUB") || opIs(i,"MUL") ||
+        (opIs(i,"LD") && ((i->s == gp) || (i->s == mp))) ||
+        (opIs(i,"LDB") && (i->s == gp))))
+    return FALSE;
+  if ((i->r == pc) || (liveOut[loc] & (1 << i->r))) return FALSE;
+  deleteInstr(loc);
+  return TRUE;
+}
+
+/* Function prevLive returns the last location
+ * before loc that holds a kept instruction, or -1
+ */
+static int prevLive( int loc)
+{ for (loc--;(loc >= 0) && (iCode[loc].deleted || (iCode[loc].op == NULL));
+       loc--)
+    ;
+  return loc;
+}
+
+/* Function sameInstr is TRUE if the instructions at
+ * a and b do the same wherever they are
+ */
+static int sameInstr( int a, int b)
+{ TMInstr * i = &iCode[a], * k = &iCode[b];
+  if ((strcmp(i->op,k->op) != 0) || (i->isRM != k->isRM) ||
+      (i->r != k->r) || (i->s != k->s) || (i->t != k->t))
+    return FALSE;
+  if (isJump(i)) return (i->target >= 0) && (i->target == k->target);
+  /* other uses of pc depend on the location */
+  return (i->s != pc) && (i->d == k->d);
+}
+
+/* Function tailMatch returns how many of the
+ * instructions before location j (none of them a
+ * jump target) are the same as those falling into
+ * location t; the first of the matched ones before
+ * t goes to *first. The two runs never overlap:
+ * before a t above j the run stops at the jump at
+ * j, and before j it stops at a t below
+ */
+static int tailMatch( int j, int t, int * first)
+{ int a = prevLive(j), b = prevLive(t), n = 0;
+  while ((a >= 0) && (b >= 0) && ((t > j) || (a > t)) && !isLabel[a] &&
+         !isUncondJump(&iCode[b]) && sameInstr(a,b))
+  { n++;
+    *first = b;
+    a = prevLive(a);
+    b = prevLive(b);
+  }
+  return n;
+}
+
+/* SUPWIN and SUPKS bound the instructions and the
+   constants of a rule of the superoptimizer table;
+   they must agree with MAXWIN and MAXKS of
+   superopt.c */
+#define SUPWIN 4
+#define SUPKS 4
+#define SUPVARS 6
+
+/* an instruction of a rule: registers are numbered
+   in order of appearance, and the displacement is
+   c plus the constants K0.. of the fragment times
+   k[0].. */
+typedef struct
+   { char * op;
+     int r, s, t;
+     struct { int c; int k[SUPKS]; } d;
+   } SupInstr;
+
+/* a rule: n instructions, the m that do the same,
+   and the registers that must be dead afterwards */
+typedef struct
+   { int n;
+     SupInstr from[SUPWIN];
+     int m;
+     SupInstr to[SUPWIN];
+     int dead;
+   } SupRule;
+
+static SupRule supRules[] =
+   {
+#include "suptab.h"
+    {0}};
+
+static int isRO( char * op)
+{ return (strcmp(op,"ADD") == 0) || (strcmp(op,"SUB") == 0) ||
+         (strcmp(op,"MUL") == 0);
+}
+
+/* Function bindReg binds register variable v of a
+ * rule to register r, which no other variable may
+ * have
+ */
+static int bindReg( int * regs, int v, int r)
+{ int k;
+  if (r == pc) return FALSE;
+  if (regs[v] >= 0) return regs[v] == r;
+  for (k=0;k<SUPVARS;k++)
+    if (regs[k] == r) return FALSE;
+  regs[v] = r;
+  return TRUE;
+}
+
+/* Function supMatch matches rule p against the
+ * instructions at at[], binding its registers and
+ * constants
+ */
+static int supMatch( SupRule * p, int * at, int * regs, int * kval, int * kset)
+{ int j, k;
+  for (j=0;j<p->n;j++)
+  { TMInstr * i = &iCode[at[j]];
+    SupInstr * f = &p->from[j];
+    if (!opIs(i,f->op) || !bindReg(regs,f->r,i->r)) return FALSE;
+    if (isRO(f->op))
+    { if (!bindReg(regs,f->s,i->s) || !bindReg(regs,f->t,i->t))
+        return FALSE;
+      continue;
+    }
+    if (!opIs(i,"LDC") && !bindReg(regs,f->s,i->s)) return FALSE;
+    for (k=0;(k < SUPKS) && (f->d.k[k] == 0);k++)
+      ;
+    if (k == SUPKS)
+    { if (i->d != f->d.c) return FALSE;
+    }
+    else if (! kset[k])
+    { kval[k] = i->d;
+      kset[k] = TRUE;
+    }
+    else if (kval[k] != i->d) return FALSE;
+  }
+  return TRUE;
+}
+
+/* a fragment the superoptimizer (superopt.c) proved
+   has a shorter equivalent in its table */
+static int superRewrite( int loc)
+{ int at[SUPWIN], regs[SUPVARS], kval[SUPKS], kset[SUPKS], j, k;
+  SupRule * p;
+  if (OptLevel < 2) return FALSE;
+  for (p=supRules;p->n > 0;p++)
+  { at[0] = loc;
+    for (j=1;(j < p->n) && ((at[j] = sameBlock(at[j-1])) >= 0);j++)
+      ;
+    if (j < p->n) continue;
+    for (k=0;k<SUPVARS;k++) regs[k] = -1;
+    for (k=0;k<SUPKS;k++) kset[k] = FALSE;
+    if (! supMatch(p,at,regs,kval,kset)) continue;
+    for (k=0;k<SUPVARS;k++)
+      if ((p->dead & (1 << k)) && (liveOut[at[p->n-1]] & (1 << regs[k])))
+        break;
+    if (k < SUPVARS) continue;
+    for (j=0;j<p->m;j++)
+    { TMInstr * i = &iCode[at[j]];
+      SupInstr * t = &p->to[j];
+      unsigned d = (unsigned) t->d.c;
+      for (k=0;k<SUPKS;k++) d += (unsigned) t->d.k[k] * (unsigned) kval[k];
+      i->op = t->op;
+      i->isRM = !isRO(t->op);
+      i->r = regs[t->r];
+      i->s = opIs(i,"LDC") ? 0 : regs[t->s];
+      i->t = i->isRM ? 0 : regs[t->t];
+      i->d = i->isRM ? (int) d : 0;
+      i->target = -1;
+    }
+    for (j=p->m;j<p->n;j++) deleteInstr(at[j]);
+    return TRUE;
+  }
+  return FALSE;
+}
+
+/* an unconditional jump after the same instructions
+   as fall into where it goes, or as come before
+   another jump there, can jump to those instead
+   (-Os only: it saves the copy but no time) */
+static int crossJump( int loc)
+{ TMInstr * i = &iCode[loc];
+  int t, k, n, best = 0, first = 0, at = 0;
+  if (!OptSize || !opIs(i,"LDA") || (i->r != pc) || (i->target < 0) ||
+      isLabel[loc] || ((t = jumpDest(i)) >= iCodeSize))
+    return FALSE;
+  best = tailMatch(loc,t,&first);
+  for (k=0;k<iCodeSize;k++)
+    if ((k != loc) && !iCode[k].deleted && (iCode[k].op != NULL) &&
+        opIs(&iCode[k],"LDA") && (iCode[k].r == pc) &&
+        (iCode[k].target >= 0) && (jumpDest(&iCode[k]) == t) &&
+        ((n = tailMatch(loc,k,&at)) > best))
+    { best = n;
+      first = at;
+    }
+  if (best == 0) return FALSE;
+  for (k=prevLive(loc);best > 0;best--,k=prevLive(k)) deleteInstr(k);
+  i->target = first;
+  return TRUE;
+}
+
+/* the rule table */
+static struct
+    { char * name;
+      int (* apply) (int);
+      int fired;
+    } rules[]
+   = {{"jump to next instruction",jumpToNext,0},
+      {"jump to jump",jumpToJump,0},
+      {"jump to known test",jumpToKnownTest,0},
+      {"branch over jump",branchOverJump,0},
+      {"unreachable code",unreachable,0},
+      {"store followed by load",storeLoad,0},
+      {"temporary push/pop",tempPushPop,0},
+      {"constant add via LDA",constAdd,0},
+      {"move into next use",forwardMove,0},
+      {"move to itself",selfMove,0},
+      {"dead register write",deadWrite,0},
+      {"superoptimizer table",superRewrite,0},
+      {"cross jumping",crossJump,0}};
+
+#define NRULES ((int) (sizeof(rules)/sizeof(rules[0])))
+
+/* Function peephole applies the rewrite rules to
+ * the buffered TM code until none applies, and
+ * reports how often each rule fired. It returns
+ * the number of rewrites
+ */
+int peephole(void)
+{ int loc, r, changed, n = 0;
+  isLabel = (int *) malloc((iCodeSize+1)*sizeof(int));
+  liveIn = (int *) malloc((iCodeSize+1)*sizeof(int));
+  liveOut = (int *) malloc((iCodeSize+1)*sizeof(int));
+  if ((isLabel == NULL) || (liveIn == NULL) || (liveOut == NULL))
+  { fprintf(listing,"Out of memory error in peephole optimizer\n");
+    return 0;
+  }
+  for (r=0;r<NRULES;r++) rules[r].fired = 0;
+  do
+  { changed = FALSE;
+    analyze();
+    for (loc=0;(loc < iCodeSize) && !changed;loc++)
+    { if (iCode[loc].deleted || (iCode[loc].op == NULL)) continue;
+      for (r=0;(r < NRULES) && !changed;r++)
+        if (rules[r].apply(loc))
+        { rules[r].fired++;
+          n++;
+          changed = TRUE;
+        }
+    }
+  } while (changed);
+  if (TraceOptimize)
+  { fprintf(listing,"\nPeephole optimizer:\n");
+    for (r=0;r<NRULES;r++)
+      fprintf(listing,"  %-28s %d\n",rules[r].name,rules[r].fired);
+  }
+  free(isLabel);
+  free(liveIn);
+  free(liveOut);
+  return n;
+}
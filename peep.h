@@ -0,0 +1,17 @@
+/****************************************************/
+/* File: peep.h                                     */
+/* Peephole optimizer interface for the TINY        */
+/* compiler                                         */
+/****************************************************/
+
+#ifndef _PEEP_H_
+#define _PEEP_H_
+
+/* Function peephole applies the rewrite rules to
+ * the buffered TM code until none applies, and
+ * reports how often each rule fired. It returns
+ * the number of rewrites
+ */
+int peephole(void);
+
+#endif
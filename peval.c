@@ -0,0 +1,275 @@
+/****************************************************/
+/* File: peval.c                                    */
+/* Partial evaluator for the TINY compiler: runs    */
+/* the start of the program that needs no input at  */
+/* compile time                                     */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "symtab.h"
+#include "fold.h"
+#include "peval.h"
+
+/* at most MAXOUT values written by the start of
+   the program are turned into write statements */
+#define MAXOUT 100
+
+/* a value the program writes */
+typedef struct
+   { int val;
+     ExpType type;
+     int lineno;
+   } OutVal;
+
+/* number of variables */
+static int nvars = 0;
+
+/* the data memory of the program run so far, and
+   which locations it assigned */
+static int * mem = NULL;
+static int * assigned = NULL;
+
+/* the values written so far */
+static OutVal out[MAXOUT];
+static int nout = 0;
+
+/* steps left before the evaluator gives up */
+static int fuel = 0;
+
+static int evalExp( TreeNode * t, int * v);
+
+/* Function elemLoc works out the memory location
+ * of element index of array name into *loc. It
+ * returns FALSE if the access would trap
+ */
+static int elemLoc( char * name, TreeNode * index, int * loc)
+{ int i;
+  *loc = st_lookup(name);
+  if ((*loc < 0) || !evalExp(index,&i)) return FALSE;
+  if ((i < 0) || (i >= st_size(name)) || (*loc + i >= nvars)) return FALSE;
+  *loc += i;
+  return TRUE;
+}
+
+/* Function evalExp evaluates expression t into *v.
+ * It returns FALSE if that must be left to run
+ * time (the division or indexing traps or fuel
+ * runs out)
+ */
+static int evalExp( TreeNode * t, int * v)
+{ int a, b, loc;
+  if (--fuel < 0) return FALSE;
+  switch (t->kind.exp)
+  { case ConstK :
+      *v = t->attr.val;
+      return TRUE;
+    case IdK :
+      loc = st_lookup(t->attr.name);
+      if ((loc < 0) || (loc >= nvars)) return FALSE;
+      *v = mem[loc];
+      return TRUE;
+    case IndexK :
+      if (! elemLoc(t->attr.name,t->child[0],&loc)) return FALSE;
+      *v = mem[loc];
+      return TRUE;
+    default :
+      if (! evalExp(t->child[0],&a)) return FALSE;
+      /* and and or leave their second operand
+         alone once the first decides */
+      if ((t->attr.op == NOT) || ((t->attr.op == AND) && !a) ||
+          ((t->attr.op == OR) && a))
+        return evalOp(t->attr.op,a,a,v);
+      return evalExp(t->child[1],&b) && evalOp(t->attr.op,a,b,v);
+  }
+}
+
+static int evalStmts( TreeNode * t);
+
+/* Procedure store sets memory location loc to v,
+ * of which a char keeps only the low byte
+ */
+static void store( int loc, int v)
+{ mem[loc] = st_isByte(loc) ? (v & 0xff) : v;
+  assigned[loc] = TRUE;
+}
+
+/* Function evalStmt runs statement t (not its
+ * siblings). It returns FALSE if it had to stop:
+ * at a read, a trap, or for lack of fuel or room
+ * for the output
+ */
+static int evalStmt( TreeNode * t)
+{ int v, loc;
+  if (--fuel < 0) return FALSE;
+  if (t->nodekind != StmtK) return TRUE;
+  switch (t->kind.stmt)
+  { case AssignK :
+      if (t->child[1] != NULL)
+      { if (! elemLoc(t->attr.name,t->child[1],&loc)) return FALSE;
+      }
+      else loc = st_lookup(t->attr.name);
+      if ((loc < 0) || (loc >= nvars) || !evalExp(t->child[0],&v))
+        return FALSE;
+      store(loc,v);
+      return TRUE;
+    case WriteK :
+      if ((nout >= MAXOUT) || !evalExp(t->child[0],&v)) return FALSE;
+      out[nout].val = v;
+      out[nout].type = t->child[0]->type;
+      out[nout].lineno = t->lineno;
+      nout++;
+      return TRUE;
+    case IfK :
+      if (! evalExp(t->child[0],&v)) return FALSE;
+      return evalStmts(v ? t->child[1] : t->child[2]);
+    case CaseK :
+      if (! evalExp(t->child[0],&v)) return FALSE;
+      return evalStmts(caseArm(t,v));
+    case RepeatK :
+      do
+      { if (! evalStmts(t->child[0]) || !evalExp(t->child[1],&v))
+          return FALSE;
+      } while (! v);
+      return TRUE;
+    case WhileK :
+      for (;;)
+      { if (! evalExp(t->child[0],&v)) return FALSE;
+        if (! v) return TRUE;
+        if (! evalStmts(t->child[1])) return FALSE;
+      }
+    case ForK :
+      { int last, count;
+        loc = st_lookup(t->attr.name);
+        if ((loc < 0) || (loc >= nvars) || !evalExp(t->child[0],&v) ||
+            !evalExp(t->child[1],&last))
+          return FALSE;
+        /* the body runs last - first + 1 times */
+        evalOp(MINUS,last,v,&count);
+        store(loc,v);
+        for (;count >= 0;count--)
+        { if ((--fuel < 0) || !evalStmts(t->child[2])) return FALSE;
+          evalOp(PLUS,mem[loc],1,&v);
+          store(loc,v);
+        }
+        return TRUE;
+      }
+    case CallK :
+      /* the arguments were assigned to the
+         parameters already */
+      return evalStmts(st_proc(t->attr.name)->child[1]);
+    default : /* ReadK */
+      return FALSE;
+  }
+}
+
+static int evalStmts( TreeNode * t)
+{ for (;t != NULL;t = t->sibling)
+    if (! evalStmt(t)) return FALSE;
+  return TRUE;
+}
+
+/* Function treeSize counts the nodes of t and its
+ * siblings
+ */
+static int treeSize( TreeNode * t)
+{ int n = 0, i;
+  for (;t != NULL;t = t->sibling)
+  { n++;
+    for (i=0;i<MAXCHILDREN;i++) n += treeSize(t->child[i]);
+  }
+  return n;
+}
+
+static TreeNode * newConst( int val, ExpType type, int lineno)
+{ TreeNode * t = newExpNode(ConstK);
+  if (t == NULL) return NULL;
+  t->lineno = lineno;
+  t->type = type;
+  t->attr.val = val;
+  return t;
+}
+
+/* Function partialEval runs the statements at the
+ * start of syntaxTree that need no input, for at
+ * most EvalFuel steps, and replaces them by the
+ * writes of the values they output. The values
+ * they leave in memory become the initial values
+ * of the variables. It returns the number of
+ * statements replaced
+ */
+int partialEval( TreeNode * syntaxTree)
+{ TreeNode * t, * rest, * first = NULL, ** tail = &first, * s;
+  int * saveMem, * saveAssigned, saveOut, n = 0, nstores = 0, loc, k;
+  if ((syntaxTree == NULL) || (syntaxTree->nodekind != ProgK)) return 0;
+  nvars = st_maxloc();
+  mem = (int *) calloc(nvars+1,sizeof(int));
+  assigned = (int *) calloc(nvars+1,sizeof(int));
+  saveMem = (int *) malloc((nvars+1) * sizeof(int));
+  saveAssigned = (int *) malloc((nvars+1) * sizeof(int));
+  if ((mem == NULL) || (assigned == NULL) || (saveMem == NULL) ||
+      (saveAssigned == NULL))
+  { fprintf(listing,"Out of memory error in partial evaluation\n");
+    exit(1);
+  }
+  /* every variable starts out with its initial
+     value, 0 unless declared otherwise */
+  for (loc=0;loc<nvars;loc++) mem[loc] = st_init(loc);
+  fuel = EvalFuel;
+  nout = 0;
+  for (rest=syntaxTree->child[1];rest != NULL;rest = rest->sibling)
+  { /* a statement that has to stop is left to run
+       from its start at run time */
+    memcpy(saveMem,mem,nvars * sizeof(int));
+    memcpy(saveAssigned,assigned,nvars * sizeof(int));
+    saveOut = nout;
+    if (! evalStmt(rest))
+    { memcpy(mem,saveMem,nvars * sizeof(int));
+      memcpy(assigned,saveAssigned,nvars * sizeof(int));
+      nout = saveOut;
+      break;
+    }
+    n++;
+  }
+  for (loc=0;loc<nvars;loc++)
+    if (assigned[loc] && (mem[loc] != st_init(loc))) nstores++;
+  /* when optimizing for size, a replacement that
+     is bigger than what it replaces is no gain;
+     the values left in memory take no code */
+  if (OptSize)
+  { int size = 0;
+    for (t=syntaxTree->child[1];t != rest;t = t->sibling)
+    { s = t->sibling;
+      t->sibling = NULL;
+      size += treeSize(t);
+      t->sibling = s;
+    }
+    if (2 * nout > size) n = 0;
+  }
+  if (n > 0)
+  { for (k=0;k<nout;k++)
+    { s = newStmtNode(WriteK);
+      if (s == NULL) break;
+      s->lineno = out[k].lineno;
+      s->child[0] = newConst(out[k].val,out[k].type,out[k].lineno);
+      *tail = s;
+      tail = &s->sibling;
+    }
+    /* the program finds the values the statements
+       left in memory there from the start */
+    for (loc=0;loc<nvars;loc++)
+      if (assigned[loc]) st_setInit(loc,mem[loc]);
+    *tail = rest;
+    syntaxTree->child[1] = first;
+  }
+  if (TraceOptimize)
+    fprintf(listing,"Partial evaluation: %d statements run, "
+            "replaced by %d writes and %d initial values\n",
+            n,(n > 0) ? nout : 0,(n > 0) ? nstores : 0);
+  free(mem);
+  free(assigned);
+  free(saveMem);
+  free(saveAssigned);
+  mem = assigned = NULL;
+  return n;
+}
@@ -0,0 +1,20 @@
+/****************************************************/
+/* File: peval.h                                    */
+/* Partial evaluator interface for the TINY         */
+/* compiler                                         */
+/****************************************************/
+
+#ifndef _PEVAL_H_
+#define _PEVAL_H_
+
+/* Function partialEval runs the statements at the
+ * start of syntaxTree that need no input, for at
+ * most EvalFuel steps, and replaces them by the
+ * writes of the values they output. The values
+ * they leave in memory become the initial values
+ * of the variables. It returns the number of
+ * statements replaced
+ */
+int partialEval(TreeNode * syntaxTree);
+
+#endif
@@ -0,0 +1,734 @@
+/****************************************************/
+/* File: range.c                                    */
+/* Value range analysis for the TINY compiler:      */
+/* folds comparisons whose outcome is known from    */
+/* the ranges of the variables they read            */
+/****************************************************/
+
+#include <limits.h>
+#include "globals.h"
+#include "util.h"
+#include "symtab.h"
+#include "fold.h"
+#include "range.h"
+
+/* a repeat loop is widened after going round
+   WIDEN times, and given up on (everything it
+   assigns unknown) after MAXITER */
+#define WIDEN 3
+#define MAXITER 20
+
+/* the values a variable or expression may have,
+   lo to hi (both included). Bounds are kept as
+   doubles so that sums and products of ints are
+   exact while checking them for overflow */
+typedef struct
+   { double lo, hi;
+   } Range;
+
+/* number of variables, i.e. entries in an
+   environment (indexed by memory location) */
+static int nvars = 0;
+
+/* TRUE while comparisons may be folded; FALSE
+   while a loop is being gone round to find the
+   ranges at its top */
+static int rewrite = FALSE;
+
+/* number of comparisons folded */
+static int folded = 0;
+
+/* number of array bounds checks dropped */
+static int dropped = 0;
+
+static Range * newEnv(void)
+{ Range * e = (Range *) calloc(nvars+1,sizeof(Range));
+  if (e == NULL)
+  { fprintf(listing,"Out of memory error in value range analysis\n");
+    exit(1);
+  }
+  return e;
+}
+
+static Range * copyEnv( Range * env)
+{ Range * e = newEnv();
+  memcpy(e,env,nvars*sizeof(Range));
+  return e;
+}
+
+static Range full(void)
+{ Range r;
+  r.lo = INT_MIN;
+  r.hi = INT_MAX;
+  return r;
+}
+
+static Range span( double lo, double hi)
+{ Range r;
+  r.lo = lo;
+  r.hi = hi;
+  return r;
+}
+
+/* Function stored returns the range of the values
+ * memory location loc may hold once one in r is
+ * stored to it: a char keeps only the low byte
+ */
+static Range stored( int loc, Range r)
+{ if (st_isByte(loc) && ((r.lo < 0) || (r.hi > 255))) return span(0,255);
+  return r;
+}
+
+/* Function fits returns r, or the full range if
+ * the machine's arithmetic would wrap around
+ * somewhere in r
+ */
+static Range fits( Range r)
+{ if ((r.lo < INT_MIN) || (r.hi > INT_MAX)) return full();
+  return r;
+}
+
+static double min2( double a, double b) { return (a < b) ? a : b; }
+static double max2( double a, double b) { return (a > b) ? a : b; }
+
+/* joinEnv widens e1 to also cover e2 */
+static void joinEnv( Range * e1, Range * e2)
+{ int i;
+  for (i=0;i<nvars;i++)
+  { e1[i].lo = min2(e1[i].lo,e2[i].lo);
+    e1[i].hi = max2(e1[i].hi,e2[i].hi);
+  }
+}
+
+static int sameEnv( Range * e1, Range * e2)
+{ int i;
+  for (i=0;i<nvars;i++)
+    if ((e1[i].lo != e2[i].lo) || (e1[i].hi != e2[i].hi)) return FALSE;
+  return TRUE;
+}
+
+/* Procedure collectConsts adds the constants of
+ * expression t, and their neighbours, to the
+ * thresholds a loop is widened to
+ */
+static void collectConsts( TreeNode * t, double * th, int * n, int max)
+{ if (t == NULL) return;
+  if ((t->kind.exp == ConstK) && (*n + 3 <= max))
+  { th[(*n)++] = (double) t->attr.val - 1;
+    th[(*n)++] = t->attr.val;
+    th[(*n)++] = (double) t->attr.val + 1;
+  }
+  collectConsts(t->child[0],th,n,max);
+  collectConsts(t->child[1],th,n,max);
+}
+
+/* Procedure collectBounds adds the bounds in env
+ * of the variables expression t reads, and their
+ * neighbours, to the thresholds a loop is widened
+ * to, so that a counter tested against a variable
+ * stops where that variable does
+ */
+static void collectBounds( TreeNode * t, Range * env, double * th, int * n,
+                           int max)
+{ int loc;
+  if (t == NULL) return;
+  if (t->kind.exp == IdK)
+  { loc = st_lookup(t->attr.name);
+    if ((loc < 0) || (loc >= nvars)) return;
+    if ((env[loc].lo > INT_MIN) && (*n + 3 <= max))
+    { th[(*n)++] = env[loc].lo - 1;
+      th[(*n)++] = env[loc].lo;
+      th[(*n)++] = env[loc].lo + 1;
+    }
+    if ((env[loc].hi < INT_MAX) && (*n + 3 <= max))
+    { th[(*n)++] = env[loc].hi - 1;
+      th[(*n)++] = env[loc].hi;
+      th[(*n)++] = env[loc].hi + 1;
+    }
+  }
+  collectBounds(t->child[0],env,th,n,max);
+  collectBounds(t->child[1],env,th,n,max);
+}
+
+/* Procedure widenEnv moves the bounds of old that
+ * grew in new out to the next threshold, or to the
+ * end of the int range
+ */
+static void widenEnv( Range * old, Range * new, double * th, int n)
+{ int i, k;
+  for (i=0;i<nvars;i++)
+  { if (new[i].lo < old[i].lo)
+    { double b = INT_MIN;
+      for (k=0;k<n;k++)
+        if ((th[k] <= new[i].lo) && (th[k] > b)) b = th[k];
+      new[i].lo = b;
+    }
+    if (new[i].hi > old[i].hi)
+    { double b = INT_MAX;
+      for (k=0;k<n;k++)
+        if ((th[k] >= new[i].hi) && (th[k] < b)) b = th[k];
+      new[i].hi = b;
+    }
+  }
+}
+
+/* Function quot returns a / b the way DIV does
+ * it, but without wrapping around
+ */
+static double quot( double a, double b)
+{ if ((a == INT_MIN) && (b == -1)) return - (double) INT_MIN;
+  return (int) a / (int) b;
+}
+
+/* Function divRange returns the range of a / b
+ * (b is not 0 whenever the division is done)
+ */
+static Range divRange( Range a, Range b)
+{ Range r;
+  double m;
+  if ((b.lo > 0) || (b.hi < 0))
+  { /* division truncates towards zero, so the
+       quotient is monotonic in both operands */
+    r.lo = min2(min2(quot(a.lo,b.lo),quot(a.lo,b.hi)),
+                min2(quot(a.hi,b.lo),quot(a.hi,b.hi)));
+    r.hi = max2(max2(quot(a.lo,b.lo),quot(a.lo,b.hi)),
+                max2(quot(a.hi,b.lo),quot(a.hi,b.hi)));
+    return fits(r);
+  }
+  /* the quotient is no bigger than the dividend */
+  m = max2(-a.lo,a.hi);
+  r.lo = -m;
+  r.hi = m;
+  return fits(r);
+}
+
+/* Function diffRange returns the range of a - b;
+ * its bounds may lie outside the int range
+ */
+static Range diffRange( Range a, Range b)
+{ Range r;
+  r.lo = a.lo - b.hi;
+  r.hi = a.hi - b.lo;
+  return r;
+}
+
+static Range rangeExp( TreeNode * t, Range * env);
+
+/* Procedure rangeIndex finds the range of index,
+ * the index of array access t. When rewriting,
+ * the bounds checks of t that the range shows
+ * always pass are dropped
+ */
+static void rangeIndex( TreeNode * t, TreeNode * index, Range * env)
+{ Range r = rangeExp(index,env);
+  if (!rewrite) return;
+  if ((t->check & CHECKLOW) && (r.lo >= 0))
+  { t->check &= ~CHECKLOW;
+    dropped++;
+  }
+  if ((t->check & CHECKHIGH) && (r.hi < st_size(t->attr.name)))
+  { t->check &= ~CHECKHIGH;
+    dropped++;
+  }
+}
+
+static void refine( TreeNode * t, Range * env, int outcome);
+
+/* Function known returns r, the range of test t,
+ * after turning t into a constant when rewriting
+ * if r holds a single value
+ */
+static Range known( TreeNode * t, Range r)
+{ if (rewrite && (r.lo == r.hi) && !mayTrap(t))
+  { t->kind.exp = ConstK;
+    t->attr.val = (int) r.lo;
+    t->child[0] = t->child[1] = NULL;
+    folded++;
+  }
+  return r;
+}
+
+/* Function rangeBool returns the range of and, or
+ * or not expression t under env. The second
+ * operand of and is only evaluated where the first
+ * is true, and that of or where it is false, so it
+ * is gone through under the ranges the first
+ * leaves then; bounds checks in it may be dropped
+ * on that account
+ */
+static Range rangeBool( TreeNode * t, Range * env)
+{ Range a, b, * e;
+  a = rangeExp(t->child[0],env);
+  if (t->attr.op == NOT) return span(1 - a.hi,1 - a.lo);
+  e = copyEnv(env);
+  refine(t->child[0],e,t->attr.op == AND);
+  b = rangeExp(t->child[1],e);
+  free(e);
+  if (t->attr.op == AND)
+  { if ((a.hi == 0) || (b.hi == 0)) return span(0,0);
+    if ((a.lo == 1) && (b.lo == 1)) return span(1,1);
+  }
+  else
+  { if ((a.lo == 1) || (b.lo == 1)) return span(1,1);
+    if ((a.hi == 0) && (b.hi == 0)) return span(0,0);
+  }
+  return span(0,1);
+}
+
+/* Function rangeExp returns the range of the
+ * values of expression t under env. When
+ * rewriting, a test with a known outcome
+ * becomes that constant
+ */
+static Range rangeExp( TreeNode * t, Range * env)
+{ Range a, b, d, r;
+  int loc;
+  switch (t->kind.exp)
+  { case ConstK :
+      return span(t->attr.val,t->attr.val);
+    case IdK :
+      loc = st_lookup(t->attr.name);
+      if ((loc < 0) || (loc >= nvars)) return full();
+      return env[loc];
+    case IndexK :
+      /* array elements are not tracked */
+      rangeIndex(t,t->child[0],env);
+      return full();
+    default :
+      break;
+  }
+  if ((t->attr.op == AND) || (t->attr.op == OR) || (t->attr.op == NOT))
+    return known(t,rangeBool(t,env));
+  a = rangeExp(t->child[0],env);
+  b = rangeExp(t->child[1],env);
+  switch (t->attr.op)
+  { case PLUS :
+      r.lo = a.lo + b.lo;
+      r.hi = a.hi + b.hi;
+      return fits(r);
+    case MINUS :
+      return fits(diffRange(a,b));
+    case TIMES :
+      r.lo = min2(min2(a.lo * b.lo,a.lo * b.hi),min2(a.hi * b.lo,a.hi * b.hi));
+      r.hi = max2(max2(a.lo * b.lo,a.lo * b.hi),max2(a.hi * b.lo,a.hi * b.hi));
+      return fits(r);
+    case OVER :
+      return divRange(a,b);
+    case LT :
+      /* a < b is done as a jump on the sign of
+         a - b, which is only the true answer if the
+         subtraction does not wrap around */
+      d = diffRange(a,b);
+      if ((d.lo < INT_MIN) || (d.hi > INT_MAX)) r = span(0,1);
+      else if (d.hi < 0) r = span(1,1);
+      else if (d.lo >= 0) r = span(0,0);
+      else r = span(0,1);
+      break;
+    default : /* EQ */
+      if ((a.lo == a.hi) && (b.lo == b.hi) && (a.lo == b.lo)) r = span(1,1);
+      else if ((a.hi < b.lo) || (b.hi < a.lo)) r = span(0,0);
+      else r = span(0,1);
+      break;
+  }
+  return known(t,r);
+}
+
+/* Procedure narrow limits variable t (if it is
+ * one) to r; if t is a variable plus or minus a
+ * constant that cannot wrap around, the variable
+ * is limited to r less the constant
+ */
+static void narrow( TreeNode * t, Range * env, Range r)
+{ TreeNode * x;
+  Range a;
+  int loc, c;
+  if ((t->kind.exp == OpK) &&
+      ((t->attr.op == PLUS) || (t->attr.op == MINUS)) &&
+      constAddend(t,&x,&c) && (x->kind.exp == IdK))
+  { a = rangeExp(x,env);
+    if ((a.lo + c >= INT_MIN) && (a.hi + c <= INT_MAX))
+      narrow(x,env,span(r.lo - c,r.hi - c));
+    return;
+  }
+  if (t->kind.exp != IdK) return;
+  loc = st_lookup(t->attr.name);
+  if ((loc < 0) || (loc >= nvars)) return;
+  r.lo = max2(r.lo,env[loc].lo);
+  r.hi = min2(r.hi,env[loc].hi);
+  /* an empty range means the path cannot be
+     taken; the test itself is folded then */
+  if (r.lo <= r.hi) env[loc] = r;
+}
+
+/* Procedure refine narrows the ranges of env to
+ * those for which test t comes out as outcome
+ */
+static void refine( TreeNode * t, Range * env, int outcome)
+{ Range a, b, d, r, * e;
+  if ((t->kind.exp == OpK) && (t->attr.op == NOT))
+  { refine(t->child[0],env,!outcome);
+    return;
+  }
+  if ((t->kind.exp == OpK) && ((t->attr.op == AND) || (t->attr.op == OR)))
+  { if (outcome == (t->attr.op == AND))
+    { /* both operands came out as outcome */
+      refine(t->child[0],env,outcome);
+      refine(t->child[1],env,outcome);
+      return;
+    }
+    /* either the first operand decided, or the
+       second one came out as outcome after it */
+    e = copyEnv(env);
+    refine(t->child[0],env,outcome);
+    refine(t->child[0],e,!outcome);
+    refine(t->child[1],e,outcome);
+    joinEnv(env,e);
+    free(e);
+    return;
+  }
+  if ((t->kind.exp != OpK) ||
+      ((t->attr.op != LT) && (t->attr.op != EQ)))
+    return;
+  a = rangeExp(t->child[0],env);
+  b = rangeExp(t->child[1],env);
+  if (t->attr.op == EQ)
+  { if (outcome)
+    { narrow(t->child[0],env,b);
+      narrow(t->child[1],env,a);
+    }
+    else
+    { /* only a constant can be cut off the end
+         of a range */
+      if (b.lo == b.hi)
+      { r = a;
+        if (r.lo == b.lo) r.lo++;
+        else if (r.hi == b.lo) r.hi--;
+        narrow(t->child[0],env,r);
+      }
+      if (a.lo == a.hi)
+      { r = b;
+        if (r.lo == a.lo) r.lo++;
+        else if (r.hi == a.lo) r.hi--;
+        narrow(t->child[1],env,r);
+      }
+    }
+    return;
+  }
+  d = diffRange(a,b);
+  if ((d.lo < INT_MIN) || (d.hi > INT_MAX)) return;
+  if (outcome)
+  { /* a < b */
+    r = full();
+    r.hi = b.hi - 1;
+    narrow(t->child[0],env,r);
+    r = full();
+    r.lo = a.lo + 1;
+    narrow(t->child[1],env,r);
+  }
+  else
+  { /* a >= b */
+    r = full();
+    r.lo = b.lo;
+    narrow(t->child[0],env,r);
+    r = full();
+    r.hi = a.hi;
+    narrow(t->child[1],env,r);
+  }
+}
+
+/* killAssigned makes every variable that is
+   assigned, read or counted by a for loop
+   somewhere in tree t or a procedure it calls
+   unknown */
+static void killAssigned( TreeNode * t, Range * env)
+{ while (t != NULL)
+  { int i;
+    if ((t->nodekind == StmtK) &&
+        ((t->kind.stmt == AssignK) || (t->kind.stmt == ReadK) ||
+         (t->kind.stmt == ForK)))
+    { int loc = st_lookup(t->attr.name);
+      if ((loc >= 0) && (loc < nvars)) env[loc] = full();
+    }
+    if ((t->nodekind == StmtK) && (t->kind.stmt == CallK))
+      killAssigned(st_proc(t->attr.name)->child[1],env);
+    for (i=0;i<MAXCHILDREN;i++)
+      killAssigned(t->child[i],env);
+    t = t->sibling;
+  }
+}
+
+static void rangeStmts( TreeNode * t, Range * env);
+
+/* Procedure rangeRepeat finds the ranges at the
+ * top of repeat loop t entered with env, then goes
+ * through it once more (folding comparisons if
+ * rewriting) and leaves the ranges on exit in env
+ */
+static void rangeRepeat( TreeNode * t, Range * env)
+{ Range * head = copyEnv(env), * cur, * next, r;
+  double th[60];
+  int nth = 0, iter, save = rewrite;
+  collectConsts(t->child[1],th,&nth,60);
+  collectBounds(t->child[1],env,th,&nth,60);
+  rewrite = FALSE;
+  for (iter=0;;iter++)
+  { cur = copyEnv(head);
+    rangeStmts(t->child[0],cur);
+    r = rangeExp(t->child[1],cur);
+    next = copyEnv(env);
+    /* the loop goes round again only if the test
+       can be false */
+    if (r.lo == 0)
+    { refine(t->child[1],cur,FALSE);
+      joinEnv(next,cur);
+    }
+    free(cur);
+    if (iter >= MAXITER)
+    { killAssigned(t->child[0],next);
+      joinEnv(next,head);
+    }
+    else if (iter >= WIDEN) widenEnv(head,next,th,nth);
+    if (sameEnv(next,head))
+    { free(next);
+      break;
+    }
+    free(head);
+    head = next;
+  }
+  rewrite = save;
+  rangeStmts(t->child[0],head);
+  rangeExp(t->child[1],head);
+  refine(t->child[1],head,TRUE);
+  memcpy(env,head,nvars*sizeof(Range));
+  free(head);
+}
+
+/* Procedure rangeWhile finds the ranges at the
+ * test of while loop t entered with env, then goes
+ * through it once more (folding comparisons if
+ * rewriting) and leaves the ranges on exit in env
+ */
+static void rangeWhile( TreeNode * t, Range * env)
+{ Range * head = copyEnv(env), * cur, * next, r;
+  double th[60];
+  int nth = 0, iter, save = rewrite;
+  collectConsts(t->child[0],th,&nth,60);
+  collectBounds(t->child[0],env,th,&nth,60);
+  rewrite = FALSE;
+  for (iter=0;;iter++)
+  { cur = copyEnv(head);
+    r = rangeExp(t->child[0],cur);
+    next = copyEnv(env);
+    /* the body runs only if the test can be true */
+    if (r.hi != 0)
+    { refine(t->child[0],cur,TRUE);
+      rangeStmts(t->child[1],cur);
+      joinEnv(next,cur);
+    }
+    free(cur);
+    if (iter >= MAXITER)
+    { killAssigned(t->child[1],next);
+      joinEnv(next,head);
+    }
+    else if (iter >= WIDEN) widenEnv(head,next,th,nth);
+    if (sameEnv(next,head))
+    { free(next);
+      break;
+    }
+    free(head);
+    head = next;
+  }
+  rewrite = save;
+  r = rangeExp(t->child[0],head);
+  if (r.hi != 0)
+  { cur = copyEnv(head);
+    refine(t->child[0],cur,TRUE);
+    rangeStmts(t->child[1],cur);
+    free(cur);
+  }
+  refine(t->child[0],head,FALSE);
+  memcpy(env,head,nvars*sizeof(Range));
+  free(head);
+}
+
+/* Procedure rangeFor finds the ranges in for loop
+ * t entered with env like rangeWhile does. The
+ * loop variable goes from the first value to the
+ * last unless their difference wraps around (the
+ * body runs last - first + 1 times), and is one
+ * past the last value on exit if the body ran
+ */
+static void rangeFor( TreeNode * t, Range * env)
+{ Range * head, * cur, * next, a, b, iv, out;
+  double th[60];
+  int nth = 0, iter, save = rewrite, loc;
+  a = rangeExp(t->child[0],env);
+  b = rangeExp(t->child[1],env);
+  loc = st_lookup(t->attr.name);
+  if ((loc < 0) || (loc >= nvars))
+  { killAssigned(t->child[2],env);
+    return;
+  }
+  if ((b.lo - a.hi >= INT_MIN) && (b.hi - a.lo <= INT_MAX))
+  { iv = span(a.lo,b.hi);
+    if (b.hi < a.lo)
+    { /* the body never runs */
+      env[loc] = stored(loc,a);
+      return;
+    }
+    out = fits(span(b.lo + 1,b.hi + 1));
+    if (b.lo < a.hi) out = span(min2(out.lo,a.lo),max2(out.hi,a.hi));
+  }
+  else iv = out = full();
+  iv = stored(loc,iv);
+  out = stored(loc,out);
+  collectConsts(t->child[0],th,&nth,60);
+  collectConsts(t->child[1],th,&nth,60);
+  head = copyEnv(env);
+  head[loc] = iv;
+  rewrite = FALSE;
+  for (iter=0;;iter++)
+  { cur = copyEnv(head);
+    rangeStmts(t->child[2],cur);
+    next = copyEnv(env);
+    next[loc] = iv;
+    joinEnv(next,cur);
+    free(cur);
+    if (iter >= MAXITER)
+    { killAssigned(t->child[2],next);
+      joinEnv(next,head);
+    }
+    else if (iter >= WIDEN) widenEnv(head,next,th,nth);
+    next[loc] = iv;
+    if (sameEnv(next,head))
+    { free(next);
+      break;
+    }
+    free(head);
+    head = next;
+  }
+  rewrite = save;
+  cur = copyEnv(head);
+  rangeStmts(t->child[2],cur);
+  free(cur);
+  joinEnv(head,env);
+  head[loc] = out;
+  memcpy(env,head,nvars*sizeof(Range));
+  free(head);
+}
+
+/* Procedure rangeStmts goes through the statement
+ * sequence t. env holds the ranges on entry and is
+ * updated to those on exit
+ */
+static void rangeStmts( TreeNode * t, Range * env)
+{ for (;t != NULL;t = t->sibling)
+  { Range * e1, * e2, r;
+    TreeNode * arm;
+    int loc;
+    if (t->nodekind != StmtK) continue;
+    switch (t->kind.stmt)
+    { case AssignK :
+        if (t->child[1] != NULL)
+        { rangeIndex(t,t->child[1],env);
+          rangeExp(t->child[0],env);
+          break;
+        }
+        r = rangeExp(t->child[0],env);
+        loc = st_lookup(t->attr.name);
+        if ((loc >= 0) && (loc < nvars)) env[loc] = stored(loc,r);
+        break;
+      case ReadK :
+        if (t->child[0] != NULL)
+        { rangeIndex(t,t->child[0],env);
+          break;
+        }
+        /* IN takes any integer, chars included */
+        loc = st_lookup(t->attr.name);
+        if ((loc >= 0) && (loc < nvars)) env[loc] = stored(loc,full());
+        break;
+      case WriteK :
+        rangeExp(t->child[0],env);
+        break;
+      case IfK :
+        r = rangeExp(t->child[0],env);
+        e1 = copyEnv(env);
+        e2 = copyEnv(env);
+        refine(t->child[0],e1,TRUE);
+        refine(t->child[0],e2,FALSE);
+        rangeStmts(t->child[1],e1);
+        rangeStmts(t->child[2],e2);
+        /* an arm that cannot run adds nothing */
+        if (r.hi == 0) memcpy(env,e2,nvars*sizeof(Range));
+        else
+        { memcpy(env,e1,nvars*sizeof(Range));
+          if (r.lo == 0) joinEnv(env,e2);
+        }
+        free(e1);
+        free(e2);
+        break;
+      case CaseK :
+        r = rangeExp(t->child[0],env);
+        e1 = copyEnv(env);
+        rangeStmts(t->child[2],e1);
+        for (arm=t->child[1];arm != NULL;arm = arm->sibling)
+        { Range labels;
+          TreeNode * l = arm->child[0];
+          labels = span(l->attr.val,l->attr.val);
+          for (l=l->sibling;l != NULL;l = l->sibling)
+            labels = span(min2(labels.lo,l->attr.val),
+                          max2(labels.hi,l->attr.val));
+          e2 = copyEnv(env);
+          narrow(t->child[0],e2,labels);
+          rangeStmts(arm->child[1],e2);
+          /* an arm none of whose labels the selector
+             can have adds nothing */
+          if ((labels.hi >= r.lo) && (labels.lo <= r.hi)) joinEnv(e1,e2);
+          free(e2);
+        }
+        memcpy(env,e1,nvars*sizeof(Range));
+        free(e1);
+        break;
+      case RepeatK :
+        rangeRepeat(t,env);
+        break;
+      case WhileK :
+        rangeWhile(t,env);
+        break;
+      case ForK :
+        rangeFor(t,env);
+        break;
+      case CallK :
+        killAssigned(st_proc(t->attr.name)->child[1],env);
+        break;
+      default :
+        break;
+    }
+  }
+}
+
+/* Function rangeFold folds the comparisons of
+ * syntaxTree whose outcome follows from the
+ * ranges of the values compared, and drops the
+ * array bounds checks that always pass. It
+ * returns the number of rewrites
+ */
+int rangeFold( TreeNode * syntaxTree)
+{ Range * env;
+  int i;
+  if ((syntaxTree == NULL) || (syntaxTree->nodekind != ProgK)) return 0;
+  nvars = st_maxloc();
+  /* every variable starts out with its initial
+     value, 0 unless declared otherwise */
+  env = newEnv();
+  for (i=0;i<nvars;i++) env[i] = span(st_init(i),st_init(i));
+  folded = 0;
+  dropped = 0;
+  rewrite = TRUE;
+  rangeStmts(syntaxTree->child[1],env);
+  free(env);
+  if (TraceOptimize)
+    fprintf(listing,"Value range analysis: %d comparisons folded, "
+            "%d bounds checks dropped\n",folded,dropped);
+  return folded + dropped;
+}
@@ -0,0 +1,18 @@
+/****************************************************/
+/* File: range.h                                    */
+/* Value range analysis interface for the TINY      */
+/* compiler                                         */
+/****************************************************/
+
+#ifndef _RANGE_H_
+#define _RANGE_H_
+
+/* Function rangeFold folds the comparisons of
+ * syntaxTree whose outcome follows from the
+ * ranges of the values compared, and drops the
+ * array bounds checks that always pass. It
+ * returns the number of rewrites
+ */
+int rangeFold(TreeNode * syntaxTree);
+
+#endif
@@ -0,0 +1,485 @@
+/****************************************************/
+/* File: regalloc.c                                 */
+/* Linear scan register allocation of variables     */
+/* for the TINY compiler                            */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "symtab.h"
+#include "code.h"
+#include "regalloc.h"
+
+/* a variable is only worth a register if it is
+   referenced at least this often (loop references
+   count ten times per level of nesting) */
+#define MINWEIGHT 2
+
+/* MAXDEPTH caps the loop nesting used for weights */
+#define MAXDEPTH 4
+
+/* a temporary kept in a register instead of on the
+   mp stack saves a store and a load each time */
+#define TEMPWEIGHT 2
+
+/* Statements are numbered in the order cgen visits
+ * them; the until test of a repeat and the test of a
+ * while loop get a number of their own after the
+ * body, and so does the step at the end of a for
+ * loop (which stands for it in info by the last
+ * value, child[1]); each arm of a case statement
+ * is numbered like a statement. For every number we keep the
+ * statement and the extent of its sub-parts
+ */
+typedef struct
+   { TreeNode * node; /* statement, or loop test */
+     int end; /* last number inside the statement */
+     int thenStart, thenEnd; /* if arms; of a case */
+     int elseStart, elseEnd; /* only the else part */
+     int loop; /* loop directly around it, or -1 */
+     int depth; /* number of loops around it */
+     int temps; /* registers wanted for temporaries */
+   } StmtInfo;
+
+/* the live interval of a variable, in statement
+   numbers, and the register it was given */
+typedef struct
+   { int start, end;
+     int weight;
+     int reg;
+   } Interval;
+
+/* a load of a variable into its register that must
+   come before the code of a statement */
+typedef struct
+   { TreeNode * node;
+     int loc;
+   } RegLoad;
+
+static StmtInfo * info = NULL;
+static int nstmts = 0, maxstmts = 0;
+
+static Interval * iv = NULL;
+static int nvars = 0;
+
+static RegLoad * loads = NULL;
+static int nloads = 0;
+
+static int loopWeight(int depth)
+{ int w = 1;
+  if (depth > MAXDEPTH) depth = MAXDEPTH;
+  while (depth-- > 0) w *= 10;
+  return w;
+}
+
+/* Function tempDemand returns the number of scratch
+ * registers cgen would like to have for evaluating
+ * expression t (counting the one receiving its value)
+ */
+static int tempDemand(TreeNode * t)
+{ int x, y;
+  TreeNode * rest;
+  if ((t == NULL) || (t->nodekind != ExpK)) return 0;
+  /* an element is loaded into the register its
+     index was computed in */
+  if (t->kind.exp == IndexK)
+  { x = tempDemand(t->child[0]);
+    return (x > 1) ? x : 1;
+  }
+  if (t->kind.exp != OpK) return 1;
+  if (constAddend(t,&rest,&x)) return tempDemand(rest);
+  x = tempDemand(t->child[0]);
+  y = tempDemand(t->child[1]);
+  if (y > x)
+  { int tmp = x;
+    x = y;
+    y = tmp;
+  }
+  /* a leaf evaluated second goes to ac1 */
+  if (y <= 1) return (x > 1) ? x : 1;
+  return (x > y+1) ? x : y+1;
+}
+
+static int newStmt(TreeNode * t, int loop, int depth, TreeNode * e)
+{ if (nstmts == maxstmts)
+  { maxstmts = maxstmts ? 2*maxstmts : 64;
+    info = (StmtInfo *) realloc(info,maxstmts*sizeof(StmtInfo));
+  }
+  info[nstmts].node = t;
+  info[nstmts].end = nstmts;
+  info[nstmts].thenStart = info[nstmts].elseStart = 0;
+  info[nstmts].thenEnd = info[nstmts].elseEnd = -1;
+  info[nstmts].loop = loop;
+  info[nstmts].depth = depth;
+  /* ac is always there for temporaries; an element
+     store keeps its index in one more */
+  info[nstmts].temps = tempDemand(e) - 1;
+  if ((t->nodekind == StmtK) && (t->kind.stmt == AssignK) &&
+      (t->child[1] != NULL))
+    info[nstmts].temps++;
+  if (info[nstmts].temps < 0) info[nstmts].temps = 0;
+  return nstmts++;
+}
+
+/* occurVar records a reference to variable name at
+   statement number p inside depth nested loops */
+static void occurVar(char * name, int p, int depth)
+{ int loc = st_lookup(name);
+  int w = loopWeight(depth);
+  if ((loc < 0) || (loc >= nvars)) return;
+  if (iv[loc].weight == 0) iv[loc].start = iv[loc].end = p;
+  if (p < iv[loc].start) iv[loc].start = p;
+  if (p > iv[loc].end) iv[loc].end = p;
+  iv[loc].weight += w;
+}
+
+static void occurExp(TreeNode * t, int p, int depth)
+{ int i;
+  if (t == NULL) return;
+  if (t->kind.exp == IdK) occurVar(t->attr.name,p,depth);
+  for (i=0;i<MAXCHILDREN;i++)
+    occurExp(t->child[i],p,depth);
+}
+
+/* Procedure numberStmts numbers the statement
+ * sequence t and records every variable reference
+ */
+static void numberStmts(TreeNode * t, int depth, int loop)
+{ while (t != NULL)
+  { TreeNode * e = NULL;
+    int p;
+    if ((t->nodekind == StmtK) && (t->kind.stmt != WhileK))
+      e = t->child[0];
+    p = newStmt(t,loop,depth,e);
+    if (t->nodekind == StmtK)
+    switch (t->kind.stmt)
+    { case IfK :
+        occurExp(t->child[0],p,depth);
+        info[p].thenStart = nstmts;
+        numberStmts(t->child[1],depth,-1);
+        info[p].thenEnd = nstmts-1;
+        info[p].elseStart = nstmts;
+        numberStmts(t->child[2],depth,-1);
+        info[p].elseEnd = nstmts-1;
+        break;
+      case CaseK :
+        /* each arm is numbered, and spans its
+           statements; the else part follows them */
+        occurExp(t->child[0],p,depth);
+        numberStmts(t->child[1],depth,-1);
+        info[p].elseStart = nstmts;
+        numberStmts(t->child[2],depth,-1);
+        info[p].elseEnd = nstmts-1;
+        break;
+      case ArmK :
+        numberStmts(t->child[1],depth,-1);
+        break;
+      case RepeatK :
+        numberStmts(t->child[0],depth+1,p);
+        occurExp(t->child[1],
+                 newStmt(t->child[1],p,depth+1,t->child[1]),depth+1);
+        break;
+      case WhileK :
+        numberStmts(t->child[1],depth+1,p);
+        occurExp(t->child[0],
+                 newStmt(t->child[0],p,depth+1,t->child[0]),depth+1);
+        break;
+      case ForK :
+        occurExp(t->child[0],p,depth);
+        occurExp(t->child[1],p,depth);
+        occurVar(t->attr.name,p,depth);
+        numberStmts(t->child[2],depth+1,p);
+        occurVar(t->attr.name,newStmt(t->child[1],p,depth+1,NULL),depth+1);
+        break;
+      case AssignK :
+        /* arrays stay in memory */
+        occurExp(t->child[1],p,depth);
+        occurExp(t->child[0],p,depth);
+        if (t->child[1] == NULL) occurVar(t->attr.name,p,depth);
+        break;
+      case ReadK :
+        if (t->child[0] != NULL) occurExp(t->child[0],p,depth);
+        else occurVar(t->attr.name,p,depth);
+        break;
+      case WriteK :
+        occurExp(t->child[0],p,depth);
+        break;
+      default :
+        break;
+    }
+    info[p].end = nstmts-1;
+    t = t->sibling;
+  }
+}
+
+static int readsVar(TreeNode * t, char * name)
+{ int i;
+  if (t == NULL) return FALSE;
+  if ((t->nodekind == ExpK) && (t->kind.exp == IdK) &&
+      (strcmp(t->attr.name,name) == 0))
+    return TRUE;
+  for (i=0;i<MAXCHILDREN;i++)
+    if (readsVar(t->child[i],name)) return TRUE;
+  return FALSE;
+}
+
+/* Function defFirst is TRUE if statement number p
+ * gives variable name a new value without looking
+ * at the old one
+ */
+static int defFirst(int p, char * name)
+{ TreeNode * t = info[p].node;
+  if ((t == NULL) || (t->nodekind != StmtK)) return FALSE;
+  if ((t->kind.stmt == ReadK) && (strcmp(t->attr.name,name) == 0))
+    return TRUE;
+  if ((t->kind.stmt == AssignK) && (strcmp(t->attr.name,name) == 0))
+    return !readsVar(t->child[0],name);
+  if ((t->kind.stmt == ForK) && (strcmp(t->attr.name,name) == 0))
+    return !readsVar(t->child[0],name) && !readsVar(t->child[1],name);
+  return FALSE;
+}
+
+/* Function needsWidening is TRUE if interval v
+ * overlaps compound statement p in a way that would
+ * let some path reach a reference without passing
+ * the start of the interval (an if arm that is
+ * entered or left, or a loop around a live value)
+ */
+static int needsWidening(int p, Interval * v, char * name)
+{ StmtInfo * s = &info[p];
+  int q;
+  if ((v->end < p) || (v->start > s->end)) return FALSE;
+  if ((v->start <= p) && (v->end >= s->end)) return FALSE;
+  switch (s->node->kind.stmt)
+  { case IfK :
+      if ((v->start == p) && (v->end == p)) return FALSE;
+      if ((v->start >= s->thenStart) && (v->end <= s->thenEnd))
+        return FALSE;
+      if ((v->start >= s->elseStart) && (v->end <= s->elseEnd))
+        return FALSE;
+      return TRUE;
+    case CaseK :
+      if ((v->start == p) && (v->end == p)) return FALSE;
+      if ((v->start >= s->elseStart) && (v->end <= s->elseEnd))
+        return FALSE;
+      for (q=p+1;q<s->elseStart;q=info[q].end+1)
+        if ((v->start > q) && (v->end <= info[q].end)) return FALSE;
+      return TRUE;
+    case RepeatK :
+      /* a value set at the top of the body each time
+         round does not live across the back edge */
+      if ((v->start > p) && (info[v->start].loop == p) &&
+          defFirst(v->start,name))
+        return FALSE;
+      return TRUE;
+    case WhileK :
+    case ForK :
+      /* the same, unless it lives past the loop: the
+         body may not run at all */
+      if ((v->start > p) && (v->end < s->end) &&
+          (info[v->start].loop == p) && defFirst(v->start,name))
+        return FALSE;
+      return TRUE;
+    default :
+      return FALSE;
+  }
+}
+
+/* names of the variables, by memory location */
+static char ** names = NULL;
+
+static void collectNames(TreeNode * t)
+{ int i;
+  while (t != NULL)
+  { if (((t->nodekind == StmtK) &&
+         ((t->kind.stmt == AssignK) || (t->kind.stmt == ReadK) ||
+          (t->kind.stmt == ForK))) ||
+        ((t->nodekind == ExpK) && (t->kind.exp == IdK)))
+    { int loc = st_lookup(t->attr.name);
+      if ((loc >= 0) && (loc < nvars)) names[loc] = t->attr.name;
+    }
+    for (i=0;i<MAXCHILDREN;i++) collectNames(t->child[i]);
+    t = t->sibling;
+  }
+}
+
+/* Procedure keepShared keeps the variables that
+ * the procedures called in t (and its siblings)
+ * use in memory, where the procedures find them
+ */
+static void keepShared(TreeNode * t, int * shared)
+{ int i;
+  for (;t != NULL;t = t->sibling)
+  { if ((t->nodekind == StmtK) && (t->kind.stmt == CallK))
+      callEffects(st_proc(t->attr.name)->child[1],shared,shared);
+    else
+      for (i=0;i<MAXCHILDREN;i++) keepShared(t->child[i],shared);
+  }
+}
+
+/* Procedure allocRegs assigns the registers from
+ * FIRSTREG to LASTREG to the most heavily used
+ * variables of the statement sequence syntaxTree
+ * by a linear scan over their live intervals,
+ * leaving chars and the variables of called
+ * procedures in memory
+ */
+void allocRegs(TreeNode * syntaxTree)
+{ int active[LASTREG+1];
+  int * order, * shared;
+  int i, j, p, changed, ntemps;
+  nvars = st_maxloc();
+  nstmts = 0;
+  nloads = 0;
+  free(iv);
+  free(names);
+  free(loads);
+  iv = (Interval *) calloc(nvars+1,sizeof(Interval));
+  names = (char **) calloc(nvars+1,sizeof(char *));
+  loads = (RegLoad *) calloc(nvars+1,sizeof(RegLoad));
+  order = (int *) calloc(nvars+1,sizeof(int));
+  if ((iv == NULL) || (names == NULL) || (loads == NULL) || (order == NULL))
+  { fprintf(listing,"Out of memory error in register allocation\n");
+    nvars = 0;
+    return;
+  }
+  for (i=0;i<nvars;i++) iv[i].reg = -1;
+  collectNames(syntaxTree);
+  numberStmts(syntaxTree,0,-1);
+  shared = (int *) calloc(nvars+1,sizeof(int));
+  if (shared != NULL)
+  { keepShared(syntaxTree,shared);
+    for (i=0;i<nvars;i++)
+      if (shared[i]) iv[i].weight = 0;
+    free(shared);
+  }
+  /* a char lives in its byte of memory, as storing
+     it there is what keeps it within 0 to 255 */
+  for (i=0;i<nvars;i++)
+    if (st_isByte(i)) iv[i].weight = 0;
+  /* widen intervals over control flow until stable */
+  do
+  { changed = FALSE;
+    for (p=0;p<nstmts;p++)
+    { TreeNode * t = info[p].node;
+      if ((t == NULL) || (t->nodekind != StmtK) ||
+          (t->kind.stmt == AssignK) || (t->kind.stmt == ReadK) ||
+          (t->kind.stmt == WriteK) || (t->kind.stmt == CallK))
+        continue;
+      for (i=0;i<nvars;i++)
+        if ((iv[i].weight > 0) && needsWidening(p,&iv[i],names[i]))
+        { if (p < iv[i].start) iv[i].start = p;
+          if (info[p].end > iv[i].end) iv[i].end = info[p].end;
+          changed = TRUE;
+        }
+    }
+  } while (changed);
+  /* the temporaries a statement wants compete for
+     the registers as intervals of their own */
+  ntemps = 0;
+  for (p=0;p<nstmts;p++) ntemps += info[p].temps;
+  iv = (Interval *) realloc(iv,(nvars+ntemps+1)*sizeof(Interval));
+  order = (int *) realloc(order,(nvars+ntemps+1)*sizeof(int));
+  if ((iv == NULL) || (order == NULL))
+  { fprintf(listing,"Out of memory error in register allocation\n");
+    nvars = 0;
+    return;
+  }
+  ntemps = nvars;
+  for (p=0;p<nstmts;p++)
+    for (i=0;i<info[p].temps;i++)
+    { iv[ntemps].start = iv[ntemps].end = p;
+      iv[ntemps].weight = TEMPWEIGHT*loopWeight(info[p].depth);
+      iv[ntemps].reg = -1;
+      ntemps++;
+    }
+  /* sort candidates by start of interval */
+  j = 0;
+  for (i=0;i<ntemps;i++)
+    if (iv[i].weight >= MINWEIGHT) order[j++] = i;
+  for (i=1;i<j;i++)
+  { int v = order[i], k = i;
+    while ((k > 0) && (iv[order[k-1]].start > iv[v].start))
+    { order[k] = order[k-1];
+      k--;
+    }
+    order[k] = v;
+  }
+  /* the linear scan proper; when no register is free
+     the lightest of the competing intervals spills */
+  for (i=FIRSTREG;i<=LASTREG;i++) active[i] = -1;
+  for (i=0;i<j;i++)
+  { int v = order[i], r, light = -1;
+    for (r=FIRSTREG;r<=LASTREG;r++)
+      if ((active[r] >= 0) && (iv[active[r]].end < iv[v].start))
+        active[r] = -1;
+    for (r=FIRSTREG;r<=LASTREG;r++)
+      if (active[r] < 0) break;
+    if (r > LASTREG)
+    { for (r=FIRSTREG;r<=LASTREG;r++)
+        if ((light < 0) || (iv[active[r]].weight < iv[active[light]].weight))
+          light = r;
+      if (iv[active[light]].weight >= iv[v].weight) continue;
+      iv[active[light]].reg = -1;
+      r = light;
+    }
+    active[r] = v;
+    iv[v].reg = r;
+  }
+  /* the value held in memory must be fetched into
+     the register unless the first statement of the
+     interval sets it */
+  for (i=0;i<nvars;i++)
+    if ((iv[i].reg >= 0) && !defFirst(iv[i].start,names[i]))
+    { loads[nloads].node = info[iv[i].start].node;
+      loads[nloads].loc = i;
+      nloads++;
+    }
+  free(order);
+}
+
+/* Function regOf returns the register holding the
+ * variable at memory location loc, or -1 if the
+ * variable lives in memory
+ */
+int regOf(int loc)
+{ if ((loc < 0) || (loc >= nvars)) return -1;
+  return iv[loc].reg;
+}
+
+/* Function regLoadAt returns the memory location of
+ * the k-th variable that has to be loaded into its
+ * register just before the code of statement t, or
+ * -1 if there are fewer than k+1 such variables
+ */
+int regLoadAt(TreeNode * t, int k)
+{ int i;
+  for (i=0;i<nloads;i++)
+    if ((loads[i].node == t) && (k-- == 0))
+      return loads[i].loc;
+  return -1;
+}
+
+/* Function regFreeAt returns the set (one bit per
+ * register) of registers FIRSTREG..LASTREG that hold
+ * no variable while statement or loop test t runs
+ */
+int regFreeAt(TreeNode * t)
+{ int p, i, set = 0;
+  for (i=FIRSTREG;i<=LASTREG;i++) set |= 1 << i;
+  for (p=0;p<nstmts;p++)
+    if (info[p].node == t) break;
+  if (p == nstmts) return 0;
+  for (i=0;i<nvars;i++)
+    if ((iv[i].reg >= 0) && (iv[i].start <= p) && (iv[i].end >= p))
+      set &= ~(1 << iv[i].reg);
+  return set;
+}
+
+/* Function regVarName returns the name of the
+ * variable at memory location loc (for listings)
+ */
+char * regVarName(int loc)
+{ if ((loc < 0) || (loc >= nvars) || (names[loc] == NULL)) return "?";
+  return names[loc];
+}
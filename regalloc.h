@@ -0,0 +1,43 @@
+/****************************************************/
+/* File: regalloc.h                                 */
+/* Register allocation interface for the TINY       */
+/* compiler                                         */
+/****************************************************/
+
+#ifndef _REGALLOC_H_
+#define _REGALLOC_H_
+
+/* Procedure allocRegs assigns the registers from
+ * FIRSTREG to LASTREG to the most heavily used
+ * variables of the statement sequence syntaxTree
+ * by a linear scan over their live intervals,
+ * leaving chars and the variables of called
+ * procedures in memory
+ */
+void allocRegs(TreeNode * syntaxTree);
+
+/* Function regOf returns the register holding the
+ * variable at memory location loc, or -1 if the
+ * variable lives in memory
+ */
+int regOf(int loc);
+
+/* Function regLoadAt returns the memory location of
+ * the k-th variable that has to be loaded into its
+ * register just before the code of statement t, or
+ * -1 if there are fewer than k+1 such variables
+ */
+int regLoadAt(TreeNode * t, int k);
+
+/* Function regFreeAt returns the set (one bit per
+ * register) of registers FIRSTREG..LASTREG that hold
+ * no variable while statement or loop test t runs
+ */
+int regFreeAt(TreeNode * t);
+
+/* Function regVarName returns the name of the
+ * variable at memory location loc (for listings)
+ */
+char * regVarName(int loc);
+
+#endif
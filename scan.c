@@ -58,7 +58,9 @@ static struct
     } reservedWords[MAXRESERVED]
    = {{"if",IF},{"then",THEN},{"else",ELSE},{"end",END},
       {"repeat",REPEAT},{"until",UNTIL},{"read",READ},
-      {"write",WRITE},{"int",INT},{"char",CHAR}};
+      {"write",WRITE},{"while",WHILE},{"do",DO},{"for",FOR},
+      {"to",TO},{"int",INT},{"char",CHAR},{"procedure",PROCEDURE},
+      {"and",AND},{"or",OR},{"not",NOT},{"case",CASE},{"of",OF}};
 
 /* lookup an identifier to see if it is a reserved word */
 /* uses linear search */
@@ -136,6 +138,18 @@ TokenType getToken(void)
              case ';':
                currentToken = SEMI;
                break;
+             case ',':
+               currentToken = COMMA;
+               break;
+             case '|':
+               currentToken = BAR;
+               break;
+             case '[':
+               currentToken = LBRACKET;
+               break;
+             case ']':
+               currentToken = RBRACKET;
+               break;
              default:
                currentToken = ERROR;
                break;
@@ -155,10 +169,11 @@ TokenType getToken(void)
          if (c == '=')
            currentToken = ASSIGN;
          else
-         { /* backup in the input */
+         { /* backup in the input: a colon alone ends
+              the labels of a case arm */
            ungetNextChar();
            save = FALSE;
-           currentToken = ERROR;
+           currentToken = COLON;
          }
          break;
        case INNUM:
@@ -0,0 +1,867 @@
+/****************************************************/
+/* File: superopt.c                                 */
+/* Superoptimizer for short TM instruction          */
+/* sequences: finds the shortest sequence that does */
+/* the same as each short fragment of the given TM  */
+/* code, and writes the rewrites it can prove as    */
+/* the rule table suptab.h of the peephole          */
+/* optimizer of the TINY compiler                   */
+/*                                                  */
+/* usage: superopt [-n len] [-m count] file.tm ...  */
+/*        > suptab.h                                */
+/****************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+/******* const *******/
+#define   MAXWIN    4    /* longest fragment; must agree with peep.c */
+#define   MAXKS     4    /* constants in a fragment; as in peep.c */
+#define   MAXVARS   6    /* registers in a fragment */
+#define   MAXFRAGS  8000
+#define   MAXCODE   1024 /* instructions in one TM file */
+#define   MAXDISPS  40   /* displacements tried */
+#define   MAXALPHA  4096 /* instructions tried */
+#define   MAXMEM    (2*MAXWIN)
+#define   NTESTS    32
+#define   MAXTERMS  32
+#define   MAXDEG    8
+#define   MAXSYMS   (MAXVARS+MAXKS+2*MAXMEM)
+#define   MAXTRIES  4000000.0 /* candidates searched per fragment */
+#define   NO_REGS   8
+#define   PC_REG    7
+#define   LINESIZE  121
+
+/******* type  *******/
+
+/* the instructions a fragment may hold: no jumps,
+   no input or output, and no DIV, which may trap */
+typedef enum {
+   opADD, opSUB, opMUL,            /* RR: r = s op t */
+   opLD, opST, opLDA, opLDC,       /* RM: r, d(s) */
+   opNONE
+   } OPCODE;
+
+char * opCodeTab[] = {"ADD","SUB","MUL","LD","ST","LDA","LDC"};
+
+#define isRR(op) ((op) <= opMUL)
+
+/* a displacement c + k[0]*K0 + ... for the
+   constants K0.. of the fragment */
+typedef struct {
+      int c;
+      int k[MAXKS];
+   } DISP;
+
+/* an instruction whose registers are variables
+   0..nvars-1 of its fragment */
+typedef struct {
+      int op;
+      int r, s, t;
+      DISP d;
+   } INSTR;
+
+/* a fragment: symbolic ones name each constant
+   other than 0 by a variable K0.., concrete ones
+   keep the values */
+typedef struct {
+      int n;
+      INSTR code[MAXWIN];
+      int nvars, nks;
+      int symbolic;
+   } SHAPE;
+
+typedef struct {
+      SHAPE shape;
+      int kval[MAXKS];  /* constants as first seen */
+      int count;        /* times seen */
+      int parent;       /* symbolic form of a concrete one */
+      int found;        /* a shorter sequence was proven */
+      int m;
+      INSTR to[MAXWIN];
+      int dead;         /* variables that must be dead after */
+   } FRAG;
+
+/******** vars ********/
+FRAG frags[MAXFRAGS];
+int nfrags = 0;
+
+int maxLen = 3;
+int minCount = 2;
+
+/* the instructions of the TM file being read */
+typedef struct {
+      int op;
+      int r, s, t, d;
+   } TMINSTR;
+
+TMINSTR tmCode[MAXCODE];
+int tmSize;
+
+/********************************************/
+/* reading TM code                          */
+/********************************************/
+
+int opOf( char * name)
+{ int op;
+  for (op = opADD; op < opNONE; op++)
+    if (strcmp(name,opCodeTab[op]) == 0) return op;
+  return opNONE;
+}
+
+/* reads the instructions of TM file name; lines
+   other than instructions are skipped */
+int readTM( char * name)
+{ FILE * tm = fopen(name,"r");
+  char line[LINESIZE], op[LINESIZE];
+  int loc, a, b, c;
+  if (tm == NULL)
+  { fprintf(stderr,"file '%s' not found\n",name);
+    return FALSE;
+  }
+  tmSize = 0;
+  while (fgets(line,LINESIZE,tm) != NULL)
+  { if ((line[0] == '*') || (tmSize >= MAXCODE)) continue;
+    if (sscanf(line,"%d: %s %d,%d(%d)",&loc,op,&a,&b,&c) == 5)
+    { tmCode[tmSize].op = opOf(op);
+      tmCode[tmSize].r = a;
+      tmCode[tmSize].d = b;
+      tmCode[tmSize].s = c;
+      tmCode[tmSize].t = 0;
+      if (isRR(tmCode[tmSize].op)) tmCode[tmSize].op = opNONE;
+      tmSize++;
+    }
+    else if (sscanf(line,"%d: %s %d,%d,%d",&loc,op,&a,&b,&c) == 5)
+    { tmCode[tmSize].op = opOf(op);
+      tmCode[tmSize].r = a;
+      tmCode[tmSize].s = b;
+      tmCode[tmSize].t = c;
+      tmCode[tmSize].d = 0;
+      if (! isRR(tmCode[tmSize].op)) tmCode[tmSize].op = opNONE;
+      tmSize++;
+    }
+  }
+  fclose(tm);
+  return TRUE;
+}
+
+/* gives register reg its variable in shape s */
+int varOf( int reg, int * vars, SHAPE * s)
+{ if (reg == PC_REG) return -1;
+  if (vars[reg] < 0)
+  { if (s->nvars >= MAXVARS) return -1;
+    vars[reg] = s->nvars++;
+  }
+  return vars[reg];
+}
+
+/* abstracts the n instructions at tmCode[at] into
+   shape s (and their constants into kval); returns
+   FALSE if they cannot form a fragment */
+int abstract( int at, int n, int symbolic, SHAPE * s, int * kval)
+{ int vars[NO_REGS], k, j;
+  memset(s,0,sizeof(SHAPE));
+  for (k = 0; k < NO_REGS; k++) vars[k] = -1;
+  s->n = n;
+  s->symbolic = symbolic;
+  for (k = 0; k < n; k++)
+  { TMINSTR * i = &tmCode[at+k];
+    INSTR * a = &s->code[k];
+    if (i->op == opNONE) return FALSE;
+    a->op = i->op;
+    if ((a->r = varOf(i->r,vars,s)) < 0) return FALSE;
+    if (i->op == opLDC) a->s = 0;
+    else if ((a->s = varOf(i->s,vars,s)) < 0) return FALSE;
+    if (isRR(i->op))
+    { if ((a->t = varOf(i->t,vars,s)) < 0) return FALSE;
+      continue;
+    }
+    if (! symbolic || (i->d == 0))
+    { a->d.c = i->d;
+      continue;
+    }
+    for (j = 0; (j < s->nks) && (kval[j] != i->d); j++)
+      ;
+    if (j == s->nks) kval[s->nks++] = i->d;
+    a->d.k[j] = 1;
+  }
+  return TRUE;
+}
+
+/* records a fragment; returns its index */
+int addFrag( SHAPE * s, int * kval, int parent)
+{ int k;
+  for (k = 0; k < nfrags; k++)
+    if (memcmp(&frags[k].shape,s,sizeof(SHAPE)) == 0)
+    { frags[k].count++;
+      return k;
+    }
+  if (nfrags >= MAXFRAGS) return -1;
+  memset(&frags[k],0,sizeof(FRAG));
+  frags[k].shape = *s;
+  memcpy(frags[k].kval,kval,sizeof(frags[k].kval));
+  frags[k].count = 1;
+  frags[k].parent = parent;
+  nfrags++;
+  return k;
+}
+
+/* collects the fragments of the TM code read */
+void harvest(void)
+{ SHAPE s;
+  int kval[MAXKS], at, n, sym;
+  for (at = 0; at < tmSize; at++)
+    for (n = 2; (n <= maxLen) && (at + n <= tmSize); n++)
+      if (abstract(at,n,TRUE,&s,kval))
+      { sym = addFrag(&s,kval,-1);
+        if ((sym >= 0) && abstract(at,n,FALSE,&s,kval))
+          addFrag(&s,kval,sym);
+      }
+}
+
+/********************************************/
+/* running sequences on test states         */
+/********************************************/
+
+typedef struct {
+      unsigned reg[MAXVARS];
+      int nmem;                   /* locations stored to */
+      unsigned maddr[MAXMEM], mval[MAXMEM];
+      int nacc;                   /* locations accessed */
+      unsigned acc[MAXMEM];
+   } STATE;
+
+unsigned testReg[NTESTS][MAXVARS];
+unsigned testK[NTESTS][MAXKS];
+unsigned testSeed[NTESTS];
+
+STATE want[NTESTS];
+
+unsigned rnd = 12345;
+
+unsigned random32(void)
+{ rnd = rnd * 1103515245u + 12345u;
+  return (rnd >> 16) ^ (rnd << 16);
+}
+
+/* a value either small or anything */
+unsigned testValue( int small)
+{ if (small) return (unsigned) ((int) (random32() % 9) - 4);
+  return random32();
+}
+
+/* data memory starts out holding a value that
+   depends on the location and the test */
+unsigned memInit( unsigned a, unsigned seed)
+{ a = (a ^ seed) * 2654435761u;
+  return a ^ (a >> 15);
+}
+
+unsigned dispVal( DISP * d, unsigned * kv)
+{ unsigned v = (unsigned) d->c;
+  int k;
+  for (k = 0; k < MAXKS; k++) v += (unsigned) d->k[k] * kv[k];
+  return v;
+}
+
+unsigned memRead( STATE * st, unsigned a, unsigned seed)
+{ int k;
+  for (k = st->nmem-1; k >= 0; k--)
+    if (st->maddr[k] == a) return st->mval[k];
+  return memInit(a,seed);
+}
+
+void memAccess( STATE * st, unsigned a)
+{ int k;
+  for (k = 0; k < st->nacc; k++)
+    if (st->acc[k] == a) return;
+  st->acc[st->nacc++] = a;
+}
+
+/* runs the n instructions of code on test t */
+void run( INSTR * code, int n, int t, STATE * st)
+{ int k;
+  memcpy(st->reg,testReg[t],sizeof(st->reg));
+  st->nmem = st->nacc = 0;
+  for (k = 0; k < n; k++)
+  { INSTR * i = &code[k];
+    unsigned a = dispVal(&i->d,testK[t]) + st->reg[i->s];
+    switch (i->op)
+    { case opADD : st->reg[i->r] = st->reg[i->s] + st->reg[i->t]; break;
+      case opSUB : st->reg[i->r] = st->reg[i->s] - st->reg[i->t]; break;
+      case opMUL : st->reg[i->r] = st->reg[i->s] * st->reg[i->t]; break;
+      case opLDA : st->reg[i->r] = a; break;
+      case opLDC : st->reg[i->r] = dispVal(&i->d,testK[t]); break;
+      case opLD :
+        memAccess(st,a);
+        st->reg[i->r] = memRead(st,a,testSeed[t]);
+        break;
+      case opST :
+        memAccess(st,a);
+        st->maddr[st->nmem] = a;
+        st->mval[st->nmem++] = st->reg[i->r];
+        break;
+    }
+  }
+}
+
+/* compares the result of a candidate with the one
+   wanted on test t; returns -1 if memory differs,
+   or else the variables whose values differ */
+int compare( STATE * got, int t, int nvars)
+{ STATE * w = &want[t];
+  int k, j, diff = 0;
+  if (got->nacc != w->nacc) return -1;
+  for (k = 0; k < w->nacc; k++)
+  { for (j = 0; (j < got->nacc) && (got->acc[j] != w->acc[k]); j++)
+      ;
+    if (j == got->nacc) return -1;
+  }
+  for (k = 0; k < w->nmem; k++)
+    if (memRead(got,w->maddr[k],testSeed[t]) != w->mval[k]) return -1;
+  for (k = 0; k < got->nmem; k++)
+    if (memRead(w,got->maddr[k],testSeed[t]) != got->mval[k]) return -1;
+  for (k = 0; k < nvars; k++)
+    if (got->reg[k] != w->reg[k]) diff |= 1 << k;
+  return diff;
+}
+
+/********************************************/
+/* symbolic checking                        */
+/********************************************/
+
+/* values are polynomials with 32-bit wrapping
+   coefficients over the symbols: the variables
+   as the fragment starts, the constants K0.., and
+   the values memory starts out with */
+typedef struct {
+      unsigned coef;
+      int deg;
+      unsigned char sym[MAXDEG];
+   } TERM;
+
+typedef struct {
+      int n;
+      int bad;    /* too big to be represented */
+      TERM t[MAXTERMS];
+   } POLY;
+
+typedef struct {
+      POLY reg[MAXVARS];
+      int nmem;
+      POLY maddr[MAXMEM], mval[MAXMEM];
+      int nacc;
+      POLY acc[MAXMEM];
+      int unknown;  /* a location may or may not alias */
+   } SYMSTATE;
+
+/* the location of each memory symbol */
+POLY memSym[MAXSYMS-MAXVARS-MAXKS];
+int nmemSyms;
+
+int termCmp( TERM * a, TERM * b)
+{ int k;
+  if (a->deg != b->deg) return a->deg - b->deg;
+  for (k = 0; k < a->deg; k++)
+    if (a->sym[k] != b->sym[k]) return a->sym[k] - b->sym[k];
+  return 0;
+}
+
+/* sorts the terms and merges equal ones */
+void polyNorm( POLY * p)
+{ int k, j, n = 0;
+  TERM x;
+  for (k = 1; k < p->n; k++)
+    for (j = k; (j > 0) && (termCmp(&p->t[j-1],&p->t[j]) > 0); j--)
+    { x = p->t[j];
+      p->t[j] = p->t[j-1];
+      p->t[j-1] = x;
+    }
+  for (k = 0; k < p->n; k++)
+    if ((n > 0) && (termCmp(&p->t[n-1],&p->t[k]) == 0))
+      p->t[n-1].coef += p->t[k].coef;
+    else p->t[n++] = p->t[k];
+  p->n = 0;
+  for (k = 0; k < n; k++)
+    if (p->t[k].coef != 0) p->t[p->n++] = p->t[k];
+}
+
+void polyConst( POLY * p, unsigned c)
+{ p->bad = FALSE;
+  p->n = 0;
+  if (c == 0) return;
+  p->t[0].coef = c;
+  p->t[0].deg = 0;
+  p->n = 1;
+}
+
+void polySym( POLY * p, int sym)
+{ p->bad = FALSE;
+  p->n = 1;
+  p->t[0].coef = 1;
+  p->t[0].deg = 1;
+  p->t[0].sym[0] = sym;
+}
+
+/* r = a + sign * b */
+void polyAdd( POLY * r, POLY * a, POLY * b, int sign)
+{ POLY s;
+  int k;
+  s = *a;
+  s.bad = a->bad || b->bad || (a->n + b->n > MAXTERMS);
+  if (s.bad)
+  { *r = s;
+    return;
+  }
+  for (k = 0; k < b->n; k++)
+  { s.t[s.n] = b->t[k];
+    s.t[s.n++].coef *= (unsigned) sign;
+  }
+  polyNorm(&s);
+  *r = s;
+}
+
+/* r = a * b */
+void polyMul( POLY * r, POLY * a, POLY * b)
+{ POLY s;
+  int k, j, m, x;
+  s.n = 0;
+  s.bad = a->bad || b->bad || (a->n * b->n > MAXTERMS);
+  for (k = 0; !s.bad && (k < a->n); k++)
+    for (j = 0; !s.bad && (j < b->n); j++)
+    { TERM * t = &s.t[s.n++];
+      if (a->t[k].deg + b->t[j].deg > MAXDEG)
+      { s.bad = TRUE;
+        break;
+      }
+      t->coef = a->t[k].coef * b->t[j].coef;
+      t->deg = a->t[k].deg + b->t[j].deg;
+      memcpy(t->sym,a->t[k].sym,a->t[k].deg);
+      memcpy(t->sym + a->t[k].deg,b->t[j].sym,b->t[j].deg);
+      for (m = 1; m < t->deg; m++)
+        for (x = m; (x > 0) && (t->sym[x-1] > t->sym[x]); x--)
+        { unsigned char c = t->sym[x];
+          t->sym[x] = t->sym[x-1];
+          t->sym[x-1] = c;
+        }
+    }
+  if (! s.bad) polyNorm(&s);
+  *r = s;
+}
+
+int polyEq( POLY * a, POLY * b)
+{ int k;
+  if (a->bad || b->bad || (a->n != b->n)) return FALSE;
+  for (k = 0; k < a->n; k++)
+    if ((a->t[k].coef != b->t[k].coef) || termCmp(&a->t[k],&b->t[k]))
+      return FALSE;
+  return TRUE;
+}
+
+/* is p a constant, and is it zero */
+int polyIsConst( POLY * p, int * zero)
+{ if (p->bad) return FALSE;
+  *zero = (p->n == 0);
+  return (p->n == 0) || ((p->n == 1) && (p->t[0].deg == 0));
+}
+
+void polyDisp( POLY * p, DISP * d)
+{ POLY s;
+  int k;
+  polyConst(p,(unsigned) d->c);
+  for (k = 0; k < MAXKS; k++)
+    if (d->k[k] != 0)
+    { polySym(&s,MAXVARS + k);
+      s.t[0].coef = (unsigned) d->k[k];
+      polyAdd(p,p,&s,1);
+    }
+}
+
+/* the value memory starts out with at location a */
+void polyMem( POLY * p, POLY * a)
+{ int k;
+  for (k = 0; (k < nmemSyms) && !polyEq(&memSym[k],a); k++)
+    ;
+  if (k == MAXSYMS-MAXVARS-MAXKS)
+  { p->bad = TRUE;
+    return;
+  }
+  if (k == nmemSyms) memSym[nmemSyms++] = *a;
+  polySym(p,MAXVARS + MAXKS + k);
+}
+
+/* the value at location a after the stores of st */
+void symRead( SYMSTATE * st, POLY * a, POLY * v)
+{ POLY diff;
+  int k, zero;
+  for (k = st->nmem-1; k >= 0; k--)
+  { polyAdd(&diff,a,&st->maddr[k],-1);
+    if (! polyIsConst(&diff,&zero))
+    { st->unknown = TRUE;
+      break;
+    }
+    if (zero)
+    { *v = st->mval[k];
+      return;
+    }
+  }
+  polyMem(v,a);
+}
+
+void symAccess( SYMSTATE * st, POLY * a)
+{ int k;
+  for (k = 0; k < st->nacc; k++)
+    if (polyEq(&st->acc[k],a)) return;
+  st->acc[st->nacc++] = *a;
+}
+
+void symRun( INSTR * code, int n, int nvars, SYMSTATE * st)
+{ POLY a;
+  int k;
+  for (k = 0; k < nvars; k++) polySym(&st->reg[k],k);
+  st->nmem = st->nacc = 0;
+  st->unknown = FALSE;
+  for (k = 0; k < n; k++)
+  { INSTR * i = &code[k];
+    polyDisp(&a,&i->d);
+    if (! isRR(i->op) && (i->op != opLDC))
+      polyAdd(&a,&a,&st->reg[i->s],1);
+    switch (i->op)
+    { case opADD : polyAdd(&st->reg[i->r],&st->reg[i->s],&st->reg[i->t],1);
+                   break;
+      case opSUB : polyAdd(&st->reg[i->r],&st->reg[i->s],&st->reg[i->t],-1);
+                   break;
+      case opMUL : polyMul(&st->reg[i->r],&st->reg[i->s],&st->reg[i->t]);
+                   break;
+      case opLDA :
+      case opLDC : st->reg[i->r] = a; break;
+      case opLD :
+        symAccess(st,&a);
+        symRead(st,&a,&st->reg[i->r]);
+        break;
+      case opST :
+        symAccess(st,&a);
+        st->maddr[st->nmem] = a;
+        st->mval[st->nmem++] = st->reg[i->r];
+        break;
+    }
+  }
+}
+
+/* proves that to leaves the variables not in dead
+   and memory as from does, touching the same
+   locations */
+int prove( SHAPE * s, INSTR * to, int m, int dead)
+{ static SYMSTATE a, b;
+  POLY x, y;
+  int k, j;
+  nmemSyms = 0;
+  symRun(s->code,s->n,s->nvars,&a);
+  symRun(to,m,s->nvars,&b);
+  if (a.unknown || b.unknown || (a.nacc != b.nacc)) return FALSE;
+  for (k = 0; k < s->nvars; k++)
+    if (!(dead & (1 << k)) && !polyEq(&a.reg[k],&b.reg[k])) return FALSE;
+  for (k = 0; k < a.nacc; k++)
+  { for (j = 0; (j < b.nacc) && !polyEq(&a.acc[k],&b.acc[j]); j++)
+      ;
+    if (j == b.nacc) return FALSE;
+  }
+  for (k = 0; k < a.nmem + b.nmem; k++)
+  { POLY * loc = (k < a.nmem) ? &a.maddr[k] : &b.maddr[k - a.nmem];
+    symRead(&a,loc,&x);
+    symRead(&b,loc,&y);
+    if (a.unknown || b.unknown || !polyEq(&x,&y)) return FALSE;
+  }
+  return TRUE;
+}
+
+/********************************************/
+/* the search                               */
+/********************************************/
+
+INSTR alpha[MAXALPHA];
+int nalpha;
+
+DISP disps[MAXDISPS];
+int ndisps;
+
+void addDisp( int c, int k1, int s1, int k2, int s2)
+{ DISP d;
+  int k;
+  memset(&d,0,sizeof(DISP));
+  d.c = c;
+  if (k1 >= 0) d.k[k1] += s1;
+  if (k2 >= 0) d.k[k2] += s2;
+  for (k = 0; k < ndisps; k++)
+    if (memcmp(&disps[k],&d,sizeof(DISP)) == 0) return;
+  if (ndisps < MAXDISPS) disps[ndisps++] = d;
+}
+
+/* the displacements a candidate may use: 0, 1, -1,
+   and the constants of the fragment, their
+   negations, sums and differences */
+void makeDisps( FRAG * f)
+{ int c[MAXWIN], nc = 0, k, j;
+  ndisps = 0;
+  addDisp(0,-1,0,-1,0);
+  addDisp(1,-1,0,-1,0);
+  addDisp(-1,-1,0,-1,0);
+  if (f->shape.symbolic)
+  { for (k = 0; k < f->shape.nks; k++)
+    { addDisp(0,k,1,-1,0);
+      addDisp(0,k,-1,-1,0);
+      for (j = 0; j < f->shape.nks; j++)
+        if (j != k)
+        { addDisp(0,k,1,j,1);
+          addDisp(0,k,1,j,-1);
+        }
+    }
+    return;
+  }
+  for (k = 0; k < f->shape.n; k++)
+    if (! isRR(f->shape.code[k].op) && (f->shape.code[k].d.c != 0))
+      c[nc++] = f->shape.code[k].d.c;
+  for (k = 0; k < nc; k++)
+  { addDisp(c[k],-1,0,-1,0);
+    addDisp((int) (0u - (unsigned) c[k]),-1,0,-1,0);
+    for (j = 0; j < nc; j++)
+      if (j != k)
+      { addDisp((int) ((unsigned) c[k] + (unsigned) c[j]),-1,0,-1,0);
+        addDisp((int) ((unsigned) c[k] - (unsigned) c[j]),-1,0,-1,0);
+        addDisp((int) ((unsigned) c[k] * (unsigned) c[j]),-1,0,-1,0);
+      }
+  }
+}
+
+void makeAlpha( FRAG * f)
+{ int nv = f->shape.nvars, op, r, s, t, d;
+  nalpha = 0;
+  for (op = opADD; op < opNONE; op++)
+    for (r = 0; r < nv; r++)
+      for (s = 0; s < nv; s++)
+      { if (isRR(op))
+          for (t = 0; t < nv; t++)
+          { memset(&alpha[nalpha],0,sizeof(INSTR));
+            alpha[nalpha].op = op;
+            alpha[nalpha].r = r;
+            alpha[nalpha].s = s;
+            alpha[nalpha++].t = t;
+          }
+        else if ((op != opLDC) || (s == 0))
+          for (d = 0; d < ndisps; d++)
+          { memset(&alpha[nalpha],0,sizeof(INSTR));
+            alpha[nalpha].op = op;
+            alpha[nalpha].r = r;
+            alpha[nalpha].s = s;
+            alpha[nalpha++].d = disps[d];
+          }
+      }
+}
+
+/* the variables of the fragment that may be dead
+   after it: the temporaries, whose last value is
+   used within the fragment (values that are never
+   used are left to the dead write rule) */
+int temps( SHAPE * s)
+{ int k, j, v, t = 0;
+  for (k = 0; k < s->n; k++)
+  { INSTR * i = &s->code[k];
+    if (i->op == opST) continue;
+    v = i->r;
+    for (j = k+1; j < s->n; j++)
+    { INSTR * u = &s->code[j];
+      if ((u->s == v) && (u->op != opLDC)) break;
+      if ((isRR(u->op) && (u->t == v)) || ((u->op == opST) && (u->r == v)))
+        break;
+      if (u->op != opST && (u->r == v))
+      { j = s->n + 1;
+        break;
+      }
+    }
+    if (j < s->n) t |= 1 << v;
+    else t &= ~(1 << v);
+  }
+  return t;
+}
+
+int popCount( int x)
+{ int n = 0;
+  for (; x != 0; x &= x - 1) n++;
+  return n;
+}
+
+INSTR cand[MAXWIN];
+
+/* tries the candidates of length m whose first
+   k instructions are in cand */
+void search( FRAG * f, int k, int m, int allowed)
+{ STATE got;
+  int a, t, diff, dead;
+  if (k == m)
+  { dead = 0;
+    for (t = 0; t < NTESTS; t++)
+    { run(cand,m,t,&got);
+      diff = compare(&got,t,f->shape.nvars);
+      if ((diff < 0) || (diff & ~allowed)) return;
+      dead |= diff;
+    }
+    if (f->found && (popCount(dead) >= popCount(f->dead))) return;
+    if (! prove(&f->shape,cand,m,dead)) return;
+    f->found = TRUE;
+    f->m = m;
+    memcpy(f->to,cand,sizeof(cand));
+    f->dead = dead;
+    return;
+  }
+  for (a = 0; a < nalpha; a++)
+  { cand[k] = alpha[a];
+    search(f,k+1,m,allowed);
+  }
+}
+
+/* looks for the shortest sequence doing what
+   fragment f does */
+void superopt( FRAG * f)
+{ double tries = 1;
+  int k, m, t, v;
+  makeDisps(f);
+  makeAlpha(f);
+  for (k = 1; k < f->shape.n; k++) tries *= nalpha;
+  if (tries > MAXTRIES)
+  { fprintf(stderr,"skipped a fragment of %d instructions "
+            "(%.0f candidates)\n",f->shape.n,tries);
+    return;
+  }
+  /* registers and constants both small now and
+     then, so locations alias */
+  for (t = 0; t < NTESTS; t++)
+  { for (v = 0; v < MAXVARS; v++) testReg[t][v] = testValue(t % 4 == 1);
+    for (v = 0; v < MAXKS; v++)
+      testK[t][v] = f->shape.symbolic ? testValue(t % 4 == 1)
+                                      : (unsigned) f->kval[v];
+    testSeed[t] = random32();
+    run(f->shape.code,f->shape.n,t,&want[t]);
+  }
+  for (m = 0; (m < f->shape.n) && !f->found; m++)
+    search(f,0,m,temps(&f->shape));
+}
+
+/********************************************/
+/* writing the table                        */
+/********************************************/
+
+void printInstr( FILE * out, INSTR * i)
+{ int k, first = TRUE;
+  fprintf(out,"%s %c,",opCodeTab[i->op],'a' + i->r);
+  if (isRR(i->op))
+  { fprintf(out,"%c,%c",'a' + i->s,'a' + i->t);
+    return;
+  }
+  for (k = 0; k < MAXKS; k++)
+    if (i->d.k[k] != 0)
+    { fprintf(out,"%sK%d",(i->d.k[k] < 0) ? "-" : (first ? "" : "+"),k);
+      first = FALSE;
+    }
+  if (first || (i->d.c != 0)) fprintf(out,first ? "%d" : "%+d",i->d.c);
+  if (i->op != opLDC) fprintf(out,"(%c)",'a' + i->s);
+}
+
+void printRow( FILE * out, INSTR * code, int n)
+{ int k, j;
+  fprintf(out,"{");
+  for (k = 0; k < n; k++)
+  { INSTR * i = &code[k];
+    fprintf(out,"%s{\"%s\",%d,%d,%d,{%d,{",(k > 0) ? "," : "",
+            opCodeTab[i->op],i->r,i->s,i->t,i->d.c);
+    for (j = 0; j < MAXKS; j++)
+      fprintf(out,"%s%d",(j > 0) ? "," : "",i->d.k[j]);
+    fprintf(out,"}}}");
+  }
+  fprintf(out,"}");
+}
+
+int byCount( const void * a, const void * b)
+{ return (*(FRAG **) b)->count - (*(FRAG **) a)->count;
+}
+
+void writeTable( FILE * out)
+{ FRAG * rows[MAXFRAGS];
+  int n = 0, k, j;
+  for (k = 0; k < nfrags; k++)
+    if (frags[k].found && (frags[k].count >= minCount))
+      rows[n++] = &frags[k];
+  qsort(rows,n,sizeof(FRAG *),byCount);
+  fprintf(out,"/****************************************************/\n");
+  fprintf(out,"/* File: suptab.h                                   */\n");
+  fprintf(out,"/* Rewrite rules for the peephole optimizer of the  */\n");
+  fprintf(out,"/* TINY compiler, written by superopt: do not edit  */\n");
+  fprintf(out,"/****************************************************/\n");
+  fprintf(out,"\n/* %d fragments searched, %d rewrites proven */\n",
+          nfrags,n);
+  for (k = 0; k < n; k++)
+  { FRAG * f = rows[k];
+    fprintf(out,"\n/* %d times: ",f->count);
+    for (j = 0; j < f->shape.n; j++)
+    { if (j > 0) fprintf(out,"; ");
+      printInstr(out,&f->shape.code[j]);
+    }
+    fprintf(out,"\n   becomes: ");
+    for (j = 0; j < f->m; j++)
+    { if (j > 0) fprintf(out,"; ");
+      printInstr(out,&f->to[j]);
+    }
+    if (f->m == 0) fprintf(out,"nothing");
+    if (f->dead != 0)
+    { fprintf(out,"\n   if dead after:");
+      for (j = 0; j < f->shape.nvars; j++)
+        if (f->dead & (1 << j)) fprintf(out," %c",'a' + j);
+    }
+    fprintf(out," */\n{%d,",f->shape.n);
+    printRow(out,f->shape.code,f->shape.n);
+    fprintf(out,",%d,",f->m);
+    printRow(out,f->to,f->m);
+    fprintf(out,",0x%x},\n",f->dead);
+  }
+}
+
+/********************************************/
+/* E X E C U T I O N   B E G I N S   H E R E */
+/********************************************/
+
+int main( int argc, char * argv[] )
+{ int k, nfiles = 0;
+  for (k = 1; k < argc; k++)
+    if ((strcmp(argv[k],"-n") == 0) && (k + 1 < argc))
+    { maxLen = atoi(argv[++k]);
+      if ((maxLen < 2) || (maxLen > MAXWIN)) maxLen = 3;
+    }
+    else if ((strcmp(argv[k],"-m") == 0) && (k + 1 < argc))
+      minCount = atoi(argv[++k]);
+    else if (readTM(argv[k]))
+    { harvest();
+      nfiles++;
+    }
+  if (nfiles == 0)
+  { fprintf(stderr,"usage: %s [-n len] [-m count] file.tm ...\n",argv[0]);
+    exit(1);
+  }
+  /* a concrete fragment is searched only if its
+     symbolic form had no shorter sequence */
+  for (k = 0; k < nfrags; k++)
+    if (frags[k].shape.symbolic && (frags[k].count >= minCount))
+      superopt(&frags[k]);
+  for (k = 0; k < nfrags; k++)
+    if (!frags[k].shape.symbolic && (frags[k].count >= minCount) &&
+        !frags[frags[k].parent].found)
+      superopt(&frags[k]);
+  writeTable(stdout);
+  return 0;
+}
@@ -0,0 +1,562 @@
+/****************************************************/
+/* File: suptab.h                                   */
+/* Rewrite rules for the peephole optimizer of the  */
+/* TINY compiler, written by superopt: do not edit  */
+/****************************************************/
+
+/* 7227 fragments searched, 122 rewrites proven */
+
+/* 38 times: LDA a,K0(a); LDA b,K1(a)
+   becomes: LDA b,K0+K1(a)
+   if dead after: a */
+{2,{{"LDA",0,0,0,{0,{1,0,0,0}}},{"LDA",1,0,0,{0,{0,1,0,0}}}},1,{{"LDA",1,0,0,{0,{1,1,0,0}}}},0x1},
+
+/* 30 times: LDA a,K0(b); LDA a,K1(a)
+   becomes: LDA a,K0+K1(b) */
+{2,{{"LDA",0,1,0,{0,{1,0,0,0}}},{"LDA",0,0,0,{0,{0,1,0,0}}}},1,{{"LDA",0,1,0,{0,{1,1,0,0}}}},0x0},
+
+/* 27 times: LDA a,K0(a); LDA a,K1(a)
+   becomes: LDA a,K0+K1(a) */
+{2,{{"LDA",0,0,0,{0,{1,0,0,0}}},{"LDA",0,0,0,{0,{0,1,0,0}}}},1,{{"LDA",0,0,0,{0,{1,1,0,0}}}},0x0},
+
+/* 15 times: LDA a,K0(a); LDC b,K1; SUB b,b,a
+   becomes: LDC b,-K0+K1; SUB b,b,a
+   if dead after: a */
+{3,{{"LDA",0,0,0,{0,{1,0,0,0}}},{"LDC",1,0,0,{0,{0,1,0,0}}},{"SUB",1,1,0,{0,{0,0,0,0}}}},2,{{"LDC",1,0,0,{0,{-1,1,0,0}}},{"SUB",1,1,0,{0,{0,0,0,0}}}},0x1},
+
+/* 15 times: LDA a,0(b); LD c,K0(d); ADD c,c,a
+   becomes: LD a,K0(d); ADD c,a,b
+   if dead after: a */
+{3,{{"LDA",0,1,0,{0,{0,0,0,0}}},{"LD",2,3,0,{0,{1,0,0,0}}},{"ADD",2,2,0,{0,{0,0,0,0}}}},2,{{"LD",0,3,0,{0,{1,0,0,0}}},{"ADD",2,0,1,{0,{0,0,0,0}}}},0x1},
+
+/* 12 times: LDC a,2; MUL b,a,b
+   becomes: ADD b,b,b
+   if dead after: a */
+{2,{{"LDC",0,0,0,{2,{0,0,0,0}}},{"MUL",1,0,1,{0,{0,0,0,0}}}},1,{{"ADD",1,1,1,{0,{0,0,0,0}}}},0x1},
+
+/* 12 times: LDA a,K0(b); LDC c,K1; SUB a,c,a
+   becomes: LDC a,-K0+K1; SUB a,a,b
+   if dead after: c */
+{3,{{"LDA",0,1,0,{0,{1,0,0,0}}},{"LDC",2,0,0,{0,{0,1,0,0}}},{"SUB",0,2,0,{0,{0,0,0,0}}}},2,{{"LDC",0,0,0,{0,{-1,1,0,0}}},{"SUB",0,0,1,{0,{0,0,0,0}}}},0x4},
+
+/* 11 times: LD a,K0(b); LDA a,K1(a); LDA a,K2(a)
+   becomes: LD a,K0(b); LDA a,K1+K2(a) */
+{3,{{"LD",0,1,0,{0,{1,0,0,0}}},{"LDA",0,0,0,{0,{0,1,0,0}}},{"LDA",0,0,0,{0,{0,0,1,0}}}},2,{{"LD",0,1,0,{0,{1,0,0,0}}},{"LDA",0,0,0,{0,{0,1,1,0}}}},0x0},
+
+/* 10 times: LDA a,K0(b); LDA c,K1(a)
+   becomes: LDA c,K0+K1(b)
+   if dead after: a */
+{2,{{"LDA",0,1,0,{0,{1,0,0,0}}},{"LDA",2,0,0,{0,{0,1,0,0}}}},1,{{"LDA",2,1,0,{0,{1,1,0,0}}}},0x1},
+
+/* 10 times: SUB a,a,b; LDC c,K0; SUB a,c,a
+   becomes: SUB a,b,a; LDA a,K0(a)
+   if dead after: c */
+{3,{{"SUB",0,0,1,{0,{0,0,0,0}}},{"LDC",2,0,0,{0,{1,0,0,0}}},{"SUB",0,2,0,{0,{0,0,0,0}}}},2,{{"SUB",0,1,0,{0,{0,0,0,0}}},{"LDA",0,0,0,{0,{1,0,0,0}}}},0x4},
+
+/* 10 times: LDC a,0; ST a,K0(b); LDC c,0
+   becomes: SUB c,a,a; ST c,K0(b)
+   if dead after: a */
+{3,{{"LDC",0,0,0,{0,{0,0,0,0}}},{"ST",0,1,0,{0,{1,0,0,0}}},{"LDC",2,0,0,{0,{0,0,0,0}}}},2,{{"SUB",2,0,0,{0,{0,0,0,0}}},{"ST",2,1,0,{0,{1,0,0,0}}}},0x1},
+
+/* 9 times: LDC a,2; MUL a,a,b
+   becomes: ADD a,b,b */
+{2,{{"LDC",0,0,0,{2,{0,0,0,0}}},{"MUL",0,0,1,{0,{0,0,0,0}}}},1,{{"ADD",0,1,1,{0,{0,0,0,0}}}},0x0},
+
+/* 9 times: LDC a,K0; SUB a,a,b; LDA a,K1(a)
+   becomes: LDC a,K0+K1; SUB a,a,b */
+{3,{{"LDC",0,0,0,{0,{1,0,0,0}}},{"SUB",0,0,1,{0,{0,0,0,0}}},{"LDA",0,0,0,{0,{0,1,0,0}}}},2,{{"LDC",0,0,0,{0,{1,1,0,0}}},{"SUB",0,0,1,{0,{0,0,0,0}}}},0x0},
+
+/* 9 times: LDA a,K0(a); LDA b,K1(b); SUB c,a,b
+   becomes: SUB a,a,b; LDA c,K0-K1(a)
+   if dead after: a b */
+{3,{{"LDA",0,0,0,{0,{1,0,0,0}}},{"LDA",1,1,0,{0,{0,1,0,0}}},{"SUB",2,0,1,{0,{0,0,0,0}}}},2,{{"SUB",0,0,1,{0,{0,0,0,0}}},{"LDA",2,0,0,{0,{1,-1,0,0}}}},0x3},
+
+/* 8 times: LDC a,0; LDA a,K0(a)
+   becomes: LDC a,K0 */
+{2,{{"LDC",0,0,0,{0,{0,0,0,0}}},{"LDA",0,0,0,{0,{1,0,0,0}}}},1,{{"LDC",0,0,0,{0,{1,0,0,0}}}},0x0},
+
+/* 8 times: LDC a,0; ST a,K0(b); LD c,K0(b)
+   becomes: SUB c,a,a; ST c,K0(b)
+   if dead after: a */
+{3,{{"LDC",0,0,0,{0,{0,0,0,0}}},{"ST",0,1,0,{0,{1,0,0,0}}},{"LD",2,1,0,{0,{1,0,0,0}}}},2,{{"SUB",2,0,0,{0,{0,0,0,0}}},{"ST",2,1,0,{0,{1,0,0,0}}}},0x1},
+
+/* 8 times: LDC a,K0; SUB b,a,b; SUB b,c,b
+   becomes: ADD a,b,c; LDA b,-K0(a)
+   if dead after: a */
+{3,{{"LDC",0,0,0,{0,{1,0,0,0}}},{"SUB",1,0,1,{0,{0,0,0,0}}},{"SUB",1,2,1,{0,{0,0,0,0}}}},2,{{"ADD",0,1,2,{0,{0,0,0,0}}},{"LDA",1,0,0,{0,{-1,0,0,0}}}},0x1},
+
+/* 8 times: LDA a,K0(b); LDC c,0; SUB a,c,a
+   becomes: LDC a,-K0; SUB a,a,b
+   if dead after: c */
+{3,{{"LDA",0,1,0,{0,{1,0,0,0}}},{"LDC",2,0,0,{0,{0,0,0,0}}},{"SUB",0,2,0,{0,{0,0,0,0}}}},2,{{"LDC",0,0,0,{0,{-1,0,0,0}}},{"SUB",0,0,1,{0,{0,0,0,0}}}},0x4},
+
+/* 7 times: LDC a,0; ST a,K0(b); LDC a,0
+   becomes: SUB a,a,a; ST a,K0(b) */
+{3,{{"LDC",0,0,0,{0,{0,0,0,0}}},{"ST",0,1,0,{0,{1,0,0,0}}},{"LDC",0,0,0,{0,{0,0,0,0}}}},2,{{"SUB",0,0,0,{0,{0,0,0,0}}},{"ST",0,1,0,{0,{1,0,0,0}}}},0x0},
+
+/* 7 times: SUB a,b,c; LDC d,K0; SUB a,d,a
+   becomes: SUB a,c,b; LDA a,K0(a)
+   if dead after: d */
+{3,{{"SUB",0,1,2,{0,{0,0,0,0}}},{"LDC",3,0,0,{0,{1,0,0,0}}},{"SUB",0,3,0,{0,{0,0,0,0}}}},2,{{"SUB",0,2,1,{0,{0,0,0,0}}},{"LDA",0,0,0,{0,{1,0,0,0}}}},0x8},
+
+/* 7 times: LDC a,0; LDC b,0; ST b,K0(c)
+   becomes: SUB a,a,a; ST a,K0(c)
+   if dead after: b */
+{3,{{"LDC",0,0,0,{0,{0,0,0,0}}},{"LDC",1,0,0,{0,{0,0,0,0}}},{"ST",1,2,0,{0,{1,0,0,0}}}},2,{{"SUB",0,0,0,{0,{0,0,0,0}}},{"ST",0,2,0,{0,{1,0,0,0}}}},0x2},
+
+/* 7 times: LDA a,0(b); LDC c,2; MUL c,b,c
+   becomes: ADD c,b,b; SUB a,c,b */
+{3,{{"LDA",0,1,0,{0,{0,0,0,0}}},{"LDC",2,0,0,{2,{0,0,0,0}}},{"MUL",2,1,2,{0,{0,0,0,0}}}},2,{{"ADD",2,1,1,{0,{0,0,0,0}}},{"SUB",0,2,1,{0,{0,0,0,0}}}},0x0},
+
+/* 7 times: LDC a,2; MUL a,b,a
+   becomes: ADD a,b,b */
+{2,{{"LDC",0,0,0,{2,{0,0,0,0}}},{"MUL",0,1,0,{0,{0,0,0,0}}}},1,{{"ADD",0,1,1,{0,{0,0,0,0}}}},0x0},
+
+/* 7 times: LDC a,2; MUL a,b,a; ADD c,c,a
+   becomes: ADD a,b,b; ADD c,a,c */
+{3,{{"LDC",0,0,0,{2,{0,0,0,0}}},{"MUL",0,1,0,{0,{0,0,0,0}}},{"ADD",2,2,0,{0,{0,0,0,0}}}},2,{{"ADD",0,1,1,{0,{0,0,0,0}}},{"ADD",2,0,2,{0,{0,0,0,0}}}},0x0},
+
+/* 6 times: LDC a,0; SUB b,c,a
+   becomes: LDA b,0(c)
+   if dead after: a */
+{2,{{"LDC",0,0,0,{0,{0,0,0,0}}},{"SUB",1,2,0,{0,{0,0,0,0}}}},1,{{"LDA",1,2,0,{0,{0,0,0,0}}}},0x1},
+
+/* 6 times: LDC a,1; MUL a,a,b
+   becomes: LDA a,0(b) */
+{2,{{"LDC",0,0,0,{1,{0,0,0,0}}},{"MUL",0,0,1,{0,{0,0,0,0}}}},1,{{"LDA",0,1,0,{0,{0,0,0,0}}}},0x0},
+
+/* 6 times: LDC a,1; MUL a,a,b; LDA b,-1(b)
+   becomes: LDA a,0(b); LDA b,-1(a) */
+{3,{{"LDC",0,0,0,{1,{0,0,0,0}}},{"MUL",0,0,1,{0,{0,0,0,0}}},{"LDA",1,1,0,{-1,{0,0,0,0}}}},2,{{"LDA",0,1,0,{0,{0,0,0,0}}},{"LDA",1,0,0,{-1,{0,0,0,0}}}},0x0},
+
+/* 6 times: LDA a,K0(a); LDA a,K1(a); ST a,K2(b)
+   becomes: LDA a,K0+K1(a); ST a,K2(b) */
+{3,{{"LDA",0,0,0,{0,{1,0,0,0}}},{"LDA",0,0,0,{0,{0,1,0,0}}},{"ST",0,1,0,{0,{0,0,1,0}}}},2,{{"LDA",0,0,0,{0,{1,1,0,0}}},{"ST",0,1,0,{0,{0,0,1,0}}}},0x0},
+
+/* 5 times: LDA a,K0(a); LDC b,0; SUB a,b,a
+   becomes: LDC b,-K0; SUB a,b,a
+   if dead after: b */
+{3,{{"LDA",0,0,0,{0,{1,0,0,0}}},{"LDC",1,0,0,{0,{0,0,0,0}}},{"SUB",0,1,0,{0,{0,0,0,0}}}},2,{{"LDC",1,0,0,{0,{-1,0,0,0}}},{"SUB",0,1,0,{0,{0,0,0,0}}}},0x2},
+
+/* 5 times: LDA a,0(b); LDA c,K0(a)
+   becomes: LDA c,K0(b)
+   if dead after: a */
+{2,{{"LDA",0,1,0,{0,{0,0,0,0}}},{"LDA",2,0,0,{0,{1,0,0,0}}}},1,{{"LDA",2,1,0,{0,{1,0,0,0}}}},0x1},
+
+/* 5 times: LDC a,0; SUB b,a,b; LDA c,K0(b)
+   becomes: LDC a,K0; SUB c,a,b
+   if dead after: a b */
+{3,{{"LDC",0,0,0,{0,{0,0,0,0}}},{"SUB",1,0,1,{0,{0,0,0,0}}},{"LDA",2,1,0,{0,{1,0,0,0}}}},2,{{"LDC",0,0,0,{0,{1,0,0,0}}},{"SUB",2,0,1,{0,{0,0,0,0}}}},0x3},
+
+/* 5 times: LDC a,2; MUL b,c,a
+   becomes: ADD b,c,c
+   if dead after: a */
+{2,{{"LDC",0,0,0,{2,{0,0,0,0}}},{"MUL",1,2,0,{0,{0,0,0,0}}}},1,{{"ADD",1,2,2,{0,{0,0,0,0}}}},0x1},
+
+/* 5 times: LDC a,0; LDC b,0; LDA b,K0(b)
+   becomes: SUB a,a,a; LDA b,K0(a) */
+{3,{{"LDC",0,0,0,{0,{0,0,0,0}}},{"LDC",1,0,0,{0,{0,0,0,0}}},{"LDA",1,1,0,{0,{1,0,0,0}}}},2,{{"SUB",0,0,0,{0,{0,0,0,0}}},{"LDA",1,0,0,{0,{1,0,0,0}}}},0x0},
+
+/* 4 times: LDC a,0; LDC b,0; SUB c,d,b
+   becomes: SUB a,a,a; ADD c,a,d
+   if dead after: b */
+{3,{{"LDC",0,0,0,{0,{0,0,0,0}}},{"LDC",1,0,0,{0,{0,0,0,0}}},{"SUB",2,3,1,{0,{0,0,0,0}}}},2,{{"SUB",0,0,0,{0,{0,0,0,0}}},{"ADD",2,0,3,{0,{0,0,0,0}}}},0x2},
+
+/* 4 times: LD a,K0(b); LD c,K0(b); MUL a,a,c
+   becomes: LD c,K0(b); MUL a,c,c */
+{3,{{"LD",0,1,0,{0,{1,0,0,0}}},{"LD",2,1,0,{0,{1,0,0,0}}},{"MUL",0,0,2,{0,{0,0,0,0}}}},2,{{"LD",2,1,0,{0,{1,0,0,0}}},{"MUL",0,2,2,{0,{0,0,0,0}}}},0x0},
+
+/* 4 times: MUL a,a,b; LDA a,K0(a); LDA a,K1(a)
+   becomes: MUL a,a,b; LDA a,K0+K1(a) */
+{3,{{"MUL",0,0,1,{0,{0,0,0,0}}},{"LDA",0,0,0,{0,{1,0,0,0}}},{"LDA",0,0,0,{0,{0,1,0,0}}}},2,{{"MUL",0,0,1,{0,{0,0,0,0}}},{"LDA",0,0,0,{0,{1,1,0,0}}}},0x0},
+
+/* 4 times: ST a,K0(b); LD c,K0(b); LDA c,K1(c)
+   becomes: ST a,K0(b); LDA c,K1(a) */
+{3,{{"ST",0,1,0,{0,{1,0,0,0}}},{"LD",2,1,0,{0,{1,0,0,0}}},{"LDA",2,2,0,{0,{0,1,0,0}}}},2,{{"ST",0,1,0,{0,{1,0,0,0}}},{"LDA",2,0,0,{0,{0,1,0,0}}}},0x0},
+
+/* 4 times: LDC a,0; LDA b,K0(a)
+   becomes: LDC b,K0
+   if dead after: a */
+{2,{{"LDC",0,0,0,{0,{0,0,0,0}}},{"LDA",1,0,0,{0,{1,0,0,0}}}},1,{{"LDC",1,0,0,{0,{1,0,0,0}}}},0x1},
+
+/* 4 times: LDA a,K0(a); LDC b,K1; SUB a,b,a
+   becomes: LDC b,-K0+K1; SUB a,b,a
+   if dead after: b */
+{3,{{"LDA",0,0,0,{0,{1,0,0,0}}},{"LDC",1,0,0,{0,{0,1,0,0}}},{"SUB",0,1,0,{0,{0,0,0,0}}}},2,{{"LDC",1,0,0,{0,{-1,1,0,0}}},{"SUB",0,1,0,{0,{0,0,0,0}}}},0x2},
+
+/* 4 times: LDA a,K0(b); LDA a,K1(a); ADD c,c,a
+   becomes: LDA a,K0+K1(b); ADD c,a,c */
+{3,{{"LDA",0,1,0,{0,{1,0,0,0}}},{"LDA",0,0,0,{0,{0,1,0,0}}},{"ADD",2,2,0,{0,{0,0,0,0}}}},2,{{"LDA",0,1,0,{0,{1,1,0,0}}},{"ADD",2,0,2,{0,{0,0,0,0}}}},0x0},
+
+/* 4 times: LDC a,K0; LDA b,K1(a)
+   becomes: LDC b,K0+K1
+   if dead after: a */
+{2,{{"LDC",0,0,0,{0,{1,0,0,0}}},{"LDA",1,0,0,{0,{0,1,0,0}}}},1,{{"LDC",1,0,0,{0,{1,1,0,0}}}},0x1},
+
+/* 4 times: LDC a,2; MUL b,a,c
+   becomes: ADD b,c,c
+   if dead after: a */
+{2,{{"LDC",0,0,0,{2,{0,0,0,0}}},{"MUL",1,0,2,{0,{0,0,0,0}}}},1,{{"ADD",1,2,2,{0,{0,0,0,0}}}},0x1},
+
+/* 4 times: LDA a,K0(b); LDA a,K1(a); LDA a,K2(a)
+   becomes: LDA a,K0(b); LDA a,K1+K2(a) */
+{3,{{"LDA",0,1,0,{0,{1,0,0,0}}},{"LDA",0,0,0,{0,{0,1,0,0}}},{"LDA",0,0,0,{0,{0,0,1,0}}}},2,{{"LDA",0,1,0,{0,{1,0,0,0}}},{"LDA",0,0,0,{0,{0,1,1,0}}}},0x0},
+
+/* 4 times: LD a,K0(b); LD c,K0(b); ADD a,a,c
+   becomes: LD c,K0(b); ADD a,c,c */
+{3,{{"LD",0,1,0,{0,{1,0,0,0}}},{"LD",2,1,0,{0,{1,0,0,0}}},{"ADD",0,0,2,{0,{0,0,0,0}}}},2,{{"LD",2,1,0,{0,{1,0,0,0}}},{"ADD",0,2,2,{0,{0,0,0,0}}}},0x0},
+
+/* 4 times: LDC a,K0; LD b,K1(c); ADD b,b,a
+   becomes: LD a,K1(c); LDA b,K0(a)
+   if dead after: a */
+{3,{{"LDC",0,0,0,{0,{1,0,0,0}}},{"LD",1,2,0,{0,{0,1,0,0}}},{"ADD",1,1,0,{0,{0,0,0,0}}}},2,{{"LD",0,2,0,{0,{0,1,0,0}}},{"LDA",1,0,0,{0,{1,0,0,0}}}},0x1},
+
+/* 4 times: LD a,K0(b); LDA a,K1(a); LD c,K0(b)
+   becomes: LD c,K0(b); LDA a,K1(c) */
+{3,{{"LD",0,1,0,{0,{1,0,0,0}}},{"LDA",0,0,0,{0,{0,1,0,0}}},{"LD",2,1,0,{0,{1,0,0,0}}}},2,{{"LD",2,1,0,{0,{1,0,0,0}}},{"LDA",0,2,0,{0,{0,1,0,0}}}},0x0},
+
+/* 3 times: LD a,K0(b); ADD c,d,a; LD e,K0(b)
+   becomes: LD e,K0(b); ADD c,d,e
+   if dead after: a */
+{3,{{"LD",0,1,0,{0,{1,0,0,0}}},{"ADD",2,3,0,{0,{0,0,0,0}}},{"LD",4,1,0,{0,{1,0,0,0}}}},2,{{"LD",4,1,0,{0,{1,0,0,0}}},{"ADD",2,3,4,{0,{0,0,0,0}}}},0x1},
+
+/* 3 times: LDA a,K0(a); LDC b,K1; SUB c,b,a
+   becomes: LDC b,-K0+K1; SUB c,b,a
+   if dead after: a b */
+{3,{{"LDA",0,0,0,{0,{1,0,0,0}}},{"LDC",1,0,0,{0,{0,1,0,0}}},{"SUB",2,1,0,{0,{0,0,0,0}}}},2,{{"LDC",1,0,0,{0,{-1,1,0,0}}},{"SUB",2,1,0,{0,{0,0,0,0}}}},0x3},
+
+/* 3 times: LDC a,2; MUL b,a,b; LDA b,2(b)
+   becomes: ADD a,b,b; LDA b,2(a)
+   if dead after: a */
+{3,{{"LDC",0,0,0,{2,{0,0,0,0}}},{"MUL",1,0,1,{0,{0,0,0,0}}},{"LDA",1,1,0,{2,{0,0,0,0}}}},2,{{"ADD",0,1,1,{0,{0,0,0,0}}},{"LDA",1,0,0,{2,{0,0,0,0}}}},0x1},
+
+/* 3 times: SUB a,b,a; LDC b,2; MUL a,b,a
+   becomes: SUB a,b,a; ADD a,a,a
+   if dead after: b */
+{3,{{"SUB",0,1,0,{0,{0,0,0,0}}},{"LDC",1,0,0,{2,{0,0,0,0}}},{"MUL",0,1,0,{0,{0,0,0,0}}}},2,{{"SUB",0,1,0,{0,{0,0,0,0}}},{"ADD",0,0,0,{0,{0,0,0,0}}}},0x2},
+
+/* 3 times: LDA a,K0(b); LDA b,K1(a)
+   becomes: LDA b,K0+K1(b)
+   if dead after: a */
+{2,{{"LDA",0,1,0,{0,{1,0,0,0}}},{"LDA",1,0,0,{0,{0,1,0,0}}}},1,{{"LDA",1,1,0,{0,{1,1,0,0}}}},0x1},
+
+/* 3 times: ST a,K0(b); LDA c,K1(c); LDA a,K2(c)
+   becomes: ST a,K0(b); LDA a,K1+K2(c)
+   if dead after: c */
+{3,{{"ST",0,1,0,{0,{1,0,0,0}}},{"LDA",2,2,0,{0,{0,1,0,0}}},{"LDA",0,2,0,{0,{0,0,1,0}}}},2,{{"ST",0,1,0,{0,{1,0,0,0}}},{"LDA",0,2,0,{0,{0,1,1,0}}}},0x4},
+
+/* 3 times: SUB a,b,a; LDC c,K0; SUB a,c,a
+   becomes: SUB a,a,b; LDA a,K0(a)
+   if dead after: c */
+{3,{{"SUB",0,1,0,{0,{0,0,0,0}}},{"LDC",2,0,0,{0,{1,0,0,0}}},{"SUB",0,2,0,{0,{0,0,0,0}}}},2,{{"SUB",0,0,1,{0,{0,0,0,0}}},{"LDA",0,0,0,{0,{1,0,0,0}}}},0x4},
+
+/* 3 times: SUB a,b,c; LDC d,0; SUB a,d,a
+   becomes: SUB a,c,b
+   if dead after: d */
+{3,{{"SUB",0,1,2,{0,{0,0,0,0}}},{"LDC",3,0,0,{0,{0,0,0,0}}},{"SUB",0,3,0,{0,{0,0,0,0}}}},1,{{"SUB",0,2,1,{0,{0,0,0,0}}}},0x8},
+
+/* 3 times: LDC a,K0; SUB b,a,b; LDA c,K1(b)
+   becomes: LDC a,K0+K1; SUB c,a,b
+   if dead after: a b */
+{3,{{"LDC",0,0,0,{0,{1,0,0,0}}},{"SUB",1,0,1,{0,{0,0,0,0}}},{"LDA",2,1,0,{0,{0,1,0,0}}}},2,{{"LDC",0,0,0,{0,{1,1,0,0}}},{"SUB",2,0,1,{0,{0,0,0,0}}}},0x3},
+
+/* 3 times: LDC a,K0; MUL a,a,b; LDC c,K0
+   becomes: LDC c,K0; MUL a,b,c */
+{3,{{"LDC",0,0,0,{0,{1,0,0,0}}},{"MUL",0,0,1,{0,{0,0,0,0}}},{"LDC",2,0,0,{0,{1,0,0,0}}}},2,{{"LDC",2,0,0,{0,{1,0,0,0}}},{"MUL",0,1,2,{0,{0,0,0,0}}}},0x0},
+
+/* 3 times: LDA a,K0(a); LDA a,K1(a); LDC b,K0
+   becomes: LDA a,K0+K1(a); LDC b,K0 */
+{3,{{"LDA",0,0,0,{0,{1,0,0,0}}},{"LDA",0,0,0,{0,{0,1,0,0}}},{"LDC",1,0,0,{0,{1,0,0,0}}}},2,{{"LDA",0,0,0,{0,{1,1,0,0}}},{"LDC",1,0,0,{0,{1,0,0,0}}}},0x0},
+
+/* 3 times: LDA a,-1(a); LDC b,2; MUL a,b,a
+   becomes: ADD a,a,a; LDA a,-2(a)
+   if dead after: b */
+{3,{{"LDA",0,0,0,{-1,{0,0,0,0}}},{"LDC",1,0,0,{2,{0,0,0,0}}},{"MUL",0,1,0,{0,{0,0,0,0}}}},2,{{"ADD",0,0,0,{0,{0,0,0,0}}},{"LDA",0,0,0,{-2,{0,0,0,0}}}},0x2},
+
+/* 3 times: LDA a,K0(b); LDA c,K1(a); LDC d,K2
+   becomes: LDA c,K0+K1(b); LDC d,K2
+   if dead after: a */
+{3,{{"LDA",0,1,0,{0,{1,0,0,0}}},{"LDA",2,0,0,{0,{0,1,0,0}}},{"LDC",3,0,0,{0,{0,0,1,0}}}},2,{{"LDA",2,1,0,{0,{1,1,0,0}}},{"LDC",3,0,0,{0,{0,0,1,0}}}},0x1},
+
+/* 3 times: LDA a,K0(a); LDA b,K1(a); LDC c,K2
+   becomes: LDA b,K0+K1(a); LDC c,K2
+   if dead after: a */
+{3,{{"LDA",0,0,0,{0,{1,0,0,0}}},{"LDA",1,0,0,{0,{0,1,0,0}}},{"LDC",2,0,0,{0,{0,0,1,0}}}},2,{{"LDA",1,0,0,{0,{1,1,0,0}}},{"LDC",2,0,0,{0,{0,0,1,0}}}},0x1},
+
+/* 3 times: SUB a,b,a; LDC b,K0; SUB a,b,a
+   becomes: SUB a,a,b; LDA a,K0(a)
+   if dead after: b */
+{3,{{"SUB",0,1,0,{0,{0,0,0,0}}},{"LDC",1,0,0,{0,{1,0,0,0}}},{"SUB",0,1,0,{0,{0,0,0,0}}}},2,{{"SUB",0,0,1,{0,{0,0,0,0}}},{"LDA",0,0,0,{0,{1,0,0,0}}}},0x2},
+
+/* 3 times: SUB a,b,a; LDC b,K0; SUB c,b,a
+   becomes: SUB a,a,b; LDA c,K0(a)
+   if dead after: a b */
+{3,{{"SUB",0,1,0,{0,{0,0,0,0}}},{"LDC",1,0,0,{0,{1,0,0,0}}},{"SUB",2,1,0,{0,{0,0,0,0}}}},2,{{"SUB",0,0,1,{0,{0,0,0,0}}},{"LDA",2,0,0,{0,{1,0,0,0}}}},0x3},
+
+/* 3 times: LDC a,0; SUB a,a,b; LDA a,K0(a)
+   becomes: LDC a,K0; SUB a,a,b */
+{3,{{"LDC",0,0,0,{0,{0,0,0,0}}},{"SUB",0,0,1,{0,{0,0,0,0}}},{"LDA",0,0,0,{0,{1,0,0,0}}}},2,{{"LDC",0,0,0,{0,{1,0,0,0}}},{"SUB",0,0,1,{0,{0,0,0,0}}}},0x0},
+
+/* 3 times: LDA a,K0(b); LDA a,K1(a); LDA c,K2(a)
+   becomes: LDA a,K0+K1(b); LDA c,K2(a) */
+{3,{{"LDA",0,1,0,{0,{1,0,0,0}}},{"LDA",0,0,0,{0,{0,1,0,0}}},{"LDA",2,0,0,{0,{0,0,1,0}}}},2,{{"LDA",0,1,0,{0,{1,1,0,0}}},{"LDA",2,0,0,{0,{0,0,1,0}}}},0x0},
+
+/* 3 times: LDC a,K0; SUB a,a,b; ADD c,c,a
+   becomes: SUB a,c,b; LDA c,K0(a)
+   if dead after: a */
+{3,{{"LDC",0,0,0,{0,{1,0,0,0}}},{"SUB",0,0,1,{0,{0,0,0,0}}},{"ADD",2,2,0,{0,{0,0,0,0}}}},2,{{"SUB",0,2,1,{0,{0,0,0,0}}},{"LDA",2,0,0,{0,{1,0,0,0}}}},0x1},
+
+/* 3 times: LDC a,0; LDA a,K0(a); LD b,K1(c)
+   becomes: LD b,K1(c); LDC a,K0 */
+{3,{{"LDC",0,0,0,{0,{0,0,0,0}}},{"LDA",0,0,0,{0,{1,0,0,0}}},{"LD",1,2,0,{0,{0,1,0,0}}}},2,{{"LD",1,2,0,{0,{0,1,0,0}}},{"LDC",0,0,0,{0,{1,0,0,0}}}},0x0},
+
+/* 3 times: SUB a,a,b; LDA a,K0(a); LDA a,K1(a)
+   becomes: SUB a,a,b; LDA a,K0+K1(a) */
+{3,{{"SUB",0,0,1,{0,{0,0,0,0}}},{"LDA",0,0,0,{0,{1,0,0,0}}},{"LDA",0,0,0,{0,{0,1,0,0}}}},2,{{"SUB",0,0,1,{0,{0,0,0,0}}},{"LDA",0,0,0,{0,{1,1,0,0}}}},0x0},
+
+/* 2 times: LDC a,0; SUB b,c,a; LD d,K0(e)
+   becomes: LD d,K0(e); LDA b,0(c)
+   if dead after: a */
+{3,{{"LDC",0,0,0,{0,{0,0,0,0}}},{"SUB",1,2,0,{0,{0,0,0,0}}},{"LD",3,4,0,{0,{1,0,0,0}}}},2,{{"LD",3,4,0,{0,{1,0,0,0}}},{"LDA",1,2,0,{0,{0,0,0,0}}}},0x1},
+
+/* 2 times: ST a,K0(b); LDA c,K1(a); LD a,K0(b)
+   becomes: ST a,K0(b); LDA c,K1(a) */
+{3,{{"ST",0,1,0,{0,{1,0,0,0}}},{"LDA",2,0,0,{0,{0,1,0,0}}},{"LD",0,1,0,{0,{1,0,0,0}}}},2,{{"ST",0,1,0,{0,{1,0,0,0}}},{"LDA",2,0,0,{0,{0,1,0,0}}}},0x0},
+
+/* 2 times: LDC a,K0; LDC b,0; ADD b,b,a
+   becomes: LDC b,K0
+   if dead after: a */
+{3,{{"LDC",0,0,0,{0,{1,0,0,0}}},{"LDC",1,0,0,{0,{0,0,0,0}}},{"ADD",1,1,0,{0,{0,0,0,0}}}},1,{{"LDC",1,0,0,{0,{1,0,0,0}}}},0x1},
+
+/* 2 times: LDC a,0; ADD a,a,b
+   becomes: LDA a,0(b) */
+{2,{{"LDC",0,0,0,{0,{0,0,0,0}}},{"ADD",0,0,1,{0,{0,0,0,0}}}},1,{{"LDA",0,1,0,{0,{0,0,0,0}}}},0x0},
+
+/* 2 times: LDC a,0; ADD a,a,b; LDA c,K0(c)
+   becomes: LDA a,0(b); LDA c,K0(c) */
+{3,{{"LDC",0,0,0,{0,{0,0,0,0}}},{"ADD",0,0,1,{0,{0,0,0,0}}},{"LDA",2,2,0,{0,{1,0,0,0}}}},2,{{"LDA",0,1,0,{0,{0,0,0,0}}},{"LDA",2,2,0,{0,{1,0,0,0}}}},0x0},
+
+/* 2 times: LDC a,0; MUL b,a,b
+   becomes: SUB b,a,a
+   if dead after: a */
+{2,{{"LDC",0,0,0,{0,{0,0,0,0}}},{"MUL",1,0,1,{0,{0,0,0,0}}}},1,{{"SUB",1,0,0,{0,{0,0,0,0}}}},0x1},
+
+/* 2 times: LDA a,K0(b); LDA a,K1(a); SUB a,c,a
+   becomes: LDA a,K0+K1(b); SUB a,c,a */
+{3,{{"LDA",0,1,0,{0,{1,0,0,0}}},{"LDA",0,0,0,{0,{0,1,0,0}}},{"SUB",0,2,0,{0,{0,0,0,0}}}},2,{{"LDA",0,1,0,{0,{1,1,0,0}}},{"SUB",0,2,0,{0,{0,0,0,0}}}},0x0},
+
+/* 2 times: LDC a,0; ADD b,c,a
+   becomes: LDA b,0(c)
+   if dead after: a */
+{2,{{"LDC",0,0,0,{0,{0,0,0,0}}},{"ADD",1,2,0,{0,{0,0,0,0}}}},1,{{"LDA",1,2,0,{0,{0,0,0,0}}}},0x1},
+
+/* 2 times: LDC a,0; LDC b,K0; MUL b,b,a
+   becomes: SUB b,a,a
+   if dead after: a */
+{3,{{"LDC",0,0,0,{0,{0,0,0,0}}},{"LDC",1,0,0,{0,{1,0,0,0}}},{"MUL",1,1,0,{0,{0,0,0,0}}}},1,{{"SUB",1,0,0,{0,{0,0,0,0}}}},0x1},
+
+/* 2 times: LDC a,K0; SUB b,a,b; SUB c,c,b
+   becomes: ADD a,b,c; LDA c,-K0(a)
+   if dead after: a b */
+{3,{{"LDC",0,0,0,{0,{1,0,0,0}}},{"SUB",1,0,1,{0,{0,0,0,0}}},{"SUB",2,2,1,{0,{0,0,0,0}}}},2,{{"ADD",0,1,2,{0,{0,0,0,0}}},{"LDA",2,0,0,{0,{-1,0,0,0}}}},0x3},
+
+/* 2 times: LDC a,2; MUL a,a,b; LD c,7(d)
+   becomes: ADD a,b,b; LD c,7(d) */
+{3,{{"LDC",0,0,0,{2,{0,0,0,0}}},{"MUL",0,0,1,{0,{0,0,0,0}}},{"LD",2,3,0,{7,{0,0,0,0}}}},2,{{"ADD",0,1,1,{0,{0,0,0,0}}},{"LD",2,3,0,{7,{0,0,0,0}}}},0x0},
+
+/* 2 times: ST a,K0(b); LD a,K0(b)
+   becomes: ST a,K0(b) */
+{2,{{"ST",0,1,0,{0,{1,0,0,0}}},{"LD",0,1,0,{0,{1,0,0,0}}}},1,{{"ST",0,1,0,{0,{1,0,0,0}}}},0x0},
+
+/* 2 times: LDC a,K0; SUB a,a,b; SUB a,c,a
+   becomes: ADD a,b,c; LDA a,-K0(a) */
+{3,{{"LDC",0,0,0,{0,{1,0,0,0}}},{"SUB",0,0,1,{0,{0,0,0,0}}},{"SUB",0,2,0,{0,{0,0,0,0}}}},2,{{"ADD",0,1,2,{0,{0,0,0,0}}},{"LDA",0,0,0,{0,{-1,0,0,0}}}},0x0},
+
+/* 2 times: LDA a,K0(b); LDA b,K1(a); LDA b,K2(b)
+   becomes: LDA a,K0(b); LDA b,K1+K2(a) */
+{3,{{"LDA",0,1,0,{0,{1,0,0,0}}},{"LDA",1,0,0,{0,{0,1,0,0}}},{"LDA",1,1,0,{0,{0,0,1,0}}}},2,{{"LDA",0,1,0,{0,{1,0,0,0}}},{"LDA",1,0,0,{0,{0,1,1,0}}}},0x0},
+
+/* 2 times: LDA a,K0(b); LDA a,K1(a); MUL c,b,a
+   becomes: LDA a,K0+K1(b); MUL c,a,b */
+{3,{{"LDA",0,1,0,{0,{1,0,0,0}}},{"LDA",0,0,0,{0,{0,1,0,0}}},{"MUL",2,1,0,{0,{0,0,0,0}}}},2,{{"LDA",0,1,0,{0,{1,1,0,0}}},{"MUL",2,0,1,{0,{0,0,0,0}}}},0x0},
+
+/* 2 times: LDA a,K0(b); LDA b,K1(c); LDA b,K2(b)
+   becomes: LDA a,K0(b); LDA b,K1+K2(c) */
+{3,{{"LDA",0,1,0,{0,{1,0,0,0}}},{"LDA",1,2,0,{0,{0,1,0,0}}},{"LDA",1,1,0,{0,{0,0,1,0}}}},2,{{"LDA",0,1,0,{0,{1,0,0,0}}},{"LDA",1,2,0,{0,{0,1,1,0}}}},0x0},
+
+/* 2 times: ADD a,a,b; LDA c,K0(c); LDA b,K1(c)
+   becomes: ADD a,a,b; LDA b,K0+K1(c)
+   if dead after: c */
+{3,{{"ADD",0,0,1,{0,{0,0,0,0}}},{"LDA",2,2,0,{0,{1,0,0,0}}},{"LDA",1,2,0,{0,{0,1,0,0}}}},2,{{"ADD",0,0,1,{0,{0,0,0,0}}},{"LDA",1,2,0,{0,{1,1,0,0}}}},0x4},
+
+/* 2 times: LD a,K0(b); LDA c,K1(c); LDA d,K2(c)
+   becomes: LD a,K0(b); LDA d,K1+K2(c)
+   if dead after: c */
+{3,{{"LD",0,1,0,{0,{1,0,0,0}}},{"LDA",2,2,0,{0,{0,1,0,0}}},{"LDA",3,2,0,{0,{0,0,1,0}}}},2,{{"LD",0,1,0,{0,{1,0,0,0}}},{"LDA",3,2,0,{0,{0,1,1,0}}}},0x4},
+
+/* 2 times: LDA a,K0(b); LDC c,K1; SUB c,c,a
+   becomes: LDC a,-K0+K1; SUB c,a,b
+   if dead after: a */
+{3,{{"LDA",0,1,0,{0,{1,0,0,0}}},{"LDC",2,0,0,{0,{0,1,0,0}}},{"SUB",2,2,0,{0,{0,0,0,0}}}},2,{{"LDC",0,0,0,{0,{-1,1,0,0}}},{"SUB",2,0,1,{0,{0,0,0,0}}}},0x1},
+
+/* 2 times: LDC a,0; SUB a,a,b; ADD a,c,a
+   becomes: SUB a,c,b */
+{3,{{"LDC",0,0,0,{0,{0,0,0,0}}},{"SUB",0,0,1,{0,{0,0,0,0}}},{"ADD",0,2,0,{0,{0,0,0,0}}}},1,{{"SUB",0,2,1,{0,{0,0,0,0}}}},0x0},
+
+/* 2 times: LDC a,2; MUL b,c,a; ADD d,c,b
+   becomes: ADD b,c,c; ADD d,b,c
+   if dead after: a */
+{3,{{"LDC",0,0,0,{2,{0,0,0,0}}},{"MUL",1,2,0,{0,{0,0,0,0}}},{"ADD",3,2,1,{0,{0,0,0,0}}}},2,{{"ADD",1,2,2,{0,{0,0,0,0}}},{"ADD",3,1,2,{0,{0,0,0,0}}}},0x1},
+
+/* 2 times: ADD a,b,c; LDA c,K0(b); LDA c,K1(c)
+   becomes: ADD a,b,c; LDA c,K0+K1(b) */
+{3,{{"ADD",0,1,2,{0,{0,0,0,0}}},{"LDA",2,1,0,{0,{1,0,0,0}}},{"LDA",2,2,0,{0,{0,1,0,0}}}},2,{{"ADD",0,1,2,{0,{0,0,0,0}}},{"LDA",2,1,0,{0,{1,1,0,0}}}},0x0},
+
+/* 2 times: ADD a,a,b; LDC b,2; MUL b,b,a
+   becomes: ADD a,a,b; ADD b,a,a */
+{3,{{"ADD",0,0,1,{0,{0,0,0,0}}},{"LDC",1,0,0,{2,{0,0,0,0}}},{"MUL",1,1,0,{0,{0,0,0,0}}}},2,{{"ADD",0,0,1,{0,{0,0,0,0}}},{"ADD",1,0,0,{0,{0,0,0,0}}}},0x0},
+
+/* 2 times: LDC a,2; MUL a,a,b; LDA c,2(a)
+   becomes: ADD a,b,b; LDA c,2(a) */
+{3,{{"LDC",0,0,0,{2,{0,0,0,0}}},{"MUL",0,0,1,{0,{0,0,0,0}}},{"LDA",2,0,0,{2,{0,0,0,0}}}},2,{{"ADD",0,1,1,{0,{0,0,0,0}}},{"LDA",2,0,0,{2,{0,0,0,0}}}},0x0},
+
+/* 2 times: LDC a,0; SUB b,a,b; SUB b,c,b
+   becomes: ADD b,b,c
+   if dead after: a */
+{3,{{"LDC",0,0,0,{0,{0,0,0,0}}},{"SUB",1,0,1,{0,{0,0,0,0}}},{"SUB",1,2,1,{0,{0,0,0,0}}}},1,{{"ADD",1,1,2,{0,{0,0,0,0}}}},0x1},
+
+/* 2 times: LDC a,2; MUL a,a,b; SUB a,c,a
+   becomes: ADD a,b,b; SUB a,c,a */
+{3,{{"LDC",0,0,0,{2,{0,0,0,0}}},{"MUL",0,0,1,{0,{0,0,0,0}}},{"SUB",0,2,0,{0,{0,0,0,0}}}},2,{{"ADD",0,1,1,{0,{0,0,0,0}}},{"SUB",0,2,0,{0,{0,0,0,0}}}},0x0},
+
+/* 2 times: LDC a,K0; SUB b,a,b; LDA b,K1(b)
+   becomes: LDC a,K0+K1; SUB b,a,b
+   if dead after: a */
+{3,{{"LDC",0,0,0,{0,{1,0,0,0}}},{"SUB",1,0,1,{0,{0,0,0,0}}},{"LDA",1,1,0,{0,{0,1,0,0}}}},2,{{"LDC",0,0,0,{0,{1,1,0,0}}},{"SUB",1,0,1,{0,{0,0,0,0}}}},0x1},
+
+/* 2 times: LDA a,-5(b); LDA c,-5(d); ADD c,a,c
+   becomes: ADD a,b,d; LDA c,-10(a)
+   if dead after: a */
+{3,{{"LDA",0,1,0,{-5,{0,0,0,0}}},{"LDA",2,3,0,{-5,{0,0,0,0}}},{"ADD",2,0,2,{0,{0,0,0,0}}}},2,{{"ADD",0,1,3,{0,{0,0,0,0}}},{"LDA",2,0,0,{-10,{0,0,0,0}}}},0x1},
+
+/* 2 times: LDA a,-5(b); ADD a,c,a; LDA a,-5(a)
+   becomes: ADD a,b,c; LDA a,-10(a) */
+{3,{{"LDA",0,1,0,{-5,{0,0,0,0}}},{"ADD",0,2,0,{0,{0,0,0,0}}},{"LDA",0,0,0,{-5,{0,0,0,0}}}},2,{{"ADD",0,1,2,{0,{0,0,0,0}}},{"LDA",0,0,0,{-10,{0,0,0,0}}}},0x0},
+
+/* 2 times: LDC a,2; MUL b,a,b; ST b,10(c)
+   becomes: ADD b,b,b; ST b,10(c)
+   if dead after: a */
+{3,{{"LDC",0,0,0,{2,{0,0,0,0}}},{"MUL",1,0,1,{0,{0,0,0,0}}},{"ST",1,2,0,{10,{0,0,0,0}}}},2,{{"ADD",1,1,1,{0,{0,0,0,0}}},{"ST",1,2,0,{10,{0,0,0,0}}}},0x1},
+
+/* 2 times: LDC a,2; MUL b,a,b; LDC a,4
+   becomes: ADD b,b,b; LDC a,4 */
+{3,{{"LDC",0,0,0,{2,{0,0,0,0}}},{"MUL",1,0,1,{0,{0,0,0,0}}},{"LDC",0,0,0,{4,{0,0,0,0}}}},2,{{"ADD",1,1,1,{0,{0,0,0,0}}},{"LDC",0,0,0,{4,{0,0,0,0}}}},0x0},
+
+/* 2 times: MUL a,b,c; LDA c,K0(a); LDA d,K1(c)
+   becomes: MUL a,b,c; LDA d,K0+K1(a)
+   if dead after: c */
+{3,{{"MUL",0,1,2,{0,{0,0,0,0}}},{"LDA",2,0,0,{0,{1,0,0,0}}},{"LDA",3,2,0,{0,{0,1,0,0}}}},2,{{"MUL",0,1,2,{0,{0,0,0,0}}},{"LDA",3,0,0,{0,{1,1,0,0}}}},0x4},
+
+/* 2 times: LD a,K0(b); LDA a,K1(a); LDA c,K2(a)
+   becomes: LD a,K0(b); LDA c,K1+K2(a)
+   if dead after: a */
+{3,{{"LD",0,1,0,{0,{1,0,0,0}}},{"LDA",0,0,0,{0,{0,1,0,0}}},{"LDA",2,0,0,{0,{0,0,1,0}}}},2,{{"LD",0,1,0,{0,{1,0,0,0}}},{"LDA",2,0,0,{0,{0,1,1,0}}}},0x1},
+
+/* 2 times: LDA a,K0(b); ADD a,b,a; LDA a,K1(a)
+   becomes: ADD a,b,b; LDA a,K0+K1(a) */
+{3,{{"LDA",0,1,0,{0,{1,0,0,0}}},{"ADD",0,1,0,{0,{0,0,0,0}}},{"LDA",0,0,0,{0,{0,1,0,0}}}},2,{{"ADD",0,1,1,{0,{0,0,0,0}}},{"LDA",0,0,0,{0,{1,1,0,0}}}},0x0},
+
+/* 2 times: SUB a,b,a; LDA c,K0(a); LDA a,K1(c)
+   becomes: SUB a,b,a; LDA a,K0+K1(a)
+   if dead after: c */
+{3,{{"SUB",0,1,0,{0,{0,0,0,0}}},{"LDA",2,0,0,{0,{1,0,0,0}}},{"LDA",0,2,0,{0,{0,1,0,0}}}},2,{{"SUB",0,1,0,{0,{0,0,0,0}}},{"LDA",0,0,0,{0,{1,1,0,0}}}},0x4},
+
+/* 2 times: LDA a,K0(b); LDC c,K0; SUB d,c,a
+   becomes: ADD a,b,b; SUB d,b,a
+   if dead after: a c */
+{3,{{"LDA",0,1,0,{0,{1,0,0,0}}},{"LDC",2,0,0,{0,{1,0,0,0}}},{"SUB",3,2,0,{0,{0,0,0,0}}}},2,{{"ADD",0,1,1,{0,{0,0,0,0}}},{"SUB",3,1,0,{0,{0,0,0,0}}}},0x5},
+
+/* 2 times: LDC a,K0; SUB b,a,b; ADD c,d,b
+   becomes: SUB a,d,b; LDA c,K0(a)
+   if dead after: a b */
+{3,{{"LDC",0,0,0,{0,{1,0,0,0}}},{"SUB",1,0,1,{0,{0,0,0,0}}},{"ADD",2,3,1,{0,{0,0,0,0}}}},2,{{"SUB",0,3,1,{0,{0,0,0,0}}},{"LDA",2,0,0,{0,{1,0,0,0}}}},0x3},
+
+/* 2 times: ST a,K0(b); LDA a,K1(c); LDA a,K2(a)
+   becomes: ST a,K0(b); LDA a,K1+K2(c) */
+{3,{{"ST",0,1,0,{0,{1,0,0,0}}},{"LDA",0,2,0,{0,{0,1,0,0}}},{"LDA",0,0,0,{0,{0,0,1,0}}}},2,{{"ST",0,1,0,{0,{1,0,0,0}}},{"LDA",0,2,0,{0,{0,1,1,0}}}},0x0},
+
+/* 2 times: LDA a,K0(b); LDA a,K1(a); ST a,K2(c)
+   becomes: LDA a,K0+K1(b); ST a,K2(c) */
+{3,{{"LDA",0,1,0,{0,{1,0,0,0}}},{"LDA",0,0,0,{0,{0,1,0,0}}},{"ST",0,2,0,{0,{0,0,1,0}}}},2,{{"LDA",0,1,0,{0,{1,1,0,0}}},{"ST",0,2,0,{0,{0,0,1,0}}}},0x0},
+
+/* 2 times: LDA a,K0(a); LDA a,K1(a); LDA a,K2(a)
+   becomes: LDA a,K0(a); LDA a,K1+K2(a) */
+{3,{{"LDA",0,0,0,{0,{1,0,0,0}}},{"LDA",0,0,0,{0,{0,1,0,0}}},{"LDA",0,0,0,{0,{0,0,1,0}}}},2,{{"LDA",0,0,0,{0,{1,0,0,0}}},{"LDA",0,0,0,{0,{0,1,1,0}}}},0x0},
+
+/* 2 times: LDC a,K0; LDC b,K0; ST b,K1(c)
+   becomes: LDC a,K0; ST a,K1(c)
+   if dead after: b */
+{3,{{"LDC",0,0,0,{0,{1,0,0,0}}},{"LDC",1,0,0,{0,{1,0,0,0}}},{"ST",1,2,0,{0,{0,1,0,0}}}},2,{{"LDC",0,0,0,{0,{1,0,0,0}}},{"ST",0,2,0,{0,{0,1,0,0}}}},0x2},
+
+/* 2 times: LD a,K0(b); LDA c,K1(a); LD a,K0(b)
+   becomes: LD a,K0(b); LDA c,K1(a) */
+{3,{{"LD",0,1,0,{0,{1,0,0,0}}},{"LDA",2,0,0,{0,{0,1,0,0}}},{"LD",0,1,0,{0,{1,0,0,0}}}},2,{{"LD",0,1,0,{0,{1,0,0,0}}},{"LDA",2,0,0,{0,{0,1,0,0}}}},0x0},
+
+/* 2 times: LDA a,5(b); LDA c,5(a)
+   becomes: LDA c,10(b)
+   if dead after: a */
+{2,{{"LDA",0,1,0,{5,{0,0,0,0}}},{"LDA",2,0,0,{5,{0,0,0,0}}}},1,{{"LDA",2,1,0,{10,{0,0,0,0}}}},0x1},
+
+/* 2 times: MUL a,a,b; LDA b,8(c); LDA b,8(b)
+   becomes: MUL a,a,b; LDA b,16(c) */
+{3,{{"MUL",0,0,1,{0,{0,0,0,0}}},{"LDA",1,2,0,{8,{0,0,0,0}}},{"LDA",1,1,0,{8,{0,0,0,0}}}},2,{{"MUL",0,0,1,{0,{0,0,0,0}}},{"LDA",1,2,0,{16,{0,0,0,0}}}},0x0},
+
+/* 2 times: LDA a,8(b); LDA a,8(a)
+   becomes: LDA a,16(b) */
+{2,{{"LDA",0,1,0,{8,{0,0,0,0}}},{"LDA",0,0,0,{8,{0,0,0,0}}}},1,{{"LDA",0,1,0,{16,{0,0,0,0}}}},0x0},
+
+/* 2 times: LDA a,8(b); LDA a,8(a); LDA b,8(a)
+   becomes: LDA a,16(b); LDA b,8(a) */
+{3,{{"LDA",0,1,0,{8,{0,0,0,0}}},{"LDA",0,0,0,{8,{0,0,0,0}}},{"LDA",1,0,0,{8,{0,0,0,0}}}},2,{{"LDA",0,1,0,{16,{0,0,0,0}}},{"LDA",1,0,0,{8,{0,0,0,0}}}},0x0},
+
+/* 2 times: LDA a,8(a); LDA b,8(a)
+   becomes: LDA b,16(a)
+   if dead after: a */
+{2,{{"LDA",0,0,0,{8,{0,0,0,0}}},{"LDA",1,0,0,{8,{0,0,0,0}}}},1,{{"LDA",1,0,0,{16,{0,0,0,0}}}},0x1},
+
+/* 2 times: LDA a,8(a); LDA b,8(a); LDA a,-7(c)
+   becomes: LDA b,16(a); LDA a,-7(c) */
+{3,{{"LDA",0,0,0,{8,{0,0,0,0}}},{"LDA",1,0,0,{8,{0,0,0,0}}},{"LDA",0,2,0,{-7,{0,0,0,0}}}},2,{{"LDA",1,0,0,{16,{0,0,0,0}}},{"LDA",0,2,0,{-7,{0,0,0,0}}}},0x0},
+
+/* 2 times: LDC a,K0; LDC b,K0; LDA c,K1(b)
+   becomes: LDC a,K0; LDA c,K1(a)
+   if dead after: b */
+{3,{{"LDC",0,0,0,{0,{1,0,0,0}}},{"LDC",1,0,0,{0,{1,0,0,0}}},{"LDA",2,1,0,{0,{0,1,0,0}}}},2,{{"LDC",0,0,0,{0,{1,0,0,0}}},{"LDA",2,0,0,{0,{0,1,0,0}}}},0x2},
+
+/* 2 times: LDC a,K0; LDA b,K1(a); ST b,K2(c)
+   becomes: LDC b,K0+K1; ST b,K2(c)
+   if dead after: a */
+{3,{{"LDC",0,0,0,{0,{1,0,0,0}}},{"LDA",1,0,0,{0,{0,1,0,0}}},{"ST",1,2,0,{0,{0,0,1,0}}}},2,{{"LDC",1,0,0,{0,{1,1,0,0}}},{"ST",1,2,0,{0,{0,0,1,0}}}},0x1},
+
+/* 2 times: LDA a,K0(a); LDA b,K1(a); LDA a,K2(c)
+   becomes: LDA b,K0+K1(a); LDA a,K2(c) */
+{3,{{"LDA",0,0,0,{0,{1,0,0,0}}},{"LDA",1,0,0,{0,{0,1,0,0}}},{"LDA",0,2,0,{0,{0,0,1,0}}}},2,{{"LDA",1,0,0,{0,{1,1,0,0}}},{"LDA",0,2,0,{0,{0,0,1,0}}}},0x0},
+
+/* 2 times: LDA a,0(b); LDA b,0(c); SUB b,b,a
+   becomes: SUB b,c,b
+   if dead after: a */
+{3,{{"LDA",0,1,0,{0,{0,0,0,0}}},{"LDA",1,2,0,{0,{0,0,0,0}}},{"SUB",1,1,0,{0,{0,0,0,0}}}},1,{{"SUB",1,2,1,{0,{0,0,0,0}}}},0x1},
+
+/* 2 times: LDA a,0(b); SUB a,a,c
+   becomes: SUB a,b,c */
+{2,{{"LDA",0,1,0,{0,{0,0,0,0}}},{"SUB",0,0,2,{0,{0,0,0,0}}}},1,{{"SUB",0,1,2,{0,{0,0,0,0}}}},0x0},
+
+/* 2 times: LDC a,0; LDA a,K0(a); ADD b,a,b
+   becomes: LDA b,K0(b)
+   if dead after: a */
+{3,{{"LDC",0,0,0,{0,{0,0,0,0}}},{"LDA",0,0,0,{0,{1,0,0,0}}},{"ADD",1,0,1,{0,{0,0,0,0}}}},1,{{"LDA",1,1,0,{0,{1,0,0,0}}}},0x1},
+
+/* 2 times: LDC a,0; MUL b,c,d; ADD a,a,b
+   becomes: MUL a,c,d
+   if dead after: b */
+{3,{{"LDC",0,0,0,{0,{0,0,0,0}}},{"MUL",1,2,3,{0,{0,0,0,0}}},{"ADD",0,0,1,{0,{0,0,0,0}}}},1,{{"MUL",0,2,3,{0,{0,0,0,0}}}},0x2},
@@ -49,19 +49,28 @@ typedef struct BucketListRec
    { char * name;
      LineList lines;
      int memloc ; /* memory location for variable */
+     int size ; /* number of elements, 0 for a scalar */
 	 DeclKind kind;  // int or char
+     TreeNode * decl ; /* declaration of a procedure */
      struct BucketListRec * next;
    } * BucketList;
 
 /* the hash table */
 static BucketList hashTable[SIZE];
 
+/* one past the highest memory location
+   handed out so far */
+static int maxLoc = 0;
+
 /* Procedure st_insert inserts line numbers and
  * memory locations into the symbol table
  * loc = memory location is inserted only the
  * first time, otherwise ignored
+ * size = number of elements of an array, which
+ * takes the locations loc to loc+size-1, or 0
+ * for a scalar
  */
-void st_insert( char * name, int lineno, int loc ,DeclKind declkind)
+void st_insert( char * name, int lineno, int loc, int size, DeclKind declkind)
 { int h = hash(name);
   BucketList l =  hashTable[h];
   while ((l != NULL) && (strcmp(name,l->name) != 0))
@@ -72,7 +81,11 @@ void st_insert( char * name, int lineno, int loc ,DeclKind declkind)
     l->lines = (LineList) malloc(sizeof(struct LineListRec));
     l->lines->lineno = lineno;
     l->memloc = loc;
+    l->size = size;
+    if (loc + (size > 0 ? size : 1) > maxLoc)
+      maxLoc = loc + (size > 0 ? size : 1);
 	l->kind = declkind;
+    l->decl = NULL;
     l->lines->next = NULL;
     l->next = hashTable[h];
     hashTable[h] = l; }
@@ -88,6 +101,29 @@ void st_insert( char * name, int lineno, int loc ,DeclKind declkind)
   }
 } /* st_insert */
 
+/* Procedure st_insertProc enters procedure name,
+ * declared by decl, which takes no memory location
+ */
+void st_insertProc( char * name, int lineno, TreeNode * decl)
+{ BucketList l;
+  st_insert(name,lineno,-1,0,ProcK);
+  for (l=hashTable[hash(name)];strcmp(name,l->name) != 0;l = l->next)
+    ;
+  l->decl = decl;
+}
+
+/* Function st_proc returns the declaration of
+ * procedure name, or NULL if there is none
+ */
+TreeNode * st_proc( char * name)
+{ int h = hash(name);
+  BucketList l =  hashTable[h];
+  while ((l != NULL) && (strcmp(name,l->name) != 0))
+    l = l->next;
+  if (l == NULL) return NULL;
+  else return l->decl;
+}
+
 /* Function st_lookup returns the memory 
  * location of a variable or -1 if not found
  */
@@ -113,6 +149,154 @@ DeclKind st_returnType(char * name)
     else return l->kind;
 }
 
+/* Function st_size returns the number of
+ * elements of an array, or 0 if name is a
+ * scalar (or not in the table)
+ */
+int st_size(char * name)
+{ int h = hash(name);
+  BucketList l =  hashTable[h];
+  while ((l != NULL) && (strcmp(name,l->name) != 0))
+    l = l->next;
+  if (l == NULL) return 0;
+  else return l->size;
+}
+
+/* Function st_maxloc returns one past the
+ * highest variable memory location, i.e. the
+ * size of the global data area
+ */
+int st_maxloc(void)
+{ return maxLoc;
+}
+
+/* the initial value of each memory location
+   below maxInit; the others start out as 0 */
+static int * initVal = NULL;
+static int maxInit = 0;
+
+/* Procedure st_setInit gives memory location loc
+ * the initial value val, which it holds when the
+ * program starts instead of 0
+ */
+void st_setInit( int loc, int val)
+{ int k, n;
+  if (loc < 0) return;
+  if (loc >= maxInit)
+  { n = loc + 64;
+    initVal = (int *) realloc(initVal,n * sizeof(int));
+    if (initVal == NULL)
+    { fprintf(stderr,"Out of memory error in symbol table\n");
+      exit(1);
+    }
+    for (k=maxInit;k<n;k++) initVal[k] = 0;
+    maxInit = n;
+  }
+  initVal[loc] = val;
+}
+
+/* Function st_init returns the initial value of
+ * memory location loc
+ */
+int st_init( int loc)
+{ return ((loc >= 0) && (loc < maxInit)) ? initVal[loc] : 0;
+}
+
+/* the data area as last laid out: the address
+   and kind (TRUE for a char) of each memory
+   location, and its size in words */
+static int * addr = NULL;
+static int * isByte = NULL;
+static int laidOut = -1;
+static int dataSize = 0;
+
+/* Procedure layout lays out the data area if a
+ * location was handed out since it last was
+ */
+static void layout(void)
+{ BucketList l;
+  int i, j, words = 0, bytes = 0;
+  if (laidOut == maxLoc) return;
+  free(addr);
+  free(isByte);
+  addr = (int *) calloc(maxLoc+1,sizeof(int));
+  isByte = (int *) calloc(maxLoc+1,sizeof(int));
+  if ((addr == NULL) || (isByte == NULL))
+  { fprintf(stderr,"Out of memory error in data layout\n");
+    exit(1);
+  }
+  for (i=0;i<SIZE;i++)
+    for (l=hashTable[i];l != NULL;l = l->next)
+      if ((l->memloc >= 0) && (l->kind == CharK))
+        for (j=0;j<((l->size > 0) ? l->size : 1);j++)
+          isByte[l->memloc+j] = TRUE;
+  for (i=0;i<maxLoc;i++)
+    if (! isByte[i]) addr[i] = words++;
+  for (i=0;i<maxLoc;i++)
+    if (isByte[i]) addr[i] = BYTESPERWORD*words + bytes++;
+  dataSize = words + (bytes + BYTESPERWORD-1) / BYTESPERWORD;
+  laidOut = maxLoc;
+}
+
+/* Function st_addr returns the address in the
+ * data area of memory location loc: chars are
+ * packed four to a word after all the other
+ * variables and have byte addresses, the others
+ * have word addresses
+ */
+int st_addr( int loc)
+{ layout();
+  return ((loc >= 0) && (loc < maxLoc)) ? addr[loc] : loc;
+}
+
+/* Function st_isByte is TRUE if memory location
+ * loc holds a char, which is loaded and stored a
+ * byte at a time
+ */
+int st_isByte( int loc)
+{ layout();
+  return (loc >= 0) && (loc < maxLoc) && isByte[loc];
+}
+
+/* Function st_datasize returns the number of
+ * words the data area takes with the chars packed
+ */
+int st_datasize(void)
+{ layout();
+  return dataSize;
+}
+
+/* Function st_initWord returns the initial value
+ * of word a of the data area, with the initial
+ * values of the chars it holds packed into it
+ */
+int st_initWord( int a)
+{ unsigned word = 0;
+  int i;
+  layout();
+  for (i=0;(i < maxLoc) && (i < maxInit);i++)
+    if (isByte[i] && (addr[i] / BYTESPERWORD == a))
+      word |= ((unsigned) initVal[i] & 0xffu) << (8 * (addr[i] % BYTESPERWORD));
+    else if (! isByte[i] && (addr[i] == a)) return initVal[i];
+  return (int) word;
+}
+
+/* Function st_temp enters a new compiler
+ * temporary of kind declkind and returns its
+ * name, which is never a valid TINY identifier
+ */
+char * st_temp( int lineno, DeclKind declkind)
+{ static int ntemps = 0;
+  char buf[20];
+  char * name;
+  sprintf(buf,"t%d",++ntemps);
+  name = (char *) malloc(strlen(buf)+1);
+  if (name == NULL) return NULL;
+  strcpy(name,buf);
+  st_insert(name,lineno,maxLoc,0,declkind);
+  return name;
+}
+
 /* Procedure printSymTab prints a formatted 
  * listing of the symbol table contents 
  * to the listing file
@@ -127,7 +311,8 @@ void printSymTab(FILE * listing)
       while (l != NULL)
       { LineList t = l->lines;
         fprintf(listing,"%-14s ",l->name);
-        fprintf(listing,"%-8d  ",l->memloc);
+        if (l->decl != NULL) fprintf(listing,"%-8s  ","proc");
+        else fprintf(listing,"%-8d  ",l->memloc);
         while (t != NULL)
         { fprintf(listing,"%4d ",t->lineno);
           t = t->next;
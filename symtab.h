@@ -14,14 +14,86 @@
  * memory locations into the symbol table
  * loc = memory location is inserted only the
  * first time, otherwise ignored
+ * size = number of elements of an array, which
+ * takes the locations loc to loc+size-1, or 0
+ * for a scalar
  */
-void st_insert( char * name, int lineno, int loc ,DeclKind declkind);
+void st_insert( char * name, int lineno, int loc, int size, DeclKind declkind);
+
+/* Procedure st_insertProc enters procedure name,
+ * declared by decl, which takes no memory location
+ */
+void st_insertProc( char * name, int lineno, TreeNode * decl);
+
+/* Function st_proc returns the declaration of
+ * procedure name, or NULL if there is none
+ */
+TreeNode * st_proc( char * name);
 
 /* Function st_lookup returns the memory 
  * location of a variable or -1 if not found
  */
 int st_lookup ( char * name );
 
+/* Function st_returnType returns the declared
+ * kind (int or char) of a variable
+ */
+DeclKind st_returnType(char * name);
+
+/* Function st_size returns the number of
+ * elements of an array, or 0 if name is a
+ * scalar (or not in the table)
+ */
+int st_size(char * name);
+
+/* Function st_maxloc returns one past the
+ * highest variable memory location, i.e. the
+ * size of the global data area
+ */
+int st_maxloc(void);
+
+/* Procedure st_setInit gives memory location loc
+ * the initial value val, which it holds when the
+ * program starts instead of 0
+ */
+void st_setInit(int loc, int val);
+
+/* Function st_init returns the initial value of
+ * memory location loc
+ */
+int st_init(int loc);
+
+/* Function st_addr returns the address in the
+ * data area of memory location loc: chars are
+ * packed four to a word after all the other
+ * variables and have byte addresses, the others
+ * have word addresses
+ */
+int st_addr(int loc);
+
+/* Function st_isByte is TRUE if memory location
+ * loc holds a char, which is loaded and stored a
+ * byte at a time
+ */
+int st_isByte(int loc);
+
+/* Function st_datasize returns the number of
+ * words the data area takes with the chars packed
+ */
+int st_datasize(void);
+
+/* Function st_initWord returns the initial value
+ * of word a of the data area, with the initial
+ * values of the chars it holds packed into it
+ */
+int st_initWord(int a);
+
+/* Function st_temp enters a new compiler
+ * temporary of kind declkind and returns its
+ * name, which is never a valid TINY identifier
+ */
+char * st_temp(int lineno, DeclKind declkind);
+
 /* Procedure printSymTab prints a formatted 
  * listing of the symbol table contents 
  * to the listing file
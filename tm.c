@@ -20,6 +20,7 @@
 /******* const *******/
 #define   IADDR_SIZE  1024 /* increase for large programs */
 #define   DADDR_SIZE  1024 /* increase for large programs */
+#define   BYTES_PER_WORD 4 /* bytes LDB and STB address in a word */
 #define   NO_REGS 8
 #define   PC_REG  7
 
@@ -48,6 +49,8 @@ typedef enum {
    /* RM instructions */
    opLD,      /* RM     reg(r) = mem(d+reg(s)) */
    opST,      /* RM     mem(d+reg(s)) = reg(r) */
+   opLDB,     /* RM     reg(r) = byte(d+reg(s)), 0 to 255 */
+   opSTB,     /* RM     byte(d+reg(s)) = reg(r) mod 256 */
    opRMLim,   /* Limit of RM opcodes */
 
    /* RA instructions */
@@ -82,15 +85,20 @@ int iloc = 0 ;
 int dloc = 0 ;
 int traceflag = FALSE;
 int icountflag = FALSE;
+int jumpcnt = 0 ;  /* jumps run by the last 'go' */
+int takencnt = 0 ; /* how many of them were taken */
 
 INSTRUCTION iMem [IADDR_SIZE];
+int iSize = 0; /* one past the highest location loaded */
+int iCount [IADDR_SIZE]; /* times each instruction ran */
 int dMem [DADDR_SIZE];
+int dInit [DADDR_SIZE]; /* data memory as the code file sets it */
 int reg [NO_REGS];
 
 char * opCodeTab[]
         = {"HALT","IN","OUT","ADD","SUB","MUL","DIV","????",
             /* RR opcodes */
-           "LD","ST","????", /* RM opcodes */
+           "LD","ST","LDB","STB","????", /* RM opcodes */
            "LDA","LDC","JLT","JLE","JGT","JGE","JEQ","JNE","????"
            /* RA opcodes */
           };
@@ -226,7 +234,8 @@ int readInstructions (void)
       reg[regNo] = 0 ;
   dMem[0] = DADDR_SIZE - 1 ;
   for (loc = 1 ; loc < DADDR_SIZE ; loc++)
-      dMem[loc] = 0 ;
+      dMem[loc] = dInit[loc] = 0 ;
+  iSize = 0 ;
   for (loc = 0 ; loc < IADDR_SIZE ; loc++)
   { iMem[loc].iop = opHALT ;
     iMem[loc].iarg1 = 0 ;
@@ -245,12 +254,22 @@ int readInstructions (void)
     { if (! getNum())
         return error("Bad location", lineNo,-1);
       loc = num;
-      if (loc > IADDR_SIZE)
-        return error("Location too large",lineNo,loc);
       if (! skipCh(':'))
         return error("Missing colon", lineNo,loc);
       if (! getWord ())
         return error("Missing opcode", lineNo,loc);
+      /* a line of the data section gives the word of
+         data memory at loc its initial value */
+      if (strcmp(word,"DATA") == 0)
+      { if ( (loc <= 0) || (loc >= DADDR_SIZE) )
+          return error("Bad data location", lineNo,loc);
+        if (! getNum ())
+          return error("Bad data value", lineNo,loc);
+        dMem[loc] = dInit[loc] = num;
+        continue;
+      }
+      if (loc > IADDR_SIZE)
+        return error("Location too large",lineNo,loc);
       op = opHALT ;
       while ((op < opRALim)
              && (strncmp(opCodeTab[op], word, 4) != 0) )
@@ -297,12 +316,27 @@ int readInstructions (void)
       iMem[loc].iarg1 = arg1;
       iMem[loc].iarg2 = arg2;
       iMem[loc].iarg3 = arg3;
+      if ( loc >= iSize ) iSize = loc + 1 ;
     }
   }
   return TRUE;
 } /* readInstructions */
 
 
+/********************************************/
+/* isJump is TRUE if the instruction at loc may */
+/* change the pc: a conditional jump, or any    */
+/* instruction loading register 7               */
+int isJump ( int loc )
+{ int op ;
+  if ( (loc < 0) || (loc >= IADDR_SIZE) ) return FALSE ;
+  op = iMem[loc].iop ;
+  if ( (op >= opJLT) && (op < opRALim) ) return TRUE ;
+  return (op != opHALT) && (op != opOUT) && (op != opST) && (op != opSTB)
+         && (iMem[loc].iarg1 == PC_REG) ;
+} /* isJump */
+
+
 /********************************************/
 STEPRESULT stepTM (void)
 { INSTRUCTION currentinstruction  ;
@@ -315,6 +349,7 @@ STEPRESULT stepTM (void)
       return srIMEM_ERR ;
   reg[PC_REG] = pc + 1 ;
   currentinstruction = iMem[ pc ] ;
+  if ( pc < IADDR_SIZE ) iCount[ pc ]++ ;
   switch (opClass(currentinstruction.iop) )
   { case opclRR :
     /***********************************/
@@ -328,7 +363,14 @@ STEPRESULT stepTM (void)
       r = currentinstruction.iarg1 ;
       s = currentinstruction.iarg3 ;
       m = currentinstruction.iarg2 + reg[s] ;
-      if ( (m < 0) || (m > DADDR_SIZE))
+      /* LDB and STB address the bytes of data memory,
+         BYTES_PER_WORD to a word, lowest byte first */
+      if ( (currentinstruction.iop == opLDB) ||
+           (currentinstruction.iop == opSTB) )
+      { if ( (m < 0) || (m >= BYTES_PER_WORD * DADDR_SIZE))
+           return srDMEM_ERR ;
+      }
+      else if ( (m < 0) || (m > DADDR_SIZE))
          return srDMEM_ERR ;
       break;
 
@@ -380,6 +422,16 @@ STEPRESULT stepTM (void)
     /*************** RM instructions ********************/
     case opLD :    reg[r] = dMem[m] ;  break;
     case opST :    dMem[m] = reg[r] ;  break;
+    case opLDB :
+      reg[r] = (int) (((unsigned) dMem[m / BYTES_PER_WORD]
+                       >> (8 * (m % BYTES_PER_WORD))) & 0xff) ;
+      break;
+    case opSTB :
+      t = 8 * (m % BYTES_PER_WORD) ;
+      dMem[m / BYTES_PER_WORD] =
+        (int) (((unsigned) dMem[m / BYTES_PER_WORD] & ~(0xffu << t))
+               | (((unsigned) reg[r] & 0xff) << t)) ;
+      break;
 
     /*************** RA instructions ********************/
     case opLDA :    reg[r] = m ; break;
@@ -396,6 +448,52 @@ STEPRESULT stepTM (void)
   return srOKAY ;
 } /* stepTM */
 
+/********************************************/
+/* returns the checksum of the instructions  */
+/* loaded, which the compiler computes the   */
+/* same way to tell whether a profile is of  */
+/* the code it generates                     */
+unsigned codeChecksum (void)
+{ unsigned sum = 0;
+  char * c;
+  int loc;
+  for (loc = 0; loc < iSize; loc++)
+  { for (c = opCodeTab[iMem[loc].iop]; *c != '\0'; c++)
+      sum = sum * 31 + (unsigned char) *c;
+    sum = sum * 31 + (unsigned) iMem[loc].iarg1;
+    sum = sum * 31 + (unsigned) iMem[loc].iarg2;
+    sum = sum * 31 + (unsigned) iMem[loc].iarg3;
+  }
+  return sum;
+} /* codeChecksum */
+
+/********************************************/
+/* writes the execution count of every        */
+/* instruction that ran since the program was */
+/* loaded to the program's profile file,      */
+/* after a line giving the size and checksum  */
+/* of the code                                */
+void writeProfile (void)
+{ char profName[30];
+  char * dot;
+  FILE * prof;
+  int loc;
+  strcpy(profName,pgmName);
+  dot = strrchr(profName,'.');
+  if ( dot != NULL ) *dot = '\0';
+  strcat(profName,".prof");
+  prof = fopen(profName,"w");
+  if ( prof == NULL )
+  { printf("Cannot write profile '%s'\n",profName);
+    return;
+  }
+  fprintf(prof,"code %d %u\n",iSize,codeChecksum());
+  for (loc = 0; loc < IADDR_SIZE; loc++)
+    if ( iCount[loc] > 0 ) fprintf(prof,"%d %d\n",loc,iCount[loc]);
+  fclose(prof);
+  printf("Profile written to %s\n",profName);
+} /* writeProfile */
+
 /********************************************/
 int doCommand (void)
 { char cmd;
@@ -438,10 +536,13 @@ int doCommand (void)
       printf("   t(race         "\
              "Toggle instruction trace\n");
       printf("   p(rint         "\
-             "Toggle print of total instructions executed"\
-             " ('go' only)\n");
+             "Toggle print of total instructions and jumps"\
+             " executed ('go' only)\n");
       printf("   c(lear         "\
              "Reset simulator for new execution of program\n");
+      printf("   w(rite         "\
+             "Write the execution count of each instruction\n"\
+             "                  to the profile file (.prof)\n");
       printf("   h(elp          "\
              "Cause this list of commands to be printed\n");
       printf("   q(uit          "\
@@ -519,7 +620,12 @@ int doCommand (void)
             reg[regNo] = 0 ;
       dMem[0] = DADDR_SIZE - 1 ;
       for (loc = 1 ; loc < DADDR_SIZE ; loc++)
-            dMem[loc] = 0 ;
+            dMem[loc] = dInit[loc] ;
+      break;
+
+    case 'w' :
+    /***********************************/
+      writeProfile ();
       break;
 
     case 'q' : return FALSE;  /* break; */
@@ -530,14 +636,22 @@ int doCommand (void)
   if ( stepcnt > 0 )
   { if ( cmd == 'g' )
     { stepcnt = 0;
+      jumpcnt = takencnt = 0;
       while (stepResult == srOKAY)
       { iloc = reg[PC_REG] ;
         if ( traceflag ) writeInstruction( iloc ) ;
         stepResult = stepTM ();
         stepcnt++;
+        if ( isJump( iloc ) )
+        { jumpcnt++;
+          if ( reg[PC_REG] != iloc + 1 ) takencnt++;
+        }
       }
       if ( icountflag )
-        printf("Number of instructions executed = %d\n",stepcnt);
+      { printf("Number of instructions executed = %d\n",stepcnt);
+        printf("Number of jumps executed = %d (%d taken)\n",
+               jumpcnt,takencnt);
+      }
     }
     else
     { while ((stepcnt > 0) && (stepResult == srOKAY))
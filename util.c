@@ -6,7 +6,9 @@
 /* Kenneth C. Louden                                */
 /****************************************************/
 
+#include <limits.h>
 #include "globals.h"
+#include "symtab.h"
 #include "util.h"
 
 /* Procedure printToken prints a token 
@@ -22,8 +24,15 @@ void printToken( TokenType token, const char* tokenString )
     case UNTIL:
     case READ:
     case WRITE:
+    case WHILE:
+    case DO:
+    case FOR:
+    case TO:
 	case INT:
 	case CHAR:
+    case PROCEDURE:
+    case CASE:
+    case OF:
       fprintf(listing,
          "reserved word: %s\n",tokenString);
       break;
@@ -32,11 +41,19 @@ void printToken( TokenType token, const char* tokenString )
     case EQ: fprintf(listing,"=\n"); break;
     case LPAREN: fprintf(listing,"(\n"); break;
     case RPAREN: fprintf(listing,")\n"); break;
+    case LBRACKET: fprintf(listing,"[\n"); break;
+    case RBRACKET: fprintf(listing,"]\n"); break;
     case SEMI: fprintf(listing,";\n"); break;
+    case COMMA: fprintf(listing,",\n"); break;
+    case COLON: fprintf(listing,":\n"); break;
+    case BAR: fprintf(listing,"|\n"); break;
     case PLUS: fprintf(listing,"+\n"); break;
     case MINUS: fprintf(listing,"-\n"); break;
     case TIMES: fprintf(listing,"*\n"); break;
     case OVER: fprintf(listing,"/\n"); break;
+    case AND: fprintf(listing,"and\n"); break;
+    case OR: fprintf(listing,"or\n"); break;
+    case NOT: fprintf(listing,"not\n"); break;
     case ENDFILE: fprintf(listing,"EOF\n"); break;
     case NUM:
       fprintf(listing,
@@ -66,6 +83,7 @@ TreeNode * newProgNode()
     for (i=0;i<MAXCHILDREN;i++) t->child[i] = NULL;
     t->sibling = NULL;
     t->nodekind = ProgK;
+    t->check = 0;
     //t->kind.decl = kind;
     t->lineno = lineno;
   }
@@ -81,6 +99,7 @@ TreeNode * newDeclNode(DeclKind kind)
     for (i=0;i<MAXCHILDREN;i++) t->child[i] = NULL;
     t->sibling = NULL;
     t->nodekind = DeclK;
+    t->check = 0;
     t->kind.decl = kind;
     t->lineno = lineno;
   }
@@ -99,6 +118,7 @@ TreeNode * newStmtNode(StmtKind kind)
     for (i=0;i<MAXCHILDREN;i++) t->child[i] = NULL;
     t->sibling = NULL;
     t->nodekind = StmtK;
+    t->check = CHECKLOW|CHECKHIGH;
     t->kind.stmt = kind;
     t->lineno = lineno;
   }
@@ -117,6 +137,7 @@ TreeNode * newExpNode(ExpKind kind)
     for (i=0;i<MAXCHILDREN;i++) t->child[i] = NULL;
     t->sibling = NULL;
     t->nodekind = ExpK;
+    t->check = CHECKLOW|CHECKHIGH;
     t->kind.exp = kind;
     t->lineno = lineno;
     t->type = Void;
@@ -139,6 +160,162 @@ char * copyString(char * s)
   return t;
 }
 
+/* Function constAddend is TRUE if expression t is an
+ * operand plus or minus a constant (comparisons being
+ * subtractions), which TM can do with the displacement
+ * of an LDA. The operand is returned in *rest and the
+ * signed constant in *disp
+ */
+int constAddend(TreeNode * t, TreeNode ** rest, int * disp)
+{ TreeNode * p1, * p2;
+  if ((t == NULL) || (t->nodekind != ExpK) || (t->kind.exp != OpK))
+    return FALSE;
+  p1 = t->child[0];
+  p2 = t->child[1];
+  if ((p1 == NULL) || (p2 == NULL)) return FALSE;
+  if ((p2->kind.exp == ConstK) && (t->attr.op == PLUS))
+  { *rest = p1;
+    *disp = p2->attr.val;
+    return TRUE;
+  }
+  if ((p2->kind.exp == ConstK) && (p2->attr.val != INT_MIN) &&
+      ((t->attr.op == MINUS) || (t->attr.op == LT) || (t->attr.op == EQ)))
+  { *rest = p1;
+    *disp = - p2->attr.val;
+    return TRUE;
+  }
+  if ((p1->kind.exp == ConstK) && (t->attr.op == PLUS))
+  { *rest = p2;
+    *disp = p1->attr.val;
+    return TRUE;
+  }
+  return FALSE;
+}
+
+/* Function copyTree returns a copy of t and its
+ * siblings
+ */
+TreeNode * copyTree( TreeNode * t)
+{ TreeNode * c;
+  int i;
+  if (t == NULL) return NULL;
+  c = (TreeNode *) malloc(sizeof(TreeNode));
+  if (c == NULL)
+  { fprintf(listing,"Out of memory error at line %d\n",t->lineno);
+    return NULL;
+  }
+  *c = *t;
+  for (i=0;i<MAXCHILDREN;i++) c->child[i] = copyTree(t->child[i]);
+  c->sibling = copyTree(t->sibling);
+  return c;
+}
+
+/* Procedure callEffects marks, by memory location,
+ * the scalar variables that statements t (and its
+ * siblings) may read in reads[] and may set in
+ * writes[], the procedures they call included.
+ * Either array may be NULL
+ */
+void callEffects( TreeNode * t, int * reads, int * writes)
+{ int i, loc;
+  for (;t != NULL;t = t->sibling)
+  { if ((t->nodekind == StmtK) && (t->kind.stmt == CallK))
+    { TreeNode * p = st_proc(t->attr.name);
+      if (p != NULL) callEffects(p->child[1],reads,writes);
+    }
+    else if ((t->nodekind == StmtK) &&
+             ((t->kind.stmt == AssignK) || (t->kind.stmt == ReadK) ||
+              (t->kind.stmt == ForK)))
+    { loc = st_lookup(t->attr.name);
+      if ((loc >= 0) && (st_size(t->attr.name) == 0) && (writes != NULL))
+        writes[loc] = TRUE;
+    }
+    else if ((t->nodekind == ExpK) && (t->kind.exp == IdK))
+    { loc = st_lookup(t->attr.name);
+      if ((loc >= 0) && (reads != NULL)) reads[loc] = TRUE;
+    }
+    for (i=0;i<MAXCHILDREN;i++) callEffects(t->child[i],reads,writes);
+  }
+}
+
+/* a jump table takes at least MINTABLE labels,
+   which must fill half of its at most MAXTABLE
+   entries; fewer labels are compared with one by
+   one */
+#define MINTABLE 4
+#define MAXTABLE 256
+
+static int byLabel( const void * a, const void * b)
+{ int x = ((const CaseLabel *) a)->val, y = ((const CaseLabel *) b)->val;
+  return (x < y) ? -1 : (x > y);
+}
+
+/* Function caseLabels returns the labels of case
+ * statement t sorted by value, and their number
+ * in *n
+ */
+CaseLabel * caseLabels( TreeNode * t, int * n)
+{ TreeNode * arm, * l;
+  CaseLabel * labels;
+  int k = 0, a = 0;
+  *n = 0;
+  for (arm=t->child[1];arm != NULL;arm = arm->sibling)
+    for (l=arm->child[0];l != NULL;l = l->sibling) (*n)++;
+  labels = (CaseLabel *) malloc((*n+1) * sizeof(CaseLabel));
+  if (labels == NULL)
+  { fprintf(listing,"Out of memory error at line %d\n",t->lineno);
+    *n = 0;
+    return NULL;
+  }
+  for (arm=t->child[1];arm != NULL;arm = arm->sibling,a++)
+    for (l=arm->child[0];l != NULL;l = l->sibling,k++)
+    { labels[k].val = l->attr.val;
+      labels[k].arm = a;
+    }
+  qsort(labels,*n,sizeof(CaseLabel),byLabel);
+  return labels;
+}
+
+/* Function caseSplit tells how the selector of a
+ * case statement is matched with labels lo..hi of
+ * those caseLabels returned: CASETABLE, CASECHAIN,
+ * or else the index of the first label left when
+ * the selector is not less than *pivot, the labels
+ * below that one being left when it is
+ */
+int caseSplit( CaseLabel * labels, int lo, int hi, int * pivot)
+{ int n = hi - lo + 1, k;
+  double size;
+  if (n < MINTABLE) return CASECHAIN;
+  /* the table is indexed by the selector less the
+     lowest label */
+  size = (double) labels[hi].val - labels[lo].val + 1;
+  if ((size <= 2 * n) && (size <= MAXTABLE) && (labels[lo].val != INT_MIN))
+    return CASETABLE;
+  /* the selector is compared by subtracting the
+     pivot, which must not overflow when it equals a
+     label: over labels further apart than INT_MAX,
+     split on its sign first */
+  if (size - 1 > INT_MAX)
+  { for (k=lo;labels[k].val < 0;k++) ;
+    *pivot = 0;
+    return k;
+  }
+  *pivot = labels[lo + n / 2].val;
+  return lo + n / 2;
+}
+
+/* Function caseArm returns the statements case
+ * statement t runs when its selector is val
+ */
+TreeNode * caseArm( TreeNode * t, int val)
+{ TreeNode * arm, * l;
+  for (arm=t->child[1];arm != NULL;arm = arm->sibling)
+    for (l=arm->child[0];l != NULL;l = l->sibling)
+      if (l->attr.val == val) return arm->child[1];
+  return t->child[2];
+}
+
 /* Variable indentno is used by printTree to
  * store current number of spaces to indent
  */
@@ -171,15 +348,36 @@ void printTree( TreeNode * tree )
         case RepeatK:
           fprintf(listing,"Repeat\n");
           break;
+        case WhileK:
+          fprintf(listing,"While\n");
+          break;
+        case ForK:
+          fprintf(listing,"For: %s\n",tree->attr.name);
+          break;
         case AssignK:
-          fprintf(listing,"Assign to: %s\n",tree->attr.name);
+          if (tree->child[1] != NULL)
+            fprintf(listing,"Assign to: %s[]\n",tree->attr.name);
+          else
+            fprintf(listing,"Assign to: %s\n",tree->attr.name);
           break;
         case ReadK:
-          fprintf(listing,"Read: %s\n",tree->attr.name);
+          if (tree->child[0] != NULL)
+            fprintf(listing,"Read: %s[]\n",tree->attr.name);
+          else
+            fprintf(listing,"Read: %s\n",tree->attr.name);
           break;
         case WriteK:
           fprintf(listing,"Write\n");
           break;
+        case CallK:
+          fprintf(listing,"Call: %s\n",tree->attr.name);
+          break;
+        case CaseK:
+          fprintf(listing,"Case\n");
+          break;
+        case ArmK:
+          fprintf(listing,"Arm\n");
+          break;
         default:
           fprintf(listing,"Unknown ExpNode kind\n");
           break;
@@ -197,6 +395,9 @@ void printTree( TreeNode * tree )
         case IdK:
           fprintf(listing,"Id: %s\n",tree->attr.name);
           break;
+        case IndexK:
+          fprintf(listing,"Index: %s\n",tree->attr.name);
+          break;
         default:
           fprintf(listing,"Unknown ExpNode kind\n");
           break;
@@ -211,6 +412,9 @@ void printTree( TreeNode * tree )
 			case CharK:
 				fprintf(listing,"char\n");
 				break;
+			case ProcK:
+				fprintf(listing,"procedure: %s\n",tree->attr.name);
+				break;
 			default:
 				fprintf(listing,"Unknown DeclNode kine\n");
 				break;
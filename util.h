@@ -38,6 +38,62 @@ TreeNode * newExpNode(ExpKind);
  */
 char * copyString( char * );
 
+/* Function constAddend is TRUE if expression t is an
+ * operand plus or minus a constant (comparisons being
+ * subtractions), which TM can do with the displacement
+ * of an LDA. The operand is returned in *rest and the
+ * signed constant in *disp
+ */
+int constAddend(TreeNode * t, TreeNode ** rest, int * disp);
+
+/* Function copyTree returns a copy of t and its
+ * siblings
+ */
+TreeNode * copyTree( TreeNode * t);
+
+/* Procedure callEffects marks, by memory location,
+ * the scalar variables that statements t (and its
+ * siblings) may read in reads[] and may set in
+ * writes[], the procedures they call included.
+ * Either array may be NULL
+ */
+void callEffects( TreeNode * t, int * reads, int * writes);
+
+/* a label of a case statement and the arm it
+ * selects, the arms counting from 0
+ */
+typedef struct
+   { int val;
+     int arm;
+   } CaseLabel;
+
+/* how the selector of a case statement is matched
+ * with some of its labels: by indexing a jump table,
+ * or by comparing it with each label in turn
+ */
+#define CASETABLE (-1)
+#define CASECHAIN (-2)
+
+/* Function caseLabels returns the labels of case
+ * statement t sorted by value, and their number
+ * in *n
+ */
+CaseLabel * caseLabels( TreeNode * t, int * n);
+
+/* Function caseSplit tells how the selector of a
+ * case statement is matched with labels lo..hi of
+ * those caseLabels returned: CASETABLE, CASECHAIN,
+ * or else the index of the first label left when
+ * the selector is not less than *pivot, the labels
+ * below that one being left when it is
+ */
+int caseSplit( CaseLabel * labels, int lo, int hi, int * pivot);
+
+/* Function caseArm returns the statements case
+ * statement t runs when its selector is val
+ */
+TreeNode * caseArm( TreeNode * t, int val);
+
 /* procedure printTree prints a syntax tree to the 
  * listing file using indentation to indicate subtrees
  */